@@ -0,0 +1,354 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: batch driver
+ *
+ *               Runs every park scenario listed in a manifest file using a
+ *          fixed number of worker threads, each scenario writing its own .pts
+ *          file exactly as autopark would. At the end the wall time of each
+ *          scenario and the total throughput are reported.
+ *
+ *          To run:
+ *              autobatch <manifest> [-j workers]
+ *
+ *          Each manifest line names the files of one scenario:
+ *              <park.cfg> <park.inp> [park.res|-] [output.pts]
+ *          empty lines and lines starting with # are ignored. The output is
+ *          written to <park>.pts unless given, so workloads run over the same
+ *          configuration file should name their outputs. By default there
+ *          are as many workers as online processors.
+ *
+ *  Implementation details:
+ *      Workers take the next scenario not yet started from a shared counter,
+ *  so long scenarios don't hold back the others.
+ *
+ *      Scenarios naming the same configuration file share its MapBase: the
+ *  first one to need it builds it and the last one to finish frees it, the
+ *  others only create their own simulation state.
+ *
+ *  Non standard interface dependencies:
+ *      parkmap.h - park MapBase shared by scenarios
+ *      scenario.h - runs a whole scenario
+ *      timing.h - monotonic clock
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* threads and sysconf are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<pthread.h>
+
+#include"parkmap.h"
+#include"scenario.h"
+#include"timing.h"
+
+
+#define LINESIZE 1024
+
+
+/*
+ *  Data Type: Park
+ *
+ *  Description:
+ *      a configuration file of the manifest and its base, built when first
+ *  needed by one of its scenarios
+ */
+
+typedef struct _park{
+    char *cfg;
+    MapBase *base;
+    int failed;                 /* 1 if the base couldn't be built */
+    int users;                  /* scenarios yet to finish with it */
+    pthread_mutex_t lock;
+} Park;
+
+
+/*
+ *  Data Type: Job
+ *
+ *  Description:
+ *      one scenario of the manifest and the result of running it
+ */
+
+typedef struct _job{
+    Park *park;
+    int parkIdx;                /* index of park while reading */
+    char *inp, *res, *pts;
+    int ret;
+    int nOrders;
+    double wall;
+} Job;
+
+
+/*
+ *  Data Type: Pool
+ *
+ *  Description:
+ *      the list of jobs shared by the workers
+ */
+
+typedef struct _pool{
+    Job *jobs;
+    int nJobs;
+    Park *parks;
+    int nParks;
+    int next;                   /* first job not yet taken */
+    pthread_mutex_t lock;
+} Pool;
+
+
+static char *copyString(char *s){
+    char *c = (char *) malloc(sizeof(char) * (strlen(s) + 1));
+
+    strcpy(c, s);
+    return c;
+}
+
+
+/*
+ * Auxiliary-function: findPark
+ *
+ * Description:
+ *      returns the park of a configuration file, adding it if new
+ */
+
+static Park *findPark(Pool *pool, char *cfg, int *maxParks){
+    int i;
+
+    for(i = 0; i < pool->nParks; i++)
+        if(strcmp(pool->parks[i].cfg, cfg) == 0)
+            return &pool->parks[i];
+
+    if(pool->nParks == *maxParks){
+        *maxParks *= 2;
+        pool->parks = (Park *) realloc(pool->parks, sizeof(Park) * *maxParks);
+    }
+    pool->parks[i].cfg = copyString(cfg);
+    pool->parks[i].base = NULL;
+    pool->parks[i].failed = 0;
+    pool->parks[i].users = 0;
+    pool->nParks++;
+    return &pool->parks[i];
+}
+
+
+/*
+ * Auxiliary-function: loadManifest
+ *
+ * Description:
+ *      reads the scenarios of the manifest file into the pool
+ *
+ * Return value:
+ *      0 on success, -1 if the file couldn't be read
+ */
+
+static int loadManifest(Pool *pool, char *filename){
+    FILE *fp;
+    Job *jobs;
+    char line[LINESIZE], cfg[LINESIZE], inp[LINESIZE], res[LINESIZE];
+    char pts[LINESIZE];
+    int n = 0, max = 16, maxParks = 16, k, i;
+
+    fp = fopen(filename, "r");
+    if(fp == NULL){
+        fprintf(stderr, "Couldn't open manifest file %s\n", filename);
+        return -1;
+    }
+
+    jobs = (Job *) malloc(sizeof(Job) * max);
+    pool->parks = (Park *) malloc(sizeof(Park) * maxParks);
+    pool->nParks = 0;
+    while(fgets(line, LINESIZE, fp) != NULL){
+        k = sscanf(line, "%s %s %s %s", cfg, inp, res, pts);
+        if(k <= 0 || cfg[0] == '#')
+            continue;
+        if(k == 1 || strlen(cfg) < 4){
+            fprintf(stderr, "Ignoring manifest line: %s", line);
+            continue;
+        }
+
+        if(n == max){
+            max *= 2;
+            jobs = (Job *) realloc(jobs, sizeof(Job) * max);
+        }
+        /* parks move while the table grows, keep the index for now */
+        jobs[n].parkIdx = findPark(pool, cfg, &maxParks) - pool->parks;
+        jobs[n].inp = copyString(inp);
+        jobs[n].res = k >= 3 && strcmp(res, "-") != 0 ? copyString(res) : NULL;
+        if(k == 4)
+            jobs[n].pts = copyString(pts);
+        else{
+            /* same name autopark would give */
+            jobs[n].pts = copyString(cfg);
+            strcpy(jobs[n].pts + strlen(cfg) - 4, ".pts");
+        }
+        jobs[n].ret = -1;
+        jobs[n].nOrders = 0;
+        jobs[n].wall = 0;
+        n++;
+    }
+    fclose(fp);
+
+    for(i = 0; i < n; i++){
+        jobs[i].park = &pool->parks[jobs[i].parkIdx];
+        jobs[i].park->users++;
+    }
+    for(i = 0; i < pool->nParks; i++)
+        pthread_mutex_init(&pool->parks[i].lock, NULL);
+
+    pool->jobs = jobs;
+    pool->nJobs = n;
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: getBase
+ *
+ * Description:
+ *      returns the base of a park, building it if no one did yet, NULL if
+ *  it can't be built
+ */
+
+static MapBase *getBase(Park *park){
+    MapBase *base;
+
+    pthread_mutex_lock(&park->lock);
+    if(park->base == NULL && park->failed == 0){
+        park->base = mapBaseInit(park->cfg);
+        if(park->base == NULL){
+            fprintf(stderr, "Error producing the park Map structure\n");
+            park->failed = 1;
+        }
+    }
+    base = park->base;
+    pthread_mutex_unlock(&park->lock);
+    return base;
+}
+
+
+/*
+ * Auxiliary-function: releaseBase
+ *
+ * Description:
+ *      tells a scenario is done with its park, freeing the base after the
+ *  last one
+ */
+
+static void releaseBase(Park *park){
+    pthread_mutex_lock(&park->lock);
+    park->users--;
+    if(park->users == 0 && park->base != NULL){
+        mapBaseDestroy(park->base);
+        park->base = NULL;
+    }
+    pthread_mutex_unlock(&park->lock);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: worker
+ *
+ * Description:
+ *      runs scenarios until there are no more left
+ */
+
+static void *worker(void *arg){
+    Pool *pool = (Pool *) arg;
+    Job *job;
+    MapBase *base;
+    double t0;
+
+    while(1){
+        pthread_mutex_lock(&pool->lock);
+        job = pool->next < pool->nJobs ? &pool->jobs[pool->next++] : NULL;
+        pthread_mutex_unlock(&pool->lock);
+        if(job == NULL)
+            break;
+
+        t0 = Tnow();
+        base = getBase(job->park);
+        if(base != NULL)
+            job->ret = runScenarioShared(base, job->pts, job->inp, job->res,
+                                                            &job->nOrders);
+        else
+            job->ret = 2;
+        releaseBase(job->park);
+        job->wall = Tnow() - t0;
+    }
+    return NULL;
+}
+
+
+int main(int argc, char *argv[]){
+    Pool pool;
+    pthread_t *threads;
+    double t0, total;
+    int nWorkers = 0, i, nOrders = 0, nFailed = 0;
+
+    if(argc != 2 && !(argc == 4 && strcmp(argv[2], "-j") == 0)){
+        fprintf(stderr, "Usage: %s <manifest> [-j workers]\n", argv[0]);
+        exit(1);
+    }
+    if(argc == 4)
+        nWorkers = atoi(argv[3]);
+    if(nWorkers < 1)
+        nWorkers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if(nWorkers < 1)
+        nWorkers = 1;
+
+    if(loadManifest(&pool, argv[1]) < 0)
+        exit(1);
+    pool.next = 0;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    if(nWorkers > pool.nJobs && pool.nJobs > 0)
+        nWorkers = pool.nJobs;
+    threads = (pthread_t *) malloc(sizeof(pthread_t) * nWorkers);
+
+    t0 = Tnow();
+    for(i = 0; i < nWorkers; i++)
+        pthread_create(&threads[i], NULL, worker, (void *) &pool);
+    for(i = 0; i < nWorkers; i++)
+        pthread_join(threads[i], NULL);
+    total = Tnow() - t0;
+
+    for(i = 0; i < pool.nJobs; i++){
+        printf("%-40s %9.3f s %8d orders%s\n", pool.jobs[i].pts,
+                        pool.jobs[i].wall, pool.jobs[i].nOrders,
+                        pool.jobs[i].ret == 0 ? "" : "  FAILED");
+        nOrders += pool.jobs[i].nOrders;
+        if(pool.jobs[i].ret != 0)
+            nFailed++;
+    }
+    printf("%d scenarios (%d failed), %d orders in %.3f s with %d workers\n",
+                        pool.nJobs, nFailed, nOrders, total, nWorkers);
+    if(total > 0)
+        printf("throughput %.2f scenarios/s, %.1f orders/s\n",
+                                    pool.nJobs / total, nOrders / total);
+
+    for(i = 0; i < pool.nJobs; i++){
+        free(pool.jobs[i].inp);
+        free(pool.jobs[i].res);
+        free(pool.jobs[i].pts);
+    }
+    for(i = 0; i < pool.nParks; i++){
+        free(pool.parks[i].cfg);
+        pthread_mutex_destroy(&pool.parks[i].lock);
+    }
+    free(pool.jobs);
+    free(pool.parks);
+    free(threads);
+    pthread_mutex_destroy(&pool.lock);
+
+    exit(nFailed == 0 ? 0 : 2);
+}
@@ -0,0 +1,360 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: phase timed benchmark
+ *
+ *               Runs whole scenarios several times, timing each phase with a
+ *          monotonic clock, and writes a JSON report with the minimum, median
+ *          and 99th percentile of every phase plus the peak resident memory.
+ *
+ *          To run:
+ *              autobench [-r runs] [-w warmup] [-o report.json] [-e engine]
+ *                        [park.cfg ...]
+ *
+ *          Each scenario is given by its configuration file, the car input
+ *          file has the same name ending in .inp and, if there is one, the
+ *          restriction file ends in .res. Without scenarios the built-in
+ *          suite is used: every scenario found in data/, mais-testes/ and
+ *          tests/.
+ *          The routing engine (see engine.h) is the default one unless
+ *          another is given with -e.
+ *
+ *          Phases:
+ *              mapInit, buildGraphs - park construction
+ *              loadInstructions, loadRestrictions - input files reading
+ *              merge - ordering of every order in time
+ *              routing - applying every order, output kept in memory
+ *              writeOutput - writing that output to a file
+ *
+ *  Non standard interface dependencies:
+ *      parkmap.h - main program module
+ *      LinkedList.h - list ADT
+ *      orders.h - Order data type and input file loaders
+ *      dispatch.h - applies orders to the park
+ *      timing.h - monotonic clock
+ *      scenario.h - built-in scenarios
+ *      engine.h - routing engines
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* open_memstream and getrusage are POSIX, not ANSI C */
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<sys/resource.h>
+
+#include"parkmap.h"
+#include"LinkedList.h"
+#include"orders.h"
+#include"dispatch.h"
+#include"timing.h"
+#include"scenario.h"
+#include"engine.h"
+
+
+#define NPHASES 8
+#define MAXSCENARIOS 256
+#define NAMESIZE 1024
+
+static char *phaseNames[NPHASES] = {"mapInit", "buildGraphs",
+        "loadInstructions", "loadRestrictions", "merge", "routing",
+        "writeOutput", "total"};
+
+/*
+ *  Data Type: Scenario
+ *
+ *  Description:
+ *      files of one scenario and the time of each phase in each run
+ */
+
+typedef struct _scenario{
+    char cfg[NAMESIZE], inp[NAMESIZE], res[NAMESIZE];
+    int hasRes;
+    int nOrders;
+    double *times[NPHASES];      /* seconds, one per measured run */
+} Scenario;
+
+
+static int compareDouble(const void *a, const void *b){
+    double x = *(double *) a, y = *(double *) b;
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+
+static int fileExists(char *name){
+    FILE *fp = fopen(name, "r");
+
+    if(fp == NULL)
+        return 0;
+    fclose(fp);
+    return 1;
+}
+
+
+/*
+ * Auxiliary-function: scenarioInit
+ *
+ * Description:
+ *      fills the file names of the scenario of a configuration file
+ *
+ * Return value:
+ *      0 on success, -1 if its files aren't there
+ */
+
+static int scenarioInit(Scenario *sc, char *cfg, int runs){
+    int len = strlen(cfg), i;
+
+    if(len < 5 || len >= NAMESIZE || strcmp(cfg + len - 4, ".cfg") != 0){
+        fprintf(stderr, "Not a configuration file: %s\n", cfg);
+        return -1;
+    }
+    strcpy(sc->cfg, cfg);
+    strcpy(sc->inp, cfg);
+    strcpy(sc->inp + len - 4, ".inp");
+    strcpy(sc->res, cfg);
+    strcpy(sc->res + len - 4, ".res");
+
+    if(fileExists(sc->cfg) == 0 || fileExists(sc->inp) == 0){
+        fprintf(stderr, "Missing files of scenario %s\n", cfg);
+        return -1;
+    }
+    sc->hasRes = fileExists(sc->res);
+    sc->nOrders = 0;
+    for(i = 0; i < NPHASES; i++)
+        sc->times[i] = (double *) malloc(sizeof(double) * runs);
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: runOnce
+ *
+ * Description:
+ *      runs a whole scenario, saving the time of each phase in times
+ */
+
+static void runOnce(Scenario *sc, double *times){
+    Map *parkMap;
+    LinkedList *inp, *res, *orders, *t;
+    Dispatcher *D;
+    FILE *mem, *fp;
+    char *out = NULL;
+    size_t outSize = 0;
+    double t0, start;
+    int n = 0, nTick;
+
+    start = t0 = Tnow();
+    parkMap = mapInit(sc->cfg);
+    times[0] = Tnow() - t0;
+    if(parkMap == NULL){
+        fprintf(stderr, "Error producing the park Map structure\n");
+        exit(2);
+    }
+
+    t0 = Tnow();
+    buildGraphs(parkMap);
+    times[1] = Tnow() - t0;
+
+    t0 = Tnow();
+    inp = loadInstructionFile(sc->inp);
+    times[2] = Tnow() - t0;
+
+    t0 = Tnow();
+    res = sc->hasRes ? loadRestrictionFile(sc->res) : initLinkedList();
+    times[3] = Tnow() - t0;
+
+    t0 = Tnow();
+    orders = inpresShuffleOrder(res, inp);
+    times[4] = Tnow() - t0;
+
+    /* output kept in memory, so routing doesn't include file writing */
+    mem = open_memstream(&out, &outSize);
+    t0 = Tnow();
+    D = Dinit(parkMap, mem, NULL);
+    for(t = orders; t != NULL; n += nTick)
+        t = DapplyTick(D, t, &nTick);
+    Ddestroy(D);
+    fflush(mem);
+    times[5] = Tnow() - t0;
+    fclose(mem);
+
+    t0 = Tnow();
+    fp = tmpfile();
+    if(fp != NULL){
+        fwrite(out, 1, outSize, fp);
+        fflush(fp);
+        fclose(fp);
+    }
+    times[6] = Tnow() - t0;
+    times[7] = Tnow() - start;
+
+    free(out);
+    freeLinkedList(orders, OrderDestroy);
+    mapDestroy(parkMap);
+    sc->nOrders = n;
+    return;
+}
+
+
+/*
+ * Auxiliary-function: percentile
+ *
+ * Description:
+ *      returns the p-th percentile (nearest rank) of n sorted values
+ */
+
+static double percentile(double *sorted, int n, int p){
+    int k = (n * p + 99) / 100;
+
+    if(k < 1)
+        k = 1;
+    return sorted[k - 1];
+}
+
+
+static void writeJSONString(FILE *fp, char *s){
+    fputc('"', fp);
+    for(; *s != '\0'; s++){
+        if(*s == '"' || *s == '\\')
+            fputc('\\', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: writeReport
+ *
+ * Description:
+ *      writes the JSON report, times in microseconds
+ */
+
+static void writeReport(FILE *fp, Scenario *sc, int nScenarios, int runs,
+                                                                int warmup){
+    struct rusage usage;
+    double *sorted;
+    int s, p;
+
+    sorted = (double *) malloc(sizeof(double) * runs);
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(fp, "{\n  \"runs\": %d,\n  \"warmup\": %d,\n", runs, warmup);
+    fprintf(fp, "  \"engine\": ");
+    writeJSONString(fp, Edefault());
+    fprintf(fp, ",\n");
+    fprintf(fp, "  \"unit\": \"us\",\n");
+    fprintf(fp, "  \"peak_rss_kb\": %ld,\n", (long) usage.ru_maxrss);
+    fprintf(fp, "  \"scenarios\": [\n");
+    for(s = 0; s < nScenarios; s++){
+        fprintf(fp, "    {\n      \"cfg\": ");
+        writeJSONString(fp, sc[s].cfg);
+        fprintf(fp, ",\n      \"restrictions\": %s,\n",
+                                        sc[s].hasRes ? "true" : "false");
+        fprintf(fp, "      \"orders\": %d,\n", sc[s].nOrders);
+        fprintf(fp, "      \"phases\": {\n");
+        for(p = 0; p < NPHASES; p++){
+            memcpy(sorted, sc[s].times[p], sizeof(double) * runs);
+            qsort(sorted, runs, sizeof(double), compareDouble);
+            fprintf(fp, "        \"%s\": {\"min\": %.1f, \"median\": %.1f, "
+                        "\"p99\": %.1f}%s\n", phaseNames[p],
+                        sorted[0] * 1e6, percentile(sorted, runs, 50) * 1e6,
+                        percentile(sorted, runs, 99) * 1e6,
+                        p < NPHASES - 1 ? "," : "");
+        }
+        fprintf(fp, "      }\n    }%s\n", s < nScenarios - 1 ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+
+    free(sorted);
+    return;
+}
+
+
+static void usage(char *prog){
+    fprintf(stderr,
+        "Usage: %s [-r runs] [-w warmup] [-o report.json] [-e engine] "
+                                                "[park.cfg ...]\n", prog);
+    exit(1);
+}
+
+
+int main(int argc, char *argv[]){
+    Scenario *sc;
+    char *names[MAXSCENARIOS];
+    double discard[NPHASES];
+    FILE *out = stdout;
+    int runs = 5, warmup = 1, nNames = 0, nScenarios = 0, suite = 0;
+    int i, r, p;
+
+    for(i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            runs = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            warmup = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc){
+            out = fopen(argv[++i], "w");
+            if(out == NULL){
+                fprintf(stderr, "Error opening file %s\n", argv[i]);
+                exit(1);
+            }
+        }
+        else if(strcmp(argv[i], "-e") == 0 && i + 1 < argc){
+            if(EsetDefault(argv[++i]) == 0){
+                fprintf(stderr, "Unknown engine %s\n", argv[i]);
+                exit(1);
+            }
+        }
+        else if(argv[i][0] == '-')
+            usage(argv[0]);
+        else if(nNames < MAXSCENARIOS)
+            names[nNames++] = argv[i];
+    }
+    if(runs < 1 || warmup < 0)
+        usage(argv[0]);
+
+    if(nNames == 0){
+        nNames = listSuite(names, MAXSCENARIOS);
+        suite = 1;
+    }
+
+    sc = (Scenario *) malloc(sizeof(Scenario) * (nNames + 1));
+    for(i = 0; i < nNames; i++)
+        if(scenarioInit(&sc[nScenarios], names[i], runs) == 0)
+            nScenarios++;
+
+    for(i = 0; i < nScenarios; i++){
+        fprintf(stderr, "%s", sc[i].cfg);
+        for(r = 0; r < warmup; r++)
+            runOnce(&sc[i], discard);
+        for(r = 0; r < runs; r++){
+            runOnce(&sc[i], discard);
+            for(p = 0; p < NPHASES; p++)
+                sc[i].times[p][r] = discard[p];
+            fprintf(stderr, ".");
+        }
+        fprintf(stderr, "\n");
+    }
+
+    writeReport(out, sc, nScenarios, runs, warmup);
+    if(out != stdout)
+        fclose(out);
+
+    for(i = 0; i < nScenarios; i++)
+        for(p = 0; p < NPHASES; p++)
+            free(sc[i].times[p]);
+    free(sc);
+    if(suite)
+        for(i = 0; i < nNames; i++)
+            free(names[i]);
+    exit(0);
+}
@@ -0,0 +1,1156 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: differential tester of the routing engines
+ *
+ *               Generates small random parks and sequences of events for
+ *          them (arrivals, departures, restrictions of positions, regions
+ *          and floors and their lifting) and plays each sequence on two
+ *          Maps, one with the reference engine ("dijkstra", GDijkstra) and
+ *          one with the engine under test. After every arrival the cost, the
+ *          spot and the whole path, node by node, must be the same in both. Engines that
+ *          only promise the cost (see Eexact) must find a path of the same
+ *          cost to a free spot, and the car is then moved to the reference's
+ *          spot so both Maps go on the same. A third Map, with the
+ *          reference engine, gets each region as one position restriction
+ *          per cell of its box and must give the reference's paths too.
+ *          Before every arrival both first Maps are asked queryCost, which
+ *          must give the cost and spot findPath then gives (only the cost
+ *          with the grouped admission); the third Map is never asked, so it
+ *          also checks that the queries change nothing. A failing case is
+ *          shrunk (fewer events, floors, rows, columns, entrances and
+ *          accesses, more walls) while it keeps failing and printed.
+ *
+ *          To run:
+ *              autodiff [-n cases] [-x seed] [-e engine ...] [-a]
+ *
+ *          Every engine registered in engine.c other than the reference is
+ *          tested, and the grouped admission, or only the ones given with -e
+ *          and -a. The grouped admission ("grouped", see rankSpots) is tested
+ *          like an engine that only promises the cost: arrivals from the
+ *          same entrance to the same access type are routed with one
+ *          ranking of the spots, told about the departures in between (see
+ *          rankFreedSpot). Exits with 1 if any case fails.
+ *
+ *  Implementation details:
+ *      An exact engine must break ties exactly as GDijkstra, whose
+ *  choice among paths of the same cost depends on the order of the binary
+ *  heap, and so on the state the queue is left in by the previous searches.
+ *  That's why cases are whole event sequences and not single queries.
+ *
+ *      Events that don't apply when a case is played (a departure of a car
+ *  that isn't parked, lifting a restriction that isn't there, an arrival at
+ *  an entrance or for an access type the park doesn't have) are skipped, so
+ *  any part of a case is a case as well and shrinking can drop anything.
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* mkstemp */
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+
+#include"parkmap.h"
+#include"engine.h"
+#include"graphL.h"
+
+
+#define MAXSIDE 10
+#define MAXFLOORS 3
+#define MAXPOINTS 4
+#define MAXEVENTS 80
+#define WHYSIZE 256
+
+/* access type characters */
+static char typeChars[] = "CHR";
+#define NTYPES 3
+
+/* name the grouped admission is tested under */
+#define GROUPED "grouped"
+
+
+/*
+ *  Data Type: Garage
+ *
+ *  Description:
+ *      a park, rep[z][y][x] with y = 0 at the bottom as in mapInit
+ */
+
+typedef struct _garage{
+    int N, M, P, E, S;
+    char rep[MAXFLOORS][MAXSIDE][MAXSIDE];
+    int ex[MAXPOINTS], ey[MAXPOINTS], ez[MAXPOINTS];
+    int ax[MAXPOINTS], ay[MAXPOINTS], az[MAXPOINTS];
+    char at[MAXPOINTS];
+} Garage;
+
+
+/*
+ *  Data Type: Event
+ *
+ *  Description:
+ *      E arrival of car at entrance for type, S departure of car, R and r
+ *  restriction of position x y z and its lifting, B and b the same for the
+ *  box from x y z to x2 y2 z2, P and p for floor z
+ */
+
+typedef struct _event{
+    char kind;
+    int car, entrance;
+    char type;
+    int x, y, z;
+    int x2, y2, z2;
+} Event;
+
+
+typedef struct _case{
+    Garage g;
+    int nEvents;
+    Event ev[MAXEVENTS];
+} Case;
+
+
+static unsigned long seed = 1;
+/* arrivals for which a path was found and compared */
+static long compared = 0;
+/* nodes of the reference's last path, refLength of them, -1 if none */
+static int *refPath = NULL, refLength = -1;
+
+/*
+ * Auxiliary-function: randInt
+ *
+ * Description:
+ *      returns a random number in [0, n), linear congruential generator
+ */
+
+static int randInt(int n){
+    seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+    return (int) ((double) (seed >> 8) / 16777216.0 * n);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* generation                                                              */
+
+/*
+ * Auxiliary-function: placeOnWall
+ *
+ * Description:
+ *      puts c on a random wall cell of floor z, away from the corners, and
+ *  a lane inside it. Returns 0 if no free wall cell was found
+ */
+
+static int placeOnWall(Garage *g, int z, char c, int *px, int *py){
+    int tries, side, x, y, ix, iy;
+
+    for(tries = 0; tries < 100; tries++){
+        side = randInt(4);
+        if(side < 2){
+            x = side == 0 ? 0 : g->N - 1;
+            y = 1 + randInt(g->M - 2);
+            ix = side == 0 ? 1 : g->N - 2;
+            iy = y;
+        } else{
+            y = side == 2 ? 0 : g->M - 1;
+            x = 1 + randInt(g->N - 2);
+            iy = side == 2 ? 1 : g->M - 2;
+            ix = x;
+        }
+        if(g->rep[z][y][x] != '@' || strchr("ud", g->rep[z][iy][ix]) != NULL)
+            continue;
+        g->rep[z][y][x] = c;
+        g->rep[z][iy][ix] = ' ';
+        *px = x;
+        *py = y;
+        return 1;
+    }
+    return 0;
+}
+
+
+static void generateGarage(Garage *g){
+    int x, y, z, i, k, types, r;
+
+    g->N = 5 + randInt(MAXSIDE - 4);
+    g->M = 5 + randInt(MAXSIDE - 4);
+    g->P = 1 + randInt(MAXFLOORS);
+
+    for(z = 0; z < g->P; z++)
+        for(y = 0; y < g->M; y++)
+            for(x = 0; x < g->N; x++){
+                /* lanes along the side walls and every third row, spots in
+                 * between, with a few walls anywhere */
+                r = randInt(100);
+                if(x == 0 || y == 0 || x == g->N - 1 || y == g->M - 1)
+                    g->rep[z][y][x] = '@';
+                else if(y % 3 == 1 || x == 1 || x == g->N - 2)
+                    g->rep[z][y][x] = r < 92 ? ' ' : '@';
+                else
+                    g->rep[z][y][x] = r < 65 ? '.' : r < 80 ? '@' :
+                                                        r < 92 ? ' ' : 'x';
+            }
+
+    /* a 'u' always has its 'd' right above it */
+    for(z = 0; z < g->P - 1; z++)
+        for(k = 1 + randInt(2); k > 0; k--){
+            x = 1 + randInt(g->N - 2);
+            y = 1 + randInt(g->M - 2);
+            if(strchr("ud", g->rep[z][y][x]) != NULL ||
+                                strchr("ud", g->rep[z + 1][y][x]) != NULL)
+                continue;
+            g->rep[z][y][x] = 'u';
+            g->rep[z + 1][y][x] = 'd';
+        }
+
+    g->E = 0;
+    for(k = 1 + randInt(MAXPOINTS - 1); k > 0; k--){
+        z = randInt(g->P);
+        if(placeOnWall(g, z, 'e', &g->ex[g->E], &g->ey[g->E])){
+            g->ez[g->E] = z;
+            g->E++;
+        }
+    }
+
+    types = 1 + randInt(2);
+    g->S = 0;
+    for(i = 0, k = types + randInt(2); i < k; i++){
+        z = randInt(g->P);
+        if(placeOnWall(g, z, 'a', &g->ax[g->S], &g->ay[g->S])){
+            g->az[g->S] = z;
+            g->at[g->S] = typeChars[i % types];
+            g->S++;
+        }
+    }
+    return;
+}
+
+
+static void generateCase(Case *c){
+    Garage *g = &c->g;
+    Event *e;
+    int i, cars = 0, r;
+
+    generateGarage(g);
+
+    c->nEvents = 10 + randInt(MAXEVENTS - 10);
+    for(i = 0; i < c->nEvents; i++){
+        e = &c->ev[i];
+        r = randInt(100);
+        e->car = cars > 0 ? randInt(cars) : 0;
+        e->entrance = g->E > 0 ? randInt(g->E) : 0;
+        e->type = g->S > 0 ? g->at[randInt(g->S)] : typeChars[0];
+        e->x = 1 + randInt(g->N - 2);
+        e->y = 1 + randInt(g->M - 2);
+        e->z = randInt(g->P);
+        /* boxes of up to three by three cells on up to two floors */
+        e->x2 = e->x + randInt(3);
+        e->y2 = e->y + randInt(3);
+        e->z2 = e->z + randInt(2);
+        if(e->x2 > g->N - 2)
+            e->x2 = g->N - 2;
+        if(e->y2 > g->M - 2)
+            e->y2 = g->M - 2;
+        if(e->z2 > g->P - 1)
+            e->z2 = g->P - 1;
+        if(r < 40){
+            e->kind = 'E';
+            e->car = cars++;
+        } else if(r < 70)
+            e->kind = 'S';
+        else if(r < 80)
+            e->kind = 'R';
+        else if(r < 88){
+            /* mostly lifts of an earlier restriction */
+            e->kind = 'r';
+            for(r = i - 1; r >= 0; r--)
+                if(c->ev[r].kind == 'R' && randInt(2) == 0){
+                    e->x = c->ev[r].x;
+                    e->y = c->ev[r].y;
+                    e->z = c->ev[r].z;
+                    break;
+                }
+        } else if(r < 92)
+            e->kind = 'B';
+        else if(r < 95){
+            e->kind = 'b';
+            for(r = i - 1; r >= 0; r--)
+                if(c->ev[r].kind == 'B' && randInt(2) == 0){
+                    *e = c->ev[r];
+                    e->kind = 'b';
+                    break;
+                }
+        } else
+            e->kind = r < 98 ? 'P' : 'p';
+    }
+    return;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* playing a case                                                          */
+
+static void writeGarage(FILE *fp, Garage *g){
+    int x, y, z, i;
+
+    fprintf(fp, "%d %d %d %d %d\n", g->N, g->M, g->P, g->E, g->S);
+    for(z = 0; z < g->P; z++){
+        for(y = g->M - 1; y >= 0; y--){
+            for(x = 0; x < g->N; x++)
+                fputc(g->rep[z][y][x], fp);
+            fputc('\n', fp);
+        }
+        for(i = 0; i < g->E; i++)
+            if(g->ez[i] == z)
+                fprintf(fp, "E%d %d %d %d -\n", i + 1, g->ex[i], g->ey[i], z);
+        for(i = 0; i < g->S; i++)
+            if(g->az[i] == z)
+                fprintf(fp, "A%d %d %d %d %c\n", i + 1, g->ax[i], g->ay[i], z,
+                                                                    g->at[i]);
+        fprintf(fp, "+\n");
+    }
+    return;
+}
+
+
+static void writeEvent(FILE *fp, Event *e){
+    switch(e->kind){
+        case 'E':
+            fprintf(fp, "V%03d E%d %c\n", e->car, e->entrance + 1, e->type);
+            break;
+        case 'S':
+            fprintf(fp, "V%03d S\n", e->car);
+            break;
+        case 'R': case 'r':
+            fprintf(fp, "%c %d %d %d\n", e->kind, e->x, e->y, e->z);
+            break;
+        case 'B': case 'b':
+            fprintf(fp, "%c %d %d %d %d %d %d\n", e->kind, e->x, e->y, e->z,
+                                                        e->x2, e->y2, e->z2);
+            break;
+        default:
+            fprintf(fp, "%c %d\n", e->kind, e->z);
+            break;
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: stepCost
+ *
+ * Description:
+ *      cost of going from node u to node v, as the edges are made in
+ *  instanceBuild, or -1 if there is no such edge
+ */
+
+static int stepCost(Garage *g, int u, int v){
+    int NM = g->N * g->M, NMP = NM * g->P, d = v > u ? v - u : u - v;
+
+    if(u >= 2 * NMP)
+        return -1;
+    if(v >= 2 * NMP)
+        return u >= NMP ? 0 : -1;
+    if(v - u == NMP)
+        return 0;
+    if( (u < NMP) != (v < NMP) )
+        return -1;
+    if(d == 1 || d == g->N)
+        return u < NMP ? 1 : 3;
+    if(d == NM)
+        return u < NMP ? 2 : 6;
+    return -1;
+}
+
+
+/*
+ * Auxiliary-function: queryNode
+ *
+ * Description:
+ *      asks the Map what findPath would give the arrival, returning the
+ *  cost, NOCON if none, and the node of the spot in spot
+ */
+
+static int queryNode(Map *parkMap, Event *e, Garage *g, int *spot){
+    int cost, x, y, z;
+
+    cost = queryCost(parkMap, g->ex[e->entrance], g->ey[e->entrance],
+                                    g->ez[e->entrance], e->type, &x, &y, &z);
+    *spot = cost == NOCON ? -1 : x + g->N * y + g->N * g->M * z;
+    return cost;
+}
+
+
+/*
+ * Auxiliary-function: sameQuery
+ *
+ * Description:
+ *      compares what queryCost said with what findPath then gave (spot -2
+ *  not to compare the spots), writing the difference to why. Returns 1 if
+ *  they are the same
+ */
+
+static int sameQuery(char *who, int qCost, int qSpot, int cost, int spot,
+                                                                char *why){
+    if(qCost == cost && (spot == -2 || qSpot == spot))
+        return 1;
+    sprintf(why, "%s queryCost gave cost %d at %d, findPath %d at %d", who,
+                                                    qCost, qSpot, cost, spot);
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: comparePaths
+ *
+ * Description:
+ *      compares what the two Maps found for an arrival, writing the first
+ *  difference to why. Returns the node where the reference parked the car,
+ *  -1 if it found no path, or -2 if they differ. The engine's spot goes to
+ *  altSpot. With a ranking, the second Map routes the car with it. Each Map
+ *  is asked queryCost first, which must agree with it
+ */
+
+static int comparePaths(Map *ref, Map *alt, SpotRanking *R, Event *e,
+                            Garage *g, int exact, int *altSpot, char *why){
+    static int *pa = NULL;
+    static int size = 0;
+    int *str, *sta, cr, ca, nr, na, i, NMP, spot = -1, sum, c, *pr;
+    int qr, qa, qrSpot, qaSpot;
+    char id[8];
+
+    NMP = g->N * g->M * g->P;
+    if(size < 2 * NMP + MAXPOINTS){
+        size = 2 * NMP + MAXPOINTS;
+        refPath = (int *) realloc(refPath, sizeof(int) * size);
+        pa = (int *) realloc(pa, sizeof(int) * size);
+    }
+    pr = refPath;
+    refLength = -1;
+
+    qr = queryNode(ref, e, g, &qrSpot);
+    qa = queryNode(alt, e, g, &qaSpot);
+
+    sprintf(id, "V%03d", e->car);
+    str = findPath(ref, id, g->ex[e->entrance], g->ey[e->entrance],
+                            g->ez[e->entrance], e->type, &cr, &nr, NULL);
+    if(R != NULL)
+        sta = nextRankedPath(alt, R, id, &ca, &na);
+    else
+        sta = findPath(alt, id, g->ex[e->entrance], g->ey[e->entrance],
+                            g->ez[e->entrance], e->type, &ca, &na, NULL);
+
+    if( (str == NULL) != (sta == NULL) ){
+        sprintf(why, "reference %s a path, engine %s", str ? "found" : "didn't find",
+                                            sta ? "found one" : "didn't");
+        return -2;
+    }
+    if(str == NULL){
+        if(sameQuery("reference", qr, qrSpot, NOCON, -1, why) == 0 ||
+                            sameQuery("engine", qa, qaSpot, NOCON, -1, why) == 0)
+            return -2;
+        return -1;
+    }
+    compared++;
+    getPathNodes(ref, str, e->type, pr, nr);
+    refLength = nr;
+    if(cr != ca){
+        sprintf(why, "cost %d, engine %d", cr, ca);
+        return -2;
+    }
+
+    getPathNodes(alt, sta, e->type, pa, na);
+    for(i = 0; i + 1 < nr; i++)
+        if(pr[i + 1] - pr[i] == NMP){
+            spot = pr[i];
+            break;
+        }
+    *altSpot = -1;
+    for(i = 0; i + 1 < na; i++)
+        if(pa[i + 1] - pa[i] == NMP){
+            *altSpot = pa[i];
+            break;
+        }
+    /* the engine's queryCost searches as its findPath, not as a ranking */
+    if(sameQuery("reference", qr, qrSpot, cr, spot, why) == 0 ||
+                sameQuery("engine", qa, qaSpot, ca, R != NULL ? -2 : *altSpot,
+                                                                    why) == 0)
+        return -2;
+
+    if(exact == 0){
+        /* any path will do, if it is one and costs the same; they end at
+         * the walking node of an access, before its type's node */
+        for(i = 0; i < g->S; i++)
+            if(g->at[i] == e->type && pa[na - 1] == NMP + g->ax[i] +
+                                g->N * g->ay[i] + g->N * g->M * g->az[i])
+                break;
+        if(pa[0] != pr[0] || i == g->S){
+            sprintf(why, "engine path goes from %d to %d", pa[0], pa[na - 1]);
+            return -2;
+        }
+        for(i = 0, sum = 0; i + 1 < na; i++){
+            c = stepCost(g, pa[i], pa[i + 1]);
+            if(c == -1){
+                sprintf(why, "engine path jumps from %d to %d", pa[i],
+                                                                    pa[i + 1]);
+                return -2;
+            }
+            sum += c;
+        }
+        if(sum != ca || *altSpot == -1){
+            sprintf(why, "engine path costs %d, engine says %d", sum, ca);
+            return -2;
+        }
+        return spot;
+    }
+
+    for(i = 0; i < nr && i < na; i++)
+        if(pr[i] != pa[i])
+            break;
+    if(i < nr || i < na){
+        sprintf(why, "paths of %d and %d nodes differ at position %d: node %d, engine %d",
+                        nr, na, i, i < nr ? pr[i] : -1, i < na ? pa[i] : -1);
+        return -2;
+    }
+    return spot;
+}
+
+
+/*
+ * Auxiliary-function: compareCells
+ *
+ * Description:
+ *      routes the arrival in the Map with the regions as one restriction per
+ *  cell and compares its path with the reference's last one, writing the
+ *  difference to why. Returns 0 if they are the same, -2 otherwise
+ */
+
+static int compareCells(Map *cells, Event *e, Garage *g, char *why){
+    static int *pc = NULL;
+    static int size = 0;
+    int *st, cost, n, i, NMP = g->N * g->M * g->P;
+    char id[8];
+
+    if(size < 2 * NMP + MAXPOINTS){
+        size = 2 * NMP + MAXPOINTS;
+        pc = (int *) realloc(pc, sizeof(int) * size);
+    }
+
+    sprintf(id, "V%03d", e->car);
+    st = findPath(cells, id, g->ex[e->entrance], g->ey[e->entrance],
+                            g->ez[e->entrance], e->type, &cost, &n, NULL);
+    if( (st == NULL) != (refLength == -1) ){
+        sprintf(why, "reference %s a path, with regions as positions %s",
+                                refLength != -1 ? "found" : "didn't find",
+                                st != NULL ? "found one" : "didn't");
+        return -2;
+    }
+    if(st == NULL)
+        return 0;
+
+    getPathNodes(cells, st, e->type, pc, n);
+    for(i = 0; i < n && i < refLength; i++)
+        if(pc[i] != refPath[i])
+            break;
+    if(i < n || i < refLength){
+        sprintf(why, "with regions as positions the paths of %d and %d nodes "
+                            "differ at position %d", refLength, n, i);
+        return -2;
+    }
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: countBox
+ *
+ * Description:
+ *      returns how many cells of the box of e have their flag set, or -1 if
+ *  the box isn't inside the park
+ */
+
+static int countBox(Garage *g, Event *e,
+                            char flag[MAXFLOORS][MAXSIDE][MAXSIDE]){
+    int x, y, z, n = 0;
+
+    if(e->x2 >= g->N - 1 || e->y2 >= g->M - 1 || e->z2 >= g->P)
+        return -1;
+    for(z = e->z; z <= e->z2; z++)
+        for(y = e->y; y <= e->y2; y++)
+            for(x = e->x; x <= e->x2; x++)
+                n += flag[z][y][x] != 0;
+    return n;
+}
+
+
+/*
+ * Auxiliary-function: restrictBox
+ *
+ * Description:
+ *      restricts (or lifts, if active is set) the box of e as a region in
+ *  the reference and engine Maps and as one position per cell in cells
+ */
+
+static void restrictBox(Map *ref, Map *alt, Map *cells, Event *e,
+                    char restricted[MAXFLOORS][MAXSIDE][MAXSIDE], int active){
+    int x, y, z;
+
+    if(active){
+        freeRestrictionMapRegion(ref, e->x, e->y, e->z, e->x2, e->y2, e->z2);
+        freeRestrictionMapRegion(alt, e->x, e->y, e->z, e->x2, e->y2, e->z2);
+    } else{
+        restrictMapRegion(ref, e->x, e->y, e->z, e->x2, e->y2, e->z2);
+        restrictMapRegion(alt, e->x, e->y, e->z, e->x2, e->y2, e->z2);
+    }
+    for(z = e->z; z <= e->z2; z++)
+        for(y = e->y; y <= e->y2; y++)
+            for(x = e->x; x <= e->x2; x++){
+                if(active)
+                    freeRestrictionMapCoordinate(cells, x, y, z);
+                else
+                    restrictMapCoordinate(cells, x, y, z);
+                restricted[z][y][x] = (char) !active;
+            }
+    return;
+}
+
+
+/* rankings of the grouped admission, good until a restriction changes */
+static void dropRankings(SpotRanking *ranks[MAXPOINTS][NTYPES]){
+    int i, k;
+
+    for(i = 0; i < MAXPOINTS; i++)
+        for(k = 0; k < NTYPES; k++){
+            if(ranks[i][k] != NULL)
+                freeSpotRanking(ranks[i][k]);
+            ranks[i][k] = NULL;
+        }
+    return;
+}
+
+
+/* and told about the spots freed in the Map */
+static void freedRankings(Map *alt, SpotRanking *ranks[MAXPOINTS][NTYPES]){
+    int i, k;
+
+    for(i = 0; i < MAXPOINTS; i++)
+        for(k = 0; k < NTYPES; k++)
+            if(ranks[i][k] != NULL)
+                rankFreedSpot(alt, ranks[i][k]);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: playCase
+ *
+ * Description:
+ *      plays a case with the reference and the given engine
+ *
+ * Return value:
+ *      index of the first event where they differ (with the difference in
+ *  why), -1 if they never do
+ */
+
+static int playCase(Case *c, char *engine, char *why){
+    static char cfg[] = "/tmp/autodiffXXXXXX";
+    char name[sizeof(cfg)];
+    Garage *g = &c->g;
+    MapBase *base;
+    Map *ref, *alt, *cells;
+    FILE *fp, *devnull;
+    Event *e;
+    int i, fd, spot, altSpot, x, y, z, failed = -1, exact = Eexact(engine);
+    int grouped = strcmp(engine, GROUPED) == 0, type;
+    SpotRanking *ranks[MAXPOINTS][NTYPES], *R;
+    int parked[MAXEVENTS];
+    char restricted[MAXFLOORS][MAXSIDE][MAXSIDE], closed[MAXFLOORS], id[8];
+    char occupied[MAXFLOORS][MAXSIDE][MAXSIDE];
+    /* spots taken in the park file, lifting a restriction doesn't free them */
+    char taken[MAXFLOORS][MAXSIDE][MAXSIDE];
+
+    strcpy(name, cfg);
+    fd = mkstemp(name);
+    if(fd == -1 || (fp = fdopen(fd, "w")) == NULL){
+        fprintf(stderr, "Couldn't create a temporary file\n");
+        exit(1);
+    }
+    writeGarage(fp, g);
+    fclose(fp);
+
+    base = mapBaseInit(name);
+    remove(name);
+    if(base == NULL)
+        exit(1);
+    ref = mapInitShared(base);
+    alt = mapInitShared(base);
+    cells = mapInitShared(base);
+    if(grouped == 0)
+        mapSetEngine(alt, engine);
+    memset(ranks, 0, sizeof(ranks));
+    devnull = fopen("/dev/null", "w");
+
+    memset(parked, 0, sizeof(parked));
+    memset(restricted, 0, sizeof(restricted));
+    memset(occupied, 0, sizeof(occupied));
+    memset(closed, 0, sizeof(closed));
+    for(z = 0; z < g->P; z++)
+        for(y = 0; y < g->M; y++)
+            for(x = 0; x < g->N; x++)
+                taken[z][y][x] = g->rep[z][y][x] == 'x';
+
+    for(i = 0; i < c->nEvents && failed == -1; i++){
+        e = &c->ev[i];
+        if(e->kind != 'E' && e->kind != 'S')
+            dropRankings(ranks);
+        switch(e->kind){
+            case 'E':
+                if(e->entrance >= g->E)
+                    break;
+                for(spot = 0; spot < g->S && g->at[spot] != e->type; spot++);
+                if(spot == g->S)
+                    break;
+                R = NULL;
+                if(grouped){
+                    type = strchr(typeChars, e->type) - typeChars;
+                    if(ranks[e->entrance][type] == NULL)
+                        ranks[e->entrance][type] = rankSpots(alt,
+                                        g->ex[e->entrance], g->ey[e->entrance],
+                                        g->ez[e->entrance], e->type, NULL);
+                    R = ranks[e->entrance][type];
+                }
+                spot = comparePaths(ref, alt, R, e, g, exact, &altSpot, why);
+                if(spot != -2 && compareCells(cells, e, g, why) < 0)
+                    spot = -2;
+                if(spot >= 0 && altSpot != spot){
+                    /* the engine's spot must have been free as well */
+                    x = altSpot % g->N;
+                    y = altSpot % (g->N * g->M) / g->N;
+                    z = altSpot / (g->N * g->M);
+                    if(strchr(".x", g->rep[z][y][x]) == NULL ||
+                            occupied[z][y][x] || restricted[z][y][x] ||
+                            taken[z][y][x] || closed[z]){
+                        sprintf(why, "engine parked at %d %d %d, not free",
+                                                                    x, y, z);
+                        spot = -2;
+                    } else{
+                        sprintf(id, "V%03d", e->car);
+                        clearSpotCoordinates(alt, x, y, z);
+                        freedRankings(alt, ranks);
+                        occupySpotCoordinates(alt, id, spot % g->N,
+                                            spot % (g->N * g->M) / g->N,
+                                            spot / (g->N * g->M));
+                    }
+                }
+                if(spot == -2)
+                    failed = i;
+                else if(spot >= 0){
+                    parked[e->car] = spot + 1;
+                    occupied[spot / (g->N * g->M)][spot % (g->N * g->M) / g->N]
+                                                        [spot % g->N] = 1;
+                }
+                break;
+            case 'S':
+                if(parked[e->car] == 0)
+                    break;
+                spot = parked[e->car] - 1;
+                sprintf(id, "V%03d", e->car);
+                clearSpotIDandWrite(devnull, ref, id, i);
+                clearSpotIDandWrite(devnull, cells, id, i);
+                /* moved cars are in the engine's Map under two spots */
+                if(exact)
+                    clearSpotIDandWrite(devnull, alt, id, i);
+                else
+                    clearSpotCoordinates(alt, spot % g->N,
+                                spot % (g->N * g->M) / g->N,
+                                spot / (g->N * g->M));
+                freedRankings(alt, ranks);
+                parked[e->car] = 0;
+                occupied[spot / (g->N * g->M)][spot % (g->N * g->M) / g->N]
+                                                        [spot % g->N] = 0;
+                break;
+            case 'R':
+                if(e->x >= g->N - 1 || e->y >= g->M - 1 || e->z >= g->P ||
+                        g->rep[e->z][e->y][e->x] == '@' ||
+                        restricted[e->z][e->y][e->x] ||
+                        occupied[e->z][e->y][e->x])
+                    break;
+                restrictMapCoordinate(ref, e->x, e->y, e->z);
+                restrictMapCoordinate(alt, e->x, e->y, e->z);
+                restrictMapCoordinate(cells, e->x, e->y, e->z);
+                restricted[e->z][e->y][e->x] = 1;
+                break;
+            case 'r':
+                if(e->x >= g->N - 1 || e->y >= g->M - 1 || e->z >= g->P ||
+                        restricted[e->z][e->y][e->x] == 0)
+                    break;
+                freeRestrictionMapCoordinate(ref, e->x, e->y, e->z);
+                freeRestrictionMapCoordinate(alt, e->x, e->y, e->z);
+                freeRestrictionMapCoordinate(cells, e->x, e->y, e->z);
+                restricted[e->z][e->y][e->x] = 0;
+                break;
+            case 'B':
+                /* like R, on a box with no restriction and no car */
+                if(countBox(g, e, restricted) != 0 ||
+                                            countBox(g, e, occupied) != 0)
+                    break;
+                restrictBox(ref, alt, cells, e, restricted, 0);
+                break;
+            case 'b':
+                if(countBox(g, e, restricted) != (e->x2 - e->x + 1) *
+                                    (e->y2 - e->y + 1) * (e->z2 - e->z + 1))
+                    break;
+                restrictBox(ref, alt, cells, e, restricted, 1);
+                break;
+            case 'P':
+                if(e->z >= g->P || closed[e->z])
+                    break;
+                restrictMapFloor(ref, e->z);
+                restrictMapFloor(alt, e->z);
+                restrictMapFloor(cells, e->z);
+                closed[e->z] = 1;
+                break;
+            case 'p':
+                if(e->z >= g->P || closed[e->z] == 0)
+                    break;
+                freeRestrictionMapFloor(ref, e->z);
+                freeRestrictionMapFloor(alt, e->z);
+                freeRestrictionMapFloor(cells, e->z);
+                closed[e->z] = 0;
+                break;
+        }
+    }
+
+    dropRankings(ranks);
+    fclose(devnull);
+    mapDestroy(ref);
+    mapDestroy(alt);
+    mapDestroy(cells);
+    mapBaseDestroy(base);
+    return failed;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* shrinking                                                               */
+
+static void dropEvent(Case *c, int i){
+    for(c->nEvents--; i < c->nEvents; i++)
+        c->ev[i] = c->ev[i + 1];
+    return;
+}
+
+
+static void dropEntrance(Case *c, int i){
+    Garage *g = &c->g;
+    int k;
+
+    /* arrivals keep their entrance */
+    for(k = 0; k < c->nEvents; k++)
+        if(c->ev[k].kind == 'E' && c->ev[k].entrance > i)
+            c->ev[k].entrance--;
+    g->rep[g->ez[i]][g->ey[i]][g->ex[i]] = '@';
+    for(g->E--; i < g->E; i++){
+        g->ex[i] = g->ex[i + 1];
+        g->ey[i] = g->ey[i + 1];
+        g->ez[i] = g->ez[i + 1];
+    }
+    return;
+}
+
+
+static void dropAccess(Garage *g, int i){
+    g->rep[g->az[i]][g->ay[i]][g->ax[i]] = '@';
+    for(g->S--; i < g->S; i++){
+        g->ax[i] = g->ax[i + 1];
+        g->ay[i] = g->ay[i + 1];
+        g->az[i] = g->az[i + 1];
+        g->at[i] = g->at[i + 1];
+    }
+    return;
+}
+
+
+static void dropTopFloor(Case *c){
+    Garage *g = &c->g;
+    int x, y, i;
+
+    g->P--;
+    for(i = g->E - 1; i >= 0; i--)
+        if(g->ez[i] == g->P)
+            dropEntrance(c, i);
+    for(i = g->S - 1; i >= 0; i--)
+        if(g->az[i] == g->P)
+            dropAccess(g, i);
+    /* ramps up from the new top floor lead nowhere */
+    for(y = 0; y < g->M; y++)
+        for(x = 0; x < g->N; x++)
+            if(g->rep[g->P - 1][y][x] == 'u')
+                g->rep[g->P - 1][y][x] = '@';
+    return;
+}
+
+
+/*
+ * Auxiliary-function: dropLine
+ *
+ * Description:
+ *      removes inner column k from every floor, or row k if row is set.
+ *  Returns 0 if it can't, when the park is too small or an entrance or
+ *  access is on it
+ */
+
+static int dropLine(Case *c, int k, int row){
+    Garage *g = &c->g;
+    int z, i, j, length = row ? g->M : g->N, across = row ? g->N : g->M;
+
+    if(length <= 3)
+        return 0;
+    for(i = 0; i < g->E; i++)
+        if( (row ? g->ey[i] : g->ex[i]) == k)
+            return 0;
+    for(i = 0; i < g->S; i++)
+        if( (row ? g->ay[i] : g->ax[i]) == k)
+            return 0;
+
+    /* every line after k moves one back */
+    for(z = 0; z < g->P; z++)
+        for(j = 0; j < across; j++)
+            for(i = k; i < length - 1; i++)
+                if(row)
+                    g->rep[z][i][j] = g->rep[z][i + 1][j];
+                else
+                    g->rep[z][j][i] = g->rep[z][j][i + 1];
+
+    for(i = 0; i < g->E; i++)
+        if(row && g->ey[i] > k)
+            g->ey[i]--;
+        else if(!row && g->ex[i] > k)
+            g->ex[i]--;
+    for(i = 0; i < g->S; i++)
+        if(row && g->ay[i] > k)
+            g->ay[i]--;
+        else if(!row && g->ax[i] > k)
+            g->ax[i]--;
+    for(i = 0; i < c->nEvents; i++)
+        if(row){
+            c->ev[i].y -= c->ev[i].y > k;
+            c->ev[i].y2 -= c->ev[i].y2 > k;
+        } else{
+            c->ev[i].x -= c->ev[i].x > k;
+            c->ev[i].x2 -= c->ev[i].x2 > k;
+        }
+
+    if(row)
+        g->M--;
+    else
+        g->N--;
+    return 1;
+}
+
+
+/*
+ * Auxiliary-function: wallCell
+ *
+ * Description:
+ *      turns an inner cell into a wall, both ends of a ramp together.
+ *  Returns 0 if it already was one
+ */
+
+static int wallCell(Garage *g, int x, int y, int z){
+    char c = g->rep[z][y][x];
+
+    if(c == '@')
+        return 0;
+    g->rep[z][y][x] = '@';
+    if(c == 'u')
+        g->rep[z + 1][y][x] = '@';
+    if(c == 'd')
+        g->rep[z - 1][y][x] = '@';
+    return 1;
+}
+
+
+/*
+ * Auxiliary-function: keepIfFails
+ *
+ * Description:
+ *      if the reduced case t still fails, it becomes the case c, without
+ *  the events after its failure. Returns 1 if it did
+ */
+
+static int keepIfFails(Case *c, Case *t, char *engine){
+    char why[WHYSIZE];
+    int failed = playCase(t, engine, why);
+
+    if(failed < 0)
+        return 0;
+    t->nEvents = failed + 1;
+    *c = *t;
+    return 1;
+}
+
+
+/*
+ * Auxiliary-function: shrinkCase
+ *
+ * Description:
+ *      makes a failing case smaller for as long as it keeps failing, trying
+ *  every reduction again after any of them works
+ */
+
+static void shrinkCase(Case *c, char *engine){
+    static Case t;
+    int changed = 1, i, x, y, z;
+
+    t = *c;
+    keepIfFails(c, &t, engine);
+
+    while(changed){
+        changed = 0;
+        for(i = c->nEvents - 1; i >= 0; i--){
+            t = *c;
+            dropEvent(&t, i);
+            changed |= keepIfFails(c, &t, engine);
+            if(i > c->nEvents)
+                i = c->nEvents;
+        }
+        while(c->g.P > 1){
+            t = *c;
+            dropTopFloor(&t);
+            if(keepIfFails(c, &t, engine) == 0)
+                break;
+            changed = 1;
+        }
+        for(x = c->g.N - 2; x >= 1; x--){
+            t = *c;
+            if(dropLine(&t, x, 0))
+                changed |= keepIfFails(c, &t, engine);
+        }
+        for(y = c->g.M - 2; y >= 1; y--){
+            t = *c;
+            if(dropLine(&t, y, 1))
+                changed |= keepIfFails(c, &t, engine);
+        }
+        for(i = c->g.E - 1; i >= 0; i--){
+            t = *c;
+            dropEntrance(&t, i);
+            changed |= keepIfFails(c, &t, engine);
+        }
+        for(i = c->g.S - 1; i >= 0; i--){
+            t = *c;
+            dropAccess(&t.g, i);
+            changed |= keepIfFails(c, &t, engine);
+        }
+        for(z = 0; z < c->g.P; z++)
+            for(y = 1; y < c->g.M - 1; y++)
+                for(x = 1; x < c->g.N - 1; x++){
+                    t = *c;
+                    if(wallCell(&t.g, x, y, z))
+                        changed |= keepIfFails(c, &t, engine);
+                }
+    }
+    return;
+}
+
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ * Auxiliary-function: testEngine
+ *
+ * Description:
+ *      plays the cases with an engine, the same ones for every engine.
+ *  Returns 1 if one failed, after printing it shrunk
+ */
+
+static int testEngine(char *engine, int nCases, unsigned long firstSeed){
+    static Case c;
+    char why[WHYSIZE];
+    int n, i, events = 0;
+
+    seed = firstSeed;
+    compared = 0;
+    for(n = 0; n < nCases; n++){
+        generateCase(&c);
+        events += c.nEvents;
+        if(playCase(&c, engine, why) < 0)
+            continue;
+
+        printf("%s: case %d differs from the reference, shrinking\n",
+                                                                engine, n + 1);
+        shrinkCase(&c, engine);
+        i = playCase(&c, engine, why);
+        printf("%s: after event %d, %s\n\npark:\n", engine, i + 1, why);
+        writeGarage(stdout, &c.g);
+        printf("\nevents:\n");
+        for(i = 0; i < c.nEvents; i++)
+            writeEvent(stdout, &c.ev[i]);
+        return 1;
+    }
+    printf("%s: %d cases, %d events, %ld paths, same as the reference\n",
+                                            engine, nCases, events, compared);
+    return 0;
+}
+
+
+static int isEngine(char *name){
+    int i;
+
+    for(i = 0; Ename(i) != NULL; i++)
+        if(strcmp(Ename(i), name) == 0)
+            return 1;
+    return 0;
+}
+
+
+int main(int argc, char *argv[]){
+    int nCases = 500, i, failed = 0, tested = 0;
+    unsigned long firstSeed = 1;
+
+    for(i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            nCases = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+            firstSeed = strtoul(argv[++i], NULL, 10);
+        else if(strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+            i++;
+        else if(strcmp(argv[i], "-a") != 0){
+            fprintf(stderr,
+                "Usage: %s [-n cases] [-x seed] [-e engine ...] [-a]\n",
+                                                                    argv[0]);
+            exit(1);
+        }
+    }
+
+    for(i = 1; i < argc; i++)
+        if(strcmp(argv[i], "-e") == 0){
+            i++;
+            if(isEngine(argv[i]) == 0){
+                fprintf(stderr, "Unknown engine %s\n", argv[i]);
+                exit(1);
+            }
+            failed |= testEngine(argv[i], nCases, firstSeed);
+            tested = 1;
+        } else if(strcmp(argv[i], "-a") == 0){
+            failed |= testEngine(GROUPED, nCases, firstSeed);
+            tested = 1;
+        } else if(strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "-x") == 0)
+            i++;
+
+    if(tested == 0){
+        for(i = 1; Ename(i) != NULL; i++)
+            failed |= testEngine(Ename(i), nCases, firstSeed);
+        /* with nothing else registered, at least the harness is checked */
+        if(i == 1)
+            failed |= testEngine(Ename(0), nCases, firstSeed);
+        failed |= testEngine(GROUPED, nCases, firstSeed);
+    }
+
+    exit(failed);
+}
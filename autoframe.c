@@ -0,0 +1,150 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: checks of the route server framing
+ *
+ *               Gives frameParse and frameRead (through a pipe) well formed
+ *          and malformed length lines and checks that each one is accepted
+ *          with the right length, waits for more bytes, or is refused.
+ *          Lengths that don't fit in an int, with too many digits or
+ *          above MAXFRAME must be refused and never come out negative.
+ *
+ *          To run:
+ *              autoframe
+ *
+ *          Exits with 1 if any check fails.
+ *
+ *  Non standard interface dependencies:
+ *      frame.h - message framing
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* pipe, read and write are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+
+#include"frame.h"
+
+
+/*
+ *  Data Type: FrameCase
+ *
+ *  Description:
+ *      received bytes and what frameParse must say about them: 1 with the
+ *  payload length, 0 for more bytes needed, -1 for an invalid frame
+ */
+
+typedef struct _frameCase{
+    char *bytes;
+    int ret, len;
+} FrameCase;
+
+static FrameCase cases[] = {
+    {"0\n", 1, 0},
+    {"5\nhello", 1, 5},
+    {"5\nhell", 0, 0},
+    {"12", 0, 0},
+    {"16777216\n", 0, 16777216},       /* MAXFRAME, payload still to come */
+    {"00000003\nabc", 1, 3},
+    {"16777217\n", -1, 0},             /* above MAXFRAME */
+    {"99999999\n", -1, 0},
+    {"4294967295\n", -1, 0},           /* -1 as an unsigned 32 bit int */
+    {"2147483648\n", -1, 0},
+    {"123456789", -1, 0},              /* nine digits, no newline yet */
+    {"\n", -1, 0},
+    {"-1\n", -1, 0},
+    {"+5\nhello", -1, 0},
+    {" 5\nhello", -1, 0},
+    {"5x\nhello", -1, 0},
+    {NULL, 0, 0}
+};
+
+
+/*
+ * Auxiliary-function: checkParse
+ *
+ * Description:
+ *      checks frameParse on one case
+ *
+ * Return value:
+ *      0 if it passed, 1 otherwise
+ */
+
+static int checkParse(FrameCase *c){
+    int ret, start = -1, len = -1;
+
+    ret = frameParse(c->bytes, (int) strlen(c->bytes), &start, &len);
+    if(ret != c->ret || (ret == 1 && (len != c->len ||
+                                            start != strchr(c->bytes, '\n')
+                                                        - c->bytes + 1))){
+        fprintf(stderr, "frameParse \"%s\": got %d (length %d), "
+                        "expected %d (length %d)\n", c->bytes, ret, len,
+                                                            c->ret, c->len);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: checkRead
+ *
+ * Description:
+ *      checks frameRead on one case, written whole to a pipe and then
+ *  closed, so a frame that needs more bytes must end in NULL
+ *
+ * Return value:
+ *      0 if it passed, 1 otherwise
+ */
+
+static int checkRead(FrameCase *c){
+    int fds[2], len = -1, size = (int) strlen(c->bytes), bad;
+    char *payload;
+
+    if(pipe(fds) < 0){
+        perror("pipe");
+        exit(1);
+    }
+    if(write(fds[1], c->bytes, size) != size){
+        perror("write");
+        exit(1);
+    }
+    close(fds[1]);
+
+    payload = frameRead(fds[0], &len);
+    close(fds[0]);
+    if(c->ret == 1)
+        bad = payload == NULL || len != c->len ||
+                    memcmp(payload, strchr(c->bytes, '\n') + 1, len) != 0;
+    else
+        bad = payload != NULL;
+    if(bad)
+        fprintf(stderr, "frameRead \"%s\": got %s (length %d)\n", c->bytes,
+                                payload != NULL ? "a frame" : "none", len);
+    free(payload);
+    return bad;
+}
+
+
+int main(int argc, char *argv[]){
+    int i, failed = 0;
+
+    if(argc > 1){
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        exit(1);
+    }
+
+    for(i = 0; cases[i].bytes != NULL; i++)
+        failed += checkParse(&cases[i]) + checkRead(&cases[i]);
+
+    printf("%d frames, %d checks failed\n", i, failed);
+    exit(failed > 0 ? 1 : 0);
+}
@@ -0,0 +1,623 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: output regression and performance gate
+ *
+ *               Runs autopark on every scenario, checks that its .pts output
+ *          is exactly the expected one and that it didn't get slower or use
+ *          more memory than in a stored baseline.
+ *
+ *          To run:
+ *              autogate [-p program] [-g golden] [-b baseline] [-r runs]
+ *                       [-t percent] [-m seconds] [-u] [park.cfg ...]
+ *
+ *          Without scenarios the built-in ones are run (data/, mais-testes/
+ *          and tests/). For each scenario the configuration file is copied
+ *          to a temporary directory, so the .pts files next to it are never
+ *          written, and the program (./autopark by default) is run there
+ *          with the .inp and, if there is one, the .res of the scenario.
+ *
+ *          The runs file (tests/runs.txt) gives more runs of some scenarios,
+ *          one per line: the configuration file and the options the program
+ *          is given, as in "tests/garSat.cfg -a grouped". Each one is made
+ *          right after the scenario's own run and checked the same way,
+ *          with the options as part of its name in the golden and baseline
+ *          files.
+ *
+ *          The golden file (tests/golden.txt) has the size and CRC-32 of the
+ *          expected output of each scenario. The baseline file
+ *          (tests/baseline.txt) has the time in seconds and the peak
+ *          resident memory in KB of each scenario. A scenario fails if its
+ *          output is different, or if its time or memory is more than
+ *          percent (20) above the baseline. Time differences under seconds
+ *          (0.05) and memory differences under 1 MB are taken as noise.
+ *
+ *          With -u, the golden and baseline files are written with the
+ *          results of this run instead, for the scenarios run.
+ *
+ *          Returns 0 if every scenario passed, 1 otherwise. Outputs which
+ *          aren't the expected ones are left in the temporary directory.
+ *
+ *  Implementation details:
+ *      The program runs in a child process, which gives its own peak memory
+ *
+ *  Non standard interface dependencies:
+ *      scenario.h - built-in scenarios
+ *      timing.h - monotonic clock
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* fork, mkdtemp and wait4 are POSIX and BSD, not ANSI C */
+#define _DEFAULT_SOURCE
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<fcntl.h>
+#include<sys/types.h>
+#include<sys/time.h>
+#include<sys/resource.h>
+#include<sys/wait.h>
+
+#include"scenario.h"
+#include"timing.h"
+
+
+#define MAXSCENARIOS 256
+#define NAMESIZE 1024
+/* most options of a run and length of a golden or baseline line */
+#define MAXOPTS 32
+#define LINESIZE 2048
+/* memory differences taken as noise, in KB */
+#define MEMSLACK 1024
+
+
+/*
+ *  Data Type: Result
+ *
+ *  Description:
+ *      what is known of a scenario, from the golden and baseline files
+ *  (-1 when it isn't there) and from this run
+ */
+
+typedef struct _result{
+    char cfg[NAMESIZE];
+    char opts[NAMESIZE];      /* options of the run, "" for the plain one */
+    long goldSize;
+    unsigned long goldCrc;
+    double baseTime;
+    long baseKB;
+
+    long size;
+    unsigned long crc;
+    double time;
+    long kb;
+    int ran;
+} Result;
+
+
+/*
+ *  Data Type: Run
+ *
+ *  Description:
+ *      a run of the runs file, a scenario with options
+ */
+
+typedef struct _run{
+    char cfg[NAMESIZE];
+    char opts[NAMESIZE];
+} Run;
+
+
+/*
+ * Auxiliary-function: fileCrc
+ *
+ * Description:
+ *      CRC-32 and size of a file
+ *
+ * Return value:
+ *      0 on success, -1 if it can't be read
+ */
+
+static int fileCrc(char *filename, unsigned long *crc, long *size){
+    FILE *fp;
+    unsigned long c = 0xffffffffUL;
+    int ch, k;
+
+    fp = fopen(filename, "rb");
+    if(fp == NULL)
+        return -1;
+
+    *size = 0;
+    while( (ch = getc(fp)) != EOF){
+        c ^= (unsigned long) ch;
+        for(k = 0; k < 8; k++)
+            c = (c & 1) ? (c >> 1) ^ 0xedb88320UL : c >> 1;
+        (*size)++;
+    }
+    fclose(fp);
+
+    *crc = (c ^ 0xffffffffUL) & 0xffffffffUL;
+    return 0;
+}
+
+
+static Result *findResult(Result *r, int n, char *cfg, char *opts){
+    int i;
+
+    for(i = 0; i < n; i++)
+        if(strcmp(r[i].cfg, cfg) == 0 && strcmp(r[i].opts, opts) == 0)
+            return &r[i];
+    return NULL;
+}
+
+
+static Result *addResult(Result *r, int *n, char *cfg, char *opts){
+    Result *res = findResult(r, *n, cfg, opts);
+
+    if(res != NULL || *n == MAXSCENARIOS || strlen(cfg) >= NAMESIZE ||
+                                                    strlen(opts) >= NAMESIZE)
+        return res;
+    res = &r[(*n)++];
+    strcpy(res->cfg, cfg);
+    strcpy(res->opts, opts);
+    res->goldSize = -1;
+    res->goldCrc = 0;
+    res->baseTime = -1;
+    res->baseKB = -1;
+    res->size = 0;
+    res->crc = 0;
+    res->time = 0;
+    res->kb = 0;
+    res->ran = 0;
+    return res;
+}
+
+
+/*
+ * Auxiliary-function: splitLine
+ *
+ * Description:
+ *      splits a line of the golden, baseline or runs files in its words: the
+ *  configuration file, the options of the run, which are all the words up to
+ *  the last nNumbers, joined by spaces, and those, left in numbers
+ *
+ * Return value:
+ *      1 on success, 0 if the line has too few or too many words
+ */
+
+static int splitLine(char *line, char *cfg, char *opts, int nNumbers,
+                                                            char **numbers){
+    char *words[MAXOPTS + 3];
+    int n = 0, i;
+
+    for(words[n] = strtok(line, " \t\n"); words[n] != NULL;
+                                    words[n] = strtok(NULL, " \t\n"))
+        if(++n == MAXOPTS + 3)
+            return 0;
+    if(n < 1 + nNumbers || strlen(words[0]) >= NAMESIZE)
+        return 0;
+
+    strcpy(cfg, words[0]);
+    opts[0] = '\0';
+    for(i = 1; i < n - nNumbers; i++){
+        if(strlen(opts) + strlen(words[i]) + 2 > NAMESIZE)
+            return 0;
+        if(i > 1)
+            strcat(opts, " ");
+        strcat(opts, words[i]);
+    }
+    for(i = 0; i < nNumbers; i++)
+        numbers[i] = words[n - nNumbers + i];
+    return 1;
+}
+
+
+/*
+ * Auxiliary-function: loadGolden, loadBaseline
+ *
+ * Description:
+ *      read the golden and baseline files, one run per line: the scenario,
+ *  the options it was run with, if any, and the two numbers. A missing file
+ *  is the same as an empty one
+ */
+
+static void loadGolden(char *filename, Result *r, int *n){
+    FILE *fp;
+    char line[LINESIZE], cfg[NAMESIZE], opts[NAMESIZE], *numbers[2];
+    Result *res;
+
+    fp = fopen(filename, "r");
+    if(fp == NULL)
+        return;
+    while(fgets(line, LINESIZE, fp) != NULL){
+        if(splitLine(line, cfg, opts, 2, numbers) == 0)
+            continue;
+        res = addResult(r, n, cfg, opts);
+        if(res == NULL)
+            continue;
+        res->goldSize = atol(numbers[0]);
+        res->goldCrc = strtoul(numbers[1], NULL, 16);
+    }
+    fclose(fp);
+    return;
+}
+
+
+static void loadBaseline(char *filename, Result *r, int *n){
+    FILE *fp;
+    char line[LINESIZE], cfg[NAMESIZE], opts[NAMESIZE], *numbers[2];
+    Result *res;
+
+    fp = fopen(filename, "r");
+    if(fp == NULL)
+        return;
+    while(fgets(line, LINESIZE, fp) != NULL){
+        if(splitLine(line, cfg, opts, 2, numbers) == 0)
+            continue;
+        res = addResult(r, n, cfg, opts);
+        if(res == NULL)
+            continue;
+        res->baseTime = atof(numbers[0]);
+        res->baseKB = atol(numbers[1]);
+    }
+    fclose(fp);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: loadRuns
+ *
+ * Description:
+ *      reads the runs file, a scenario and its options per line. A missing
+ *  file is the same as an empty one
+ *
+ * Return value:
+ *      number of runs read
+ */
+
+static int loadRuns(char *filename, Run *runs){
+    FILE *fp;
+    char line[LINESIZE];
+    int n = 0;
+
+    fp = fopen(filename, "r");
+    if(fp == NULL)
+        return 0;
+    while(n < MAXSCENARIOS && fgets(line, LINESIZE, fp) != NULL)
+        if(splitLine(line, runs[n].cfg, runs[n].opts, 0, NULL) &&
+                                                    runs[n].opts[0] != '\0')
+            n++;
+    fclose(fp);
+    return n;
+}
+
+
+/*
+ * Auxiliary-function: changeName
+ *
+ * Description:
+ *      copies a configuration file name changing its .cfg ending
+ */
+
+static void changeName(char *dest, char *cfg, char *ending){
+    strcpy(dest, cfg);
+    strcpy(dest + strlen(dest) - 4, ending);
+    return;
+}
+
+
+static int copyFile(char *from, char *to){
+    FILE *in, *out;
+    int ch;
+
+    in = fopen(from, "rb");
+    if(in == NULL)
+        return -1;
+    out = fopen(to, "wb");
+    if(out == NULL){
+        fclose(in);
+        return -1;
+    }
+    while( (ch = getc(in)) != EOF)
+        putc(ch, out);
+    fclose(in);
+    fclose(out);
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: runScenarioChild
+ *
+ * Description:
+ *      runs the program on a scenario in a child process, saving the size and
+ *  CRC of its output, its time and its peak memory
+ *
+ * Return value:
+ *      0 on success, -1 if it couldn't be run or didn't end well
+ */
+
+static int runScenarioChild(char *program, char *tmpdir, Result *res,
+                                                                int update){
+    char cfg[2 * NAMESIZE + 16], inp[NAMESIZE], resf[NAMESIZE];
+    char pts[2 * NAMESIZE + 16], opts[NAMESIZE], *base, *args[MAXOPTS + 5];
+    struct rusage usage;
+    FILE *fp;
+    double t0;
+    pid_t pid;
+    int status, hasRes, fd, nArgs = 0, i;
+
+    changeName(inp, res->cfg, ".inp");
+    changeName(resf, res->cfg, ".res");
+    fp = fopen(resf, "r");
+    hasRes = fp != NULL;
+    if(fp != NULL)
+        fclose(fp);
+
+    base = strrchr(res->cfg, '/');
+    base = base == NULL ? res->cfg : base + 1;
+    sprintf(cfg, "%s/%s", tmpdir, base);
+    if(res->opts[0] != '\0'){
+        /* each run its own output, named after its options */
+        sprintf(cfg + strlen(cfg) - 4, "_%s.cfg", res->opts);
+        for(i = strlen(tmpdir) + 1; cfg[i] != '\0'; i++)
+            if(cfg[i] == ' ')
+                cfg[i] = '_';
+    }
+    changeName(pts, cfg, ".pts");
+
+    /* the program, the options of the run and the files */
+    strcpy(opts, res->opts);
+    args[nArgs++] = program;
+    for(args[nArgs] = strtok(opts, " "); args[nArgs] != NULL &&
+                nArgs < MAXOPTS + 1; args[nArgs] = strtok(NULL, " "))
+        nArgs++;
+    args[nArgs++] = cfg;
+    args[nArgs++] = inp;
+    if(hasRes)
+        args[nArgs++] = resf;
+    args[nArgs] = NULL;
+    if(copyFile(res->cfg, cfg) < 0){
+        fprintf(stderr, "Couldn't copy %s\n", res->cfg);
+        return -1;
+    }
+
+    t0 = Tnow();
+    pid = fork();
+    if(pid < 0){
+        perror("fork");
+        return -1;
+    }
+    if(pid == 0){
+        /* latency reports go away, only the .pts matters */
+        fd = open("/dev/null", O_WRONLY);
+        if(fd >= 0){
+            dup2(fd, 1);
+            dup2(fd, 2);
+        }
+        execv(program, args);
+        _exit(127);
+    }
+    if(wait4(pid, &status, 0, &usage) < 0){
+        perror("wait4");
+        return -1;
+    }
+    res->time = Tnow() - t0;
+    res->kb = usage.ru_maxrss;
+    res->ran = 1;
+
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+        fprintf(stderr, "%s: %s didn't end well\n", res->cfg, program);
+        return -1;
+    }
+    if(fileCrc(pts, &res->crc, &res->size) < 0){
+        fprintf(stderr, "%s: no output %s\n", res->cfg, pts);
+        return -1;
+    }
+    /* only different outputs are kept, to look at them */
+    if(update || (res->goldSize == res->size && res->goldCrc == res->crc))
+        remove(pts);
+    remove(cfg);
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: regressed
+ *
+ * Description:
+ *      tells whether a measure is beyond the allowed threshold
+ */
+
+static int regressed(double now, double base, double percent, double slack){
+    if(base < 0)
+        return 0;
+    return now > base * (1.0 + percent / 100.0) + slack;
+}
+
+
+static void writeFiles(char *golden, char *baseline, Result *r, int n){
+    FILE *g, *b;
+    int i;
+
+    g = fopen(golden, "w");
+    b = fopen(baseline, "w");
+    if(g == NULL || b == NULL){
+        fprintf(stderr, "Couldn't write %s and %s\n", golden, baseline);
+        exit(2);
+    }
+    for(i = 0; i < n; i++){
+        if(r[i].goldSize >= 0)
+            fprintf(g, "%s%s%s %ld %08lx\n", r[i].cfg,
+                                    r[i].opts[0] != '\0' ? " " : "",
+                                    r[i].opts, r[i].goldSize, r[i].goldCrc);
+        if(r[i].baseTime >= 0)
+            fprintf(b, "%s%s%s %.3f %ld\n", r[i].cfg,
+                                    r[i].opts[0] != '\0' ? " " : "",
+                                    r[i].opts, r[i].baseTime, r[i].baseKB);
+    }
+    fclose(g);
+    fclose(b);
+    return;
+}
+
+
+static void usage(char *prog){
+    fprintf(stderr, "Usage: %s [-p program] [-g golden] [-b baseline] "
+                    "[-r runs] [-t percent] [-m seconds] [-u] "
+                    "[park.cfg ...]\n", prog);
+    exit(2);
+}
+
+
+/*
+ * Auxiliary-function: gateRun
+ *
+ * Description:
+ *      makes one run, prints its line of the table and, with update, keeps
+ *  its results as the new golden and baseline
+ *
+ * Return value:
+ *      1 if it failed, 0 otherwise
+ */
+
+static int gateRun(char *program, char *tmpdir, Result *res, int update,
+                                            double percent, double slack){
+    char name[2 * NAMESIZE], *verdict;
+    int bad;
+
+    bad = runScenarioChild(program, tmpdir, res, update) < 0;
+    if(bad)
+        verdict = "ERROR";
+    else if(update)
+        verdict = "UPDATED";
+    else if(res->goldSize < 0)
+        verdict = "NOGOLD";
+    else if(res->goldSize != res->size || res->goldCrc != res->crc)
+        verdict = "DIFF";
+    else if(regressed(res->time, res->baseTime, percent, slack))
+        verdict = "SLOWER";
+    else if(regressed((double) res->kb, (double) res->baseKB, percent,
+                                                            MEMSLACK))
+        verdict = "MEMORY";
+    else
+        verdict = "ok";
+
+    sprintf(name, "%s%s%s", res->cfg, res->opts[0] != '\0' ? " " : "",
+                                                                res->opts);
+    printf("%-40s %-8s %9.3f ", name, verdict, res->time);
+    if(res->baseTime > 0)
+        printf("%9.3f %+6.1f%% ", res->baseTime,
+                        100.0 * (res->time - res->baseTime) / res->baseTime);
+    else
+        printf("%9s %7s ", "-", "-");
+    if(res->baseKB >= 0)
+        printf("%9ld %9ld\n", res->kb, res->baseKB);
+    else
+        printf("%9ld %9s\n", res->kb, "-");
+    fflush(stdout);
+
+    if(update && !bad){
+        res->goldSize = res->size;
+        res->goldCrc = res->crc;
+        res->baseTime = res->time;
+        res->baseKB = res->kb;
+    }
+    return strcmp(verdict, "ok") != 0 && strcmp(verdict, "UPDATED") != 0;
+}
+
+
+int main(int argc, char *argv[]){
+    Result r[MAXSCENARIOS], *res;
+    Run runs[MAXSCENARIOS];
+    char *names[MAXSCENARIOS];
+    char tmpdir[] = "/tmp/autogateXXXXXX";
+    char *program = "./autopark", *golden = "tests/golden.txt";
+    char *baseline = "tests/baseline.txt", *runsFile = "tests/runs.txt";
+    double percent = 20, slack = 0.05;
+    int update = 0, nNames = 0, suite = 0, nResults = 0, failed = 0;
+    int nRuns, nMade = 0, i, j;
+
+    for(i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-u") == 0)
+            update = 1;
+        else if(argv[i][0] == '-' && i + 1 == argc)
+            usage(argv[0]);
+        else if(strcmp(argv[i], "-p") == 0)
+            program = argv[++i];
+        else if(strcmp(argv[i], "-g") == 0)
+            golden = argv[++i];
+        else if(strcmp(argv[i], "-b") == 0)
+            baseline = argv[++i];
+        else if(strcmp(argv[i], "-r") == 0)
+            runsFile = argv[++i];
+        else if(strcmp(argv[i], "-t") == 0)
+            percent = atof(argv[++i]);
+        else if(strcmp(argv[i], "-m") == 0)
+            slack = atof(argv[++i]);
+        else if(argv[i][0] == '-')
+            usage(argv[0]);
+        else if(nNames < MAXSCENARIOS)
+            names[nNames++] = argv[i];
+    }
+    if(nNames == 0){
+        nNames = listSuite(names, MAXSCENARIOS);
+        suite = 1;
+    }
+
+    loadGolden(golden, r, &nResults);
+    loadBaseline(baseline, r, &nResults);
+    nRuns = loadRuns(runsFile, runs);
+
+    if(mkdtemp(tmpdir) == NULL){
+        perror("mkdtemp");
+        exit(2);
+    }
+
+    printf("%-40s %-8s %9s %9s %7s %9s %9s\n", "scenario", "result",
+                            "time(s)", "base(s)", "change", "peak(KB)",
+                            "base(KB)");
+    for(i = 0; i < nNames; i++){
+        if(strlen(names[i]) < 5 ||
+                    strcmp(names[i] + strlen(names[i]) - 4, ".cfg") != 0){
+            fprintf(stderr, "Not a configuration file: %s\n", names[i]);
+            failed++;
+            continue;
+        }
+        res = addResult(r, &nResults, names[i], "");
+        if(res == NULL)
+            continue;
+        failed += gateRun(program, tmpdir, res, update, percent, slack);
+        nMade++;
+
+        /* and the runs of the scenario with options */
+        for(j = 0; j < nRuns; j++){
+            if(strcmp(runs[j].cfg, names[i]) != 0)
+                continue;
+            res = addResult(r, &nResults, runs[j].cfg, runs[j].opts);
+            if(res == NULL)
+                continue;
+            failed += gateRun(program, tmpdir, res, update, percent, slack);
+            nMade++;
+        }
+    }
+
+    if(update)
+        writeFiles(golden, baseline, r, nResults);
+    /* empty unless some output was different */
+    if(rmdir(tmpdir) < 0)
+        printf("outputs of failed scenarios kept in %s\n", tmpdir);
+
+    printf("%d runs of %d scenarios, %d failed\n", nMade, nNames, failed);
+    if(suite)
+        for(i = 0; i < nNames; i++)
+            free(names[i]);
+    exit(failed > 0 ? 1 : 0);
+}
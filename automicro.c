@@ -0,0 +1,424 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: container microbenchmarks
+ *
+ *               Measures the container modules on their own, with the
+ *          workloads the park program gives them, so they can be compared
+ *          with replacements. For each workload prints the number of
+ *          operations, the time per operation in nanoseconds (best of the
+ *          repetitions) and the memory allocations per operation.
+ *
+ *          To run:
+ *              automicro [-s scale] [-r repetitions] [workload ...]
+ *
+ *          Workloads (all of them by default):
+ *              pq-init      PQinit of a grid sized queue
+ *              pq-dijkstra  PQupdateNode and PQdelmin of a search over a
+ *                           grid with edges of weight 1 to 3
+ *              ht-insert    HTinsert of Vaaaa style ids
+ *              ht-hit       HTget of ids in the table
+ *              ht-miss      HTget of ids not in the table
+ *              queue-burst  Qpush and Qpop in bursts
+ *              list-merge   mergeOrderedLists of two lists, 100k items
+ *
+ *          The scale multiplies the size of every workload, or the side of
+ *          the grids (1 by default).
+ *
+ *  Implementation details:
+ *      Allocations are counted by wrapping malloc, calloc and realloc with
+ *  the linker (ld --wrap), so the modules are measured unchanged
+ *
+ *  Non standard interface dependencies:
+ *      prioQ.h, htable.h, queue.h, LinkedList.h - modules measured
+ *      timing.h - monotonic clock
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"prioQ.h"
+#include"htable.h"
+#include"queue.h"
+#include"LinkedList.h"
+#include"graphL.h"
+#include"timing.h"
+
+
+/* ---------------------------------------------------------------------- */
+/* allocation counting, the linker sends every call of the modules here    */
+
+static long nAllocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+void *__wrap_malloc(size_t size){
+    nAllocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size){
+    nAllocs++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size){
+    nAllocs++;
+    return __real_realloc(p, size);
+}
+
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  Data Type: Measure
+ *
+ *  Description:
+ *      what a workload run gives back: operations, time and allocations
+ *  made inside the timed part
+ */
+
+typedef struct _measure{
+    long ops;
+    double time;
+    long allocs;
+} Measure;
+
+static int scale = 1;
+
+/* timed part of a workload, between start and stop */
+static double tStart;
+static long aStart;
+
+static void start(void){
+    aStart = nAllocs;
+    tStart = Tnow();
+}
+
+static void stop(Measure *m, long ops){
+    m->time = Tnow() - tStart;
+    m->allocs = nAllocs - aStart;
+    m->ops = ops;
+}
+
+
+/*
+ * Auxiliary-function: makeId
+ *
+ * Description:
+ *      k-th car id in the style of the test files (Vaaaa, Vaaab, ...)
+ */
+
+static void makeId(char *id, char first, int k){
+    int i;
+
+    id[0] = first;
+    for(i = 4; i >= 1; i--){
+        id[i] = 'a' + k % 26;
+        k /= 26;
+    }
+    id[5] = '\0';
+}
+
+
+/* --- prioQ ------------------------------------------------------------ */
+
+#define GRIDSIDE 100
+
+static void benchPQinit(Measure *m){
+    int n = GRIDSIDE * GRIDSIDE * scale, reps = 100, i;
+    int *wt = (int *) malloc(sizeof(int) * n);
+    PrioQ *PQ;
+
+    for(i = 0; i < n; i++)
+        wt[i] = NOCON;
+    start();
+    for(i = 0; i < reps; i++){
+        PQ = PQinit(wt, n);
+        PQdestroy(PQ);
+    }
+    stop(m, reps);
+    free(wt);
+}
+
+
+/*
+ * Auxiliary-function: benchPQdijkstra
+ *
+ * Description:
+ *      search from the center of a side x side grid with 4 neighbours per
+ *  node and edges of weight 1 to 3, so nodes are reached more than once as
+ *  in GDijkstra. Operations are the delmins and the node updates
+ */
+
+static void benchPQdijkstra(Measure *m){
+    int side = GRIDSIDE * scale, n = side * side;
+    int *wt, *edge, u, v, k, x, y, w;
+    long ops = 0;
+    PrioQ *PQ;
+    static int dx[] = {1, -1, 0, 0}, dy[] = {0, 0, 1, -1};
+
+    wt = (int *) malloc(sizeof(int) * n);
+    edge = (int *) malloc(sizeof(int) * n * 4);
+    srand(1);
+    for(u = 0; u < n; u++)
+        wt[u] = NOCON;
+    for(u = 0; u < n * 4; u++)
+        edge[u] = 1 + rand() % 3;
+    PQ = PQinit(wt, n);
+
+    start();
+    u = side / 2 + side * (side / 2);
+    wt[u] = 0;
+    PQupdateNode(PQ, u);
+    ops++;
+    while(!PQisempty(PQ)){
+        u = PQdelmin(PQ);
+        ops++;
+        if(wt[u] == NOCON)
+            break;
+        x = u % side;
+        y = u / side;
+        for(k = 0; k < 4; k++){
+            if(x + dx[k] < 0 || x + dx[k] >= side ||
+                                    y + dy[k] < 0 || y + dy[k] >= side)
+                continue;
+            v = x + dx[k] + side * (y + dy[k]);
+            w = wt[u] + edge[4 * u + k];
+            if(w < wt[v]){
+                wt[v] = w;
+                PQupdateNode(PQ, v);
+                ops++;
+            }
+        }
+    }
+    stop(m, ops);
+
+    PQdestroy(PQ);
+    free(wt);
+    free(edge);
+}
+
+
+/* --- htable ----------------------------------------------------------- */
+
+#define NCARS 10000
+
+/* ids are made before the timed part, so only the table is measured */
+static char (*ids)[8] = NULL;
+
+static void makeIds(int n, char first){
+    int i;
+
+    ids = (char (*)[8]) malloc(sizeof(*ids) * n);
+    for(i = 0; i < n; i++)
+        makeId(ids[i], first, i);
+}
+
+
+static HashTable *fillTable(int n){
+    HashTable *ht = HTinit(n, 17);
+    int i;
+
+    for(i = 0; i < n; i++)
+        HTinsert(ht, i, ids[i]);
+    return ht;
+}
+
+
+static void benchHTinsert(Measure *m){
+    int n = NCARS * scale;
+    HashTable *ht;
+
+    makeIds(n, 'V');
+    start();
+    ht = fillTable(n);
+    stop(m, n);
+    HTdestroy(ht);
+    free(ids);
+}
+
+
+static void benchHTget(Measure *m, char first){
+    int n = NCARS * scale, i;
+    long sum = 0;
+    HashTable *ht;
+
+    makeIds(n, 'V');
+    ht = fillTable(n);
+    for(i = 0; i < n; i++)
+        ids[i][0] = first;
+
+    start();
+    for(i = 0; i < n; i++)
+        sum += HTget(ht, ids[i]);
+    stop(m, n);
+
+    /* keeps the lookups from being optimized away */
+    if(sum == 42)
+        printf(" ");
+    HTdestroy(ht);
+    free(ids);
+}
+
+
+static void benchHThit(Measure *m){
+    benchHTget(m, 'V');
+}
+
+
+static void benchHTmiss(Measure *m){
+    benchHTget(m, 'W');
+}
+
+
+/* --- queue ------------------------------------------------------------ */
+
+static void benchQueue(Measure *m){
+    int bursts = 1000 * scale, size = 100, b, i;
+    Queue *Q = Qinit();
+    long ops = 0;
+    static int item;
+
+    start();
+    for(b = 0; b < bursts; b++){
+        /* bursts of different sizes, like cars arriving and leaving */
+        for(i = 0; i < size + b % size; i++, ops++)
+            Qpush(Q, (Item) &item);
+        while(isQueueEmpty(Q) == 0){
+            Qpop(Q);
+            ops++;
+        }
+    }
+    stop(m, ops);
+    Qdestroy(Q);
+}
+
+
+/* --- LinkedList ------------------------------------------------------- */
+
+#define NITEMS 100000
+
+/* items are the times array, freed at once */
+static void keepItem(Item item){
+    return;
+}
+
+
+/* 0 if the first item goes first in the (reversed) merge, as orders do */
+static int compareTime(Item a, Item b){
+    return *(int *) a <= *(int *) b ? 1 : 0;
+}
+
+
+static void benchListMerge(Measure *m){
+    int n = NITEMS * scale, i;
+    int *times = (int *) malloc(sizeof(int) * n);
+    LinkedList *la, *lb, *merged;
+
+    /* both lists with the latest time first, as the loaders make them */
+    la = initLinkedList();
+    lb = initLinkedList();
+    for(i = 0; i < n; i++){
+        times[i] = i;
+        if(rand() % 2)
+            la = insertUnsortedLinkedList(la, (Item) &times[i]);
+        else
+            lb = insertUnsortedLinkedList(lb, (Item) &times[i]);
+    }
+
+    start();
+    merged = mergeOrderedLists(la, lb, compareTime);
+    stop(m, n);
+
+    freeLinkedList(merged, keepItem);
+    free(times);
+}
+
+
+/* ---------------------------------------------------------------------- */
+
+typedef struct _workload{
+    char *name;
+    void (*run)(Measure *);
+} Workload;
+
+static Workload workloads[] = {
+    {"pq-init", benchPQinit},
+    {"pq-dijkstra", benchPQdijkstra},
+    {"ht-insert", benchHTinsert},
+    {"ht-hit", benchHThit},
+    {"ht-miss", benchHTmiss},
+    {"queue-burst", benchQueue},
+    {"list-merge", benchListMerge},
+    {NULL, NULL}
+};
+
+
+static void runWorkload(Workload *w, int reps){
+    Measure m, best;
+    int r;
+
+    for(r = 0; r < reps; r++){
+        w->run(&m);
+        if(r == 0 || m.time < best.time)
+            best = m;
+    }
+    printf("%-14s %10ld %12.1f %10.3f\n", w->name, best.ops,
+                    best.ops > 0 ? best.time * 1e9 / best.ops : 0.0,
+                    best.ops > 0 ? (double) best.allocs / best.ops : 0.0);
+    fflush(stdout);
+}
+
+
+int main(int argc, char *argv[]){
+    int reps = 5, i, w, any = 0;
+
+    for(i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            scale = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            reps = atoi(argv[++i]);
+        else if(argv[i][0] == '-'){
+            fprintf(stderr,
+                "Usage: %s [-s scale] [-r repetitions] [workload ...]\n",
+                                                                    argv[0]);
+            exit(1);
+        }
+    }
+    if(scale < 1)
+        scale = 1;
+    if(reps < 1)
+        reps = 1;
+
+    printf("%-14s %10s %12s %10s\n", "workload", "ops", "ns/op",
+                                                            "allocs/op");
+    for(i = 1; i < argc; i++){
+        if(argv[i][0] == '-'){
+            i++;
+            continue;
+        }
+        for(w = 0; workloads[w].name != NULL; w++)
+            if(strcmp(argv[i], workloads[w].name) == 0)
+                break;
+        if(workloads[w].name == NULL){
+            fprintf(stderr, "Unknown workload %s\n", argv[i]);
+            exit(1);
+        }
+        runWorkload(&workloads[w], reps);
+        any = 1;
+    }
+    if(any == 0)
+        for(w = 0; workloads[w].name != NULL; w++)
+            runWorkload(&workloads[w], reps);
+
+    exit(0);
+}
@@ -0,0 +1,387 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: route server program
+ *
+ *               Keeps the park Map of a configuration file built in memory and
+ *          routes the cars of any number of local clients, which send their
+ *          events through a Unix domain socket. This way the park map and its
+ *          graph are only built once.
+ *
+ *          To run:
+ *              autoparkd <park.cfg> <socket path>
+ *
+ *          The messages exchanged are described in frame.h. The events of a
+ *          request are applied in order, and the cars waiting for the end of
+ *          an instant are admitted at the end of the request, so events of the
+ *          same instant must be sent in the same request. A request of COST
+ *          lines only asks what cars would get, the park is left as it is.
+ *
+ *          The server stops on SIGINT or SIGTERM
+ *
+ *  Implementation details:
+ *      A single thread serves every client with poll, requests are applied
+ *  one at a time as they are complete, so clients share the same park
+ *
+ *  Non standard interface dependencies:
+ *      parkmap.h - main program module
+ *      orders.h - Order data type
+ *      dispatch.h - applies orders to the park
+ *      frame.h - message framing
+ *      graphL.h - NOCON
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* sockets, poll and open_memstream are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<signal.h>
+#include<errno.h>
+#include<unistd.h>
+#include<poll.h>
+#include<sys/types.h>
+#include<sys/socket.h>
+#include<sys/un.h>
+
+#include"parkmap.h"
+#include"orders.h"
+#include"dispatch.h"
+#include"frame.h"
+#include"graphL.h"
+
+
+/* maximum number of clients connected at the same time */
+#define MAXCLIENTS 64
+/* size of each socket read */
+#define READSIZE 65536
+
+
+/*
+ *  Data Type: Client
+ *
+ *  Description:
+ *      connection to a client and the bytes received but not yet used
+ */
+
+typedef struct _client{
+    int fd;
+    char *buf;
+    int size, max;
+} Client;
+
+
+/* set by the signal handler to stop serving */
+static volatile sig_atomic_t stop = 0;
+
+static void onSignal(int sig){
+    stop = sig;
+}
+
+
+/*
+ *  Data Type: Server
+ *
+ *  Description:
+ *      the resident park and its dispatcher
+ */
+
+typedef struct _server{
+    char *cfgfile;
+    Map *parkMap;
+    Dispatcher *D;
+} Server;
+
+
+/*
+ * Auxiliary-function: serverLoad
+ *
+ * Description:
+ *      builds the park from the configuration file, used at start and to
+ *  serve RESET requests
+ */
+
+static int serverLoad(Server *S){
+    S->parkMap = mapInit(S->cfgfile);
+    if(S->parkMap == NULL)
+        return -1;
+    buildGraphs(S->parkMap);
+    S->D = Dinit(S->parkMap, NULL, OrderDestroy);
+    return 0;
+}
+
+
+static void serverUnload(Server *S){
+    Ddestroy(S->D);
+    mapDestroy(S->parkMap);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: serveCost
+ *
+ * Description:
+ *      answers a request of COST lines, one "<cost> <x> <y> <z>" line each
+ *  with the cost and spot a car from the entrance would get now, "-1 -1 -1
+ *  -1" if none, without parking it (see queryCost)
+ *
+ * Return value:
+ *      0 on success, -1 if the response couldn't be made or sent
+ */
+
+static int serveCost(Server *S, int fd, char *payload){
+    char *line, *next;
+    char *out = NULL;
+    size_t outSize = 0;
+    FILE *fp;
+    int ex, ey, ez, sx, sy, sz, cost, ret;
+    char type;
+
+    fp = open_memstream(&out, &outSize);
+    if(fp == NULL){
+        fprintf(stderr, "Memory error\n");
+        return -1;
+    }
+    for(line = payload; line != NULL && *line != '\0'; line = next){
+        next = strchr(line, '\n');
+        if(next != NULL)
+            *next++ = '\0';
+        if(sscanf(line, "COST %d %d %d %c", &ex, &ey, &ez, &type) != 4)
+            continue;
+        cost = queryCost(S->parkMap, ex, ey, ez, type, &sx, &sy, &sz);
+        if(cost == NOCON)
+            fprintf(fp, "-1 -1 -1 -1\n");
+        else
+            fprintf(fp, "%d %d %d %d\n", cost, sx, sy, sz);
+    }
+
+    fclose(fp);
+    ret = frameWrite(fd, out, (int) outSize);
+    free(out);
+    return ret;
+}
+
+
+/*
+ * Auxiliary-function: serveRequest
+ *
+ * Description:
+ *      applies the events of a request and sends back the produced lines
+ *
+ * Return value:
+ *      0 on success, -1 if the response couldn't be made or sent
+ */
+
+static int serveRequest(Server *S, int fd, char *payload){
+    char *line, *next;
+    char *out = NULL;
+    size_t outSize = 0;
+    FILE *fp;
+    Order *o, *lift;
+    int ret;
+
+    if(strncmp(payload, "RESET", 5) == 0){
+        serverUnload(S);
+        if(serverLoad(S) < 0){
+            fprintf(stderr, "Error producing the park Map structure\n");
+            exit(2);
+        }
+        return frameWrite(fd, "", 0);
+    }
+    if(strncmp(payload, "COST", 4) == 0)
+        return serveCost(S, fd, payload);
+
+    fp = open_memstream(&out, &outSize);
+    if(fp == NULL){
+        fprintf(stderr, "Memory error\n");
+        return -1;
+    }
+    DsetOutput(S->D, fp);
+
+    for(line = payload; line != NULL && *line != '\0'; line = next){
+        next = strchr(line, '\n');
+        if(next != NULL)
+            *next++ = '\0';
+        if(parseOrderLine(line, &o, &lift) == 0)
+            continue;
+        DapplyOrder(S->D, o);
+        /* restriction lines carry their own lifting time */
+        if(lift != NULL)
+            DscheduleOrder(S->D, lift);
+    }
+    /* the request holds every event of its instant */
+    Dflush(S->D);
+
+    fclose(fp);
+    ret = frameWrite(fd, out, (int) outSize);
+    free(out);
+    return ret;
+}
+
+
+/*
+ * Auxiliary-function: serveClient
+ *
+ * Description:
+ *      reads what a client sent and serves every complete request
+ *
+ * Return value:
+ *      0 to keep the connection, -1 to close it
+ */
+
+static int serveClient(Server *S, Client *c){
+    int n, start, len, used, ret;
+    char *payload;
+
+    if(c->max - c->size < READSIZE){
+        c->max = 2 * c->max + READSIZE;
+        c->buf = (char *) realloc(c->buf, c->max + 1);
+    }
+    n = read(c->fd, c->buf + c->size, READSIZE);
+    if(n < 0 && errno == EINTR)
+        return 0;
+    if(n <= 0)
+        return -1;
+    c->size += n;
+
+    used = 0;
+    while( (ret = frameParse(c->buf + used, c->size - used, &start, &len)) == 1){
+        payload = c->buf + used + start;
+        /* the payload is followed by the next frame, cut it temporarily */
+        n = payload[len];
+        payload[len] = '\0';
+        if(serveRequest(S, c->fd, payload) < 0)
+            return -1;
+        payload[len] = (char) n;
+        used += start + len;
+    }
+    if(ret < 0){
+        fprintf(stderr, "Invalid frame, closing connection\n");
+        return -1;
+    }
+
+    memmove(c->buf, c->buf + used, c->size - used);
+    c->size -= used;
+    return 0;
+}
+
+
+static int openSocket(char *path){
+    struct sockaddr_un addr;
+    int fd;
+
+    if(strlen(path) >= sizeof(addr.sun_path)){
+        fprintf(stderr, "Socket path too long %s\n", path);
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0){
+        perror("socket");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    if(bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+                                                    listen(fd, 16) < 0){
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+int main(int argc, char *argv[]){
+    Server S;
+    Client clients[MAXCLIENTS];
+    struct pollfd pfds[MAXCLIENTS + 1];
+    int nClients = 0;
+    int lfd, fd, i, n;
+
+    if(argc != 3){
+        fprintf(stderr, "Usage: %s <park.cfg> <socket path>\n", argv[0]);
+        exit(1);
+    }
+
+    S.cfgfile = argv[1];
+    if(serverLoad(&S) < 0){
+        fprintf(stderr, "Error producing the park Map structure\n");
+        return 2;
+    }
+
+    lfd = openSocket(argv[2]);
+    if(lfd < 0){
+        serverUnload(&S);
+        return 2;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    while(stop == 0){
+        pfds[0].fd = lfd;
+        pfds[0].events = POLLIN;
+        for(i = 0; i < nClients; i++){
+            pfds[i + 1].fd = clients[i].fd;
+            pfds[i + 1].events = POLLIN;
+        }
+
+        n = poll(pfds, nClients + 1, -1);
+        if(n < 0){
+            if(errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
+
+        /* go backwards so closed clients can be replaced by the last one */
+        for(i = nClients - 1; i >= 0; i--){
+            if(pfds[i + 1].revents == 0)
+                continue;
+            if(serveClient(&S, &clients[i]) < 0){
+                close(clients[i].fd);
+                free(clients[i].buf);
+                clients[i] = clients[--nClients];
+            }
+        }
+
+        if(pfds[0].revents & POLLIN){
+            fd = accept(lfd, NULL, NULL);
+            if(fd >= 0 && nClients == MAXCLIENTS){
+                fprintf(stderr, "Too many clients\n");
+                close(fd);
+            } else if(fd >= 0){
+                clients[nClients].fd = fd;
+                clients[nClients].buf = NULL;
+                clients[nClients].size = 0;
+                clients[nClients].max = 0;
+                nClients++;
+            }
+        }
+    }
+
+    for(i = 0; i < nClients; i++){
+        close(clients[i].fd);
+        free(clients[i].buf);
+    }
+    close(lfd);
+    unlink(argv[2]);
+    /* path query times since the last reset */
+    DprintLatency(S.D, stderr, S.cfgfile);
+    serverUnload(&S);
+
+    exit(0);
+}
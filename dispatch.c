@@ -0,0 +1,917 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: applies park Orders to a Map and writes the results
+ *
+ *  Implementation details:
+ *      Cars that can't enter the park are kept in a first in first out
+ *  queue and retried whenever a spot is freed or a restriction is lifted.
+ *
+ *      Several freeing/restriction orders (state changes) may happen at
+ *  the same instant, the waiting cars must only be retried after the last of
+ *  them. Orders are taken in ticks: the changes of one instant, up to an
+ *  arrival or to the next instant, make a batch which is applied change by
+ *  change, and the waiting cars are admitted once when the batch is closed,
+ *  as its last change says (see admissionAfter). Nothing needs to be looked
+ *  ahead in the order list, so orders may come from a list, a whole instant
+ *  at a time (DapplyTick), or be read one at a time as they happen
+ *
+ *      Every order goes through a timing wheel (see wheel.h), along with
+ *  the orders scheduled for later, the lifts of restrictions read one line
+ *  at a time or any the dispatcher makes itself. An order given is put in
+ *  the wheel and the wheel is run up to its time, so the orders scheduled
+ *  up to then come before it, and orders of the same time keep the order
+ *  they were given in
+ *
+ *      With the "grouped" admission, the cars retried after a lift are
+ *  routed with one search for all those from the same entrance to the same
+ *  access type (see rankSpots), instead of one search per car
+ *
+ *      With the "lanes" admission, cars wait in a queue per entrance and
+ *  access type, so a car that can't be routed only holds back the ones
+ *  behind it in its own lane. Retries go by lanes, taking first the one
+ *  whose first car has waited the longest, and a lane whose first car
+ *  fails isn't tried again in that admission
+ *
+ *      With the "ranked" admission, the rankings of the grouped one are kept
+ *  from one admission to the next and told about every spot freed, so the
+ *  car retried after a departure gets the freed spot or a better one of its
+ *  ranking without a new search. They are dropped when a restriction
+ *  changes
+ *
+ *      Both take their rankings from the ranking source, if there is one,
+ *  before making them (see DsetRankingSource). With an engine that finds the
+ *  reference's very paths (see Eexact) they route every car as the fifo
+ *  admission does instead, as a path from a ranking could break a tie
+ *  another way, and so write the same output
+ *
+ *  Non standard interface dependencies:
+ *      parkmap.h - main program module
+ *      queue.h - first in first out queue ADT implementation
+ *      wheel.h - timing wheel of the orders to apply
+ *      histogram.h - path query latencies
+ *      timing.h - clock
+ *      engine.h - whether the park's engine is the reference's
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+
+#include"dispatch.h"
+#include"parkmap.h"
+#include"orders.h"
+#include"queue.h"
+#include"wheel.h"
+#include"timing.h"
+#include"engine.h"
+
+
+/* admissions closing a batch of changes */
+#define NOADMIT   0
+#define ADMITONE  1        /* after a spot is freed, retry the first car */
+#define ADMITALL  2        /* after a lift, retry cars until one fails */
+#define ARRIVAL   -1       /* not a change, see admissionAfter */
+
+/* admission policies, by name, the first is the default */
+#define FIFO    0
+#define GROUPED 1
+#define LANES   2
+#define RANKED  3
+static char *admissions[] = {"fifo", "grouped", "lanes", "ranked", NULL};
+static int defaultAdmission = FIFO;
+
+/* path queries are timed apart for arrivals and for the retries made after
+ * each kind of freeing order, in this order */
+static char actions[] = "ESsrpb";
+#define NACTIONS 6
+
+
+/*
+ *  Data Type: Batch
+ *
+ *  Description:
+ *      state changes of one instant applied since the last arrival, whose
+ *  admission is run once, when it is closed
+ */
+
+typedef struct _batch{
+    int time;                /* instant of its changes */
+    int nChanges;            /* 0 if there is no open batch */
+    int admit;               /* admission after its last change */
+    char last;               /* last change, the retries are timed under it */
+} Batch;
+
+
+struct _dispatcher{
+    Map *parkMap;
+    FILE *fp;
+    Queue *Q;                /* cars waiting to enter */
+    freeItemFnt release;     /* to release orders we're done with */
+
+    Batch batch;             /* changes of the current instant */
+
+    Wheel *W;                /* orders to apply, see DapplyOrder */
+
+    PathStats last;          /* work of the last path query */
+    PathStats total;         /* and of all of them */
+    int nQueries;
+
+    Histogram latency[NACTIONS];    /* path query times per action */
+
+    int admission;           /* admission policy */
+    int exact;               /* 1 if the park's engine finds the reference's
+                                very paths (see routeGrouped) */
+
+    struct _lane *lanes;     /* waiting cars of the lanes admission */
+    int nLanes, maxLanes;
+
+    struct _group *groups;   /* rankings kept by the ranked admission */
+    int nGroups, maxGroups;
+
+    int epoch;               /* restriction orders applied */
+    rankingFnt source;       /* rankings made ahead, NULL if none */
+    void *sourceState;
+};
+
+
+/*
+ *  Data Type: Group
+ *
+ *  Description:
+ *      waiting cars from one entrance to one access type, routed together
+ *  by the grouped admission
+ */
+
+typedef struct _group{
+    int x, y, z;
+    char type;
+    SpotRanking *R;
+} Group;
+
+
+/*
+ *  Data Type: Lane
+ *
+ *  Description:
+ *      cars waiting to enter from one entrance to one access type, for the
+ *  lanes admission. Once its first car fails, the lane keeps a ranking of
+ *  the spots it can reach and is only tried again when one of them is
+ *  freed or a restriction changes
+ */
+
+typedef struct _lane{
+    int x, y, z;
+    char type;
+    Queue *Q;
+    int blocked;             /* first car failed in this admission */
+    int stuck;               /* and no spot it can use was freed since */
+    SpotRanking *R;          /* spots it can reach, NULL until it's stuck */
+} Lane;
+
+
+Dispatcher *Dinit(Map *parkMap, FILE *fp, freeItemFnt release){
+    Dispatcher *D;
+    int i;
+
+    D = (Dispatcher *) malloc(sizeof(Dispatcher));
+    if(D == NULL){
+        fprintf(stderr, "Memory error\n");
+        return NULL;
+    }
+
+    D->parkMap = parkMap;
+    D->fp = fp;
+    D->Q = Qinit();
+    D->release = release;
+    D->batch.time = -1;
+    D->batch.nChanges = 0;
+    D->batch.admit = NOADMIT;
+    D->batch.last = ' ';
+
+    PSclear(&D->total);
+    D->nQueries = 0;
+
+    for(i = 0; i < NACTIONS; i++)
+        HGclear(&D->latency[i]);
+    D->admission = defaultAdmission;
+    D->exact = Eexact(PgetEngineName(parkMap));
+    D->lanes = NULL;
+    D->nLanes = 0;
+    D->maxLanes = 0;
+    D->maxGroups = 8;
+    D->nGroups = 0;
+    D->groups = (Group *) malloc(sizeof(Group) * D->maxGroups);
+    D->epoch = 0;
+    D->source = NULL;
+    D->sourceState = NULL;
+
+    D->W = WHinit(0);
+
+    return D;
+}
+
+
+/*
+ * Auxiliary-function: releaseOrder
+ *
+ * Description:
+ *      hands back an order the dispatcher no longer needs
+ */
+
+static void releaseOrder(Dispatcher *D, Order *o){
+    if(D->release != NULL)
+        D->release((Item) o);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: route
+ *
+ * Description:
+ *      looks for the path of a car, adding the work done to the totals and
+ *  its time to the histogram of the order which caused it ('E' for the
+ *  arrival of the car)
+ */
+
+static int *route(Dispatcher *D, Order *o, int *cost, int *stSize,
+                                                            char action){
+    int *st;
+    char *a;
+    double t0;
+
+    t0 = Tnow();
+    st = findPath(D->parkMap, o->id, o->x, o->y, o->z, o->type, cost, stSize,
+                                                                    &D->last);
+    a = strchr(actions, (int) action);
+    if(a != NULL && action != '\0')
+        HGrecord(&D->latency[a - actions],
+                                (unsigned long) ((Tnow() - t0) * 1e9));
+
+    PSadd(&D->total, &D->last);
+    D->nQueries++;
+    return st;
+}
+
+
+/*
+ * Auxiliary-function: routeGrouped
+ *
+ * Description:
+ *      route for a car of the grouped admission: ranks the spots for its
+ *  group the first time one of its cars is routed, and takes the next one
+ */
+
+static int *routeGrouped(Dispatcher *D, Order *o, Group **groups,
+                        int *nGroups, int *maxGroups, int *cost, int *stSize){
+    Group *g;
+    int *st, i;
+    char *a;
+    double t0;
+
+    /* the reference breaks ties by the heap its last search left (see
+     * engine.c), so only its own searches, made as for fifo, give its very
+     * paths. Rankings are left to the engines breaking ties their own way */
+    if(D->exact)
+        return route(D, o, cost, stSize, D->batch.last);
+
+    t0 = Tnow();
+    for(i = 0; i < *nGroups; i++)
+        if((*groups)[i].x == o->x && (*groups)[i].y == o->y &&
+                    (*groups)[i].z == o->z && (*groups)[i].type == o->type)
+            break;
+    if(i == *nGroups){
+        if(*nGroups == *maxGroups){
+            *maxGroups *= 2;
+            *groups = (Group *) realloc(*groups, sizeof(Group) * *maxGroups);
+        }
+        g = &(*groups)[(*nGroups)++];
+        g->x = o->x;
+        g->y = o->y;
+        g->z = o->z;
+        g->type = o->type;
+        g->R = NULL;
+        if(D->source != NULL)
+            g->R = D->source(D->sourceState, D->epoch, o->x, o->y, o->z,
+                                                                    o->type);
+        if(g->R == NULL){
+            g->R = rankSpots(D->parkMap, o->x, o->y, o->z, o->type, &D->last);
+            PSadd(&D->total, &D->last);
+            D->nQueries++;
+        }
+    } else
+        g = &(*groups)[i];
+    st = nextRankedPath(D->parkMap, g->R, o->id, cost, stSize);
+
+    a = strchr(actions, (int) D->batch.last);
+    if(a != NULL && D->batch.last != '\0')
+        HGrecord(&D->latency[a - actions],
+                                (unsigned long) ((Tnow() - t0) * 1e9));
+    return st;
+}
+
+
+/*
+ * Auxiliary-function: admitRanked
+ *
+ * Description:
+ *      admitWaiting routing the cars with the rankings of groups. Cars are
+ *  taken in the same order and stop at the same one
+ */
+
+static void admitRanked(Dispatcher *D, int time, int all, Group **groups,
+                                                int *nGroups, int *maxGroups){
+    Map *parkMap = D->parkMap;
+    Order *o;
+    int cost, *st, stSize;
+
+    while( (isQueueEmpty(D->Q) == 0) && (isParkFull(parkMap) == 0) ){
+        o = (Order *) Qpop(D->Q);
+        st = routeGrouped(D, o, groups, nGroups, maxGroups, &cost, &stSize);
+        if(st == NULL){
+            QpushFirst(D->Q, (Item) o);
+            break;
+        }
+        cost += time - o->time;     /* add additional cost for waiting */
+        writeOutputAfterIn(D->fp, parkMap, st, cost, time, o->id,
+                                                o->type, o->time, stSize);
+        /* the next car is admitted at the arrival of this one */
+        time = o->time;
+        releaseOrder(D, o);
+        if(all == 0)
+            break;
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: admitGrouped
+ *
+ * Description:
+ *      admitWaiting of every waiting car with the grouped admission, with
+ *  rankings made for this admission only
+ */
+
+static void admitGrouped(Dispatcher *D, int time){
+    Group *groups;
+    int nGroups = 0, maxGroups = 8, i;
+
+    groups = (Group *) malloc(sizeof(Group) * maxGroups);
+    admitRanked(D, time, 1, &groups, &nGroups, &maxGroups);
+    for(i = 0; i < nGroups; i++)
+        freeSpotRanking(groups[i].R);
+    free(groups);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: keptRankings
+ *
+ * Description:
+ *      keeps the rankings of the ranked admission good after an order: the
+ *  spot freed is told to them, a restriction changed drops them
+ */
+
+static void keptRankings(Dispatcher *D, char action){
+    int i;
+
+    if(D->admission != RANKED)
+        return;
+    for(i = 0; i < D->nGroups; i++)
+        if(action == 'S' || action == 's')
+            rankFreedSpot(D->parkMap, D->groups[i].R);
+        else
+            freeSpotRanking(D->groups[i].R);
+    if(action != 'S' && action != 's')
+        D->nGroups = 0;
+    return;
+}
+
+
+/*
+ * Auxiliary-function: laneOf
+ *
+ * Description:
+ *      lane of the entrance and access type of a car, made if there's none
+ */
+
+static Lane *laneOf(Dispatcher *D, Order *o){
+    Lane *l;
+    int i;
+
+    for(i = 0; i < D->nLanes; i++){
+        l = &D->lanes[i];
+        if(l->x == o->x && l->y == o->y && l->z == o->z && l->type == o->type)
+            return l;
+    }
+    if(D->nLanes == D->maxLanes){
+        D->maxLanes = D->maxLanes == 0 ? 8 : 2 * D->maxLanes;
+        D->lanes = (Lane *) realloc(D->lanes, sizeof(Lane) * D->maxLanes);
+    }
+    l = &D->lanes[D->nLanes++];
+    l->x = o->x;
+    l->y = o->y;
+    l->z = o->z;
+    l->type = o->type;
+    l->Q = Qinit();
+    l->blocked = 0;
+    l->stuck = 0;
+    l->R = NULL;
+    return l;
+}
+
+
+/*
+ * Auxiliary-function: firstWaiting
+ *
+ * Description:
+ *      lane not blocked nor stuck whose first car arrived the earliest, the
+ *  first lane made among those of the same time. NULL if there's none
+ */
+
+static Lane *firstWaiting(Dispatcher *D){
+    Lane *best = NULL;
+    Order *o;
+    int i, bestTime = 0;
+
+    for(i = 0; i < D->nLanes; i++){
+        if(D->lanes[i].blocked || D->lanes[i].stuck ||
+                                            isQueueEmpty(D->lanes[i].Q))
+            continue;
+        o = (Order *) Qpeek(D->lanes[i].Q);
+        if(best == NULL || o->time < bestTime){
+            best = &D->lanes[i];
+            bestTime = o->time;
+        }
+    }
+    return best;
+}
+
+
+/*
+ * Auxiliary-function: admitLanes
+ *
+ * Description:
+ *      admitWaiting with the lanes admission: the first car of each lane is
+ *  tried, the longest waiting first, until one gets in (all is 0) or every
+ *  lane is empty, blocked or stuck. A lane whose first car fails is stuck
+ *  until a spot it can reach is freed (see keptLanes)
+ */
+
+static void admitLanes(Dispatcher *D, int time, int all){
+    Map *parkMap = D->parkMap;
+    Lane *l;
+    Order *o;
+    int cost, *st, stSize, i;
+
+    for(i = 0; i < D->nLanes; i++)
+        D->lanes[i].blocked = 0;
+    while( isParkFull(parkMap) == 0 && (l = firstWaiting(D)) != NULL ){
+        o = (Order *) Qpop(l->Q);
+        st = route(D, o, &cost, &stSize, D->batch.last);
+        if(st == NULL){
+            QpushFirst(l->Q, (Item) o);
+            l->blocked = 1;
+            l->stuck = 1;
+            if(l->R == NULL)
+                l->R = rankSpots(parkMap, l->x, l->y, l->z, l->type, NULL);
+            continue;
+        }
+        cost += time - o->time;     /* add additional cost for waiting */
+        writeOutputAfterIn(D->fp, parkMap, st, cost, time, o->id,
+                                                o->type, o->time, stSize);
+        /* the next car is admitted at the arrival of this one */
+        time = o->time;
+        releaseOrder(D, o);
+        if(all == 0)
+            break;
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: admitWaiting
+ *
+ * Description:
+ *      tries to route the cars waiting in queue at the given time, adding
+ *  the waiting time to their cost. Stops at the first car that can't be
+ *  routed, which goes back to the head of the queue
+ *
+ * Arguments:
+ *      Dispatcher *D
+ *      int time - instant of the admission
+ *      int all - 0 to try a single car, 1 to keep trying
+ */
+
+static void admitWaiting(Dispatcher *D, int time, int all){
+    Map *parkMap = D->parkMap;
+    Order *o;
+    int cost, *st, stSize;
+
+    if(D->admission == LANES){
+        admitLanes(D, time, all);
+        return;
+    }
+    if(D->admission == RANKED){
+        admitRanked(D, time, all, &D->groups, &D->nGroups, &D->maxGroups);
+        return;
+    }
+    if(all && D->admission == GROUPED){
+        admitGrouped(D, time);
+        return;
+    }
+    while( (isQueueEmpty(D->Q) == 0) && (isParkFull(parkMap) == 0) ){
+        o = (Order *) Qpop(D->Q);
+        st = route(D, o, &cost, &stSize, D->batch.last);
+        if(st == NULL){
+            QpushFirst(D->Q, (Item) o);
+            break;
+        }
+        cost += time - o->time;     /* add additional cost for waiting */
+        writeOutputAfterIn(D->fp, parkMap, st, cost, time, o->id,
+                                                o->type, o->time, stSize);
+        /* the next car is admitted at the arrival of this one */
+        time = o->time;
+        releaseOrder(D, o);
+        if(all == 0)
+            break;
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: admissionAfter
+ *
+ * Description:
+ *      admission a batch closed right after a change would run: one car is
+ *  retried after a spot is freed and all that can go in after a lift. The
+ *  batch takes the one of its last change, so a freeing followed by a
+ *  restriction at the same instant retries no car
+ *
+ * Return value:
+ *      int - NOADMIT, ADMITONE or ADMITALL, ARRIVAL if the order isn't a
+ *  change
+ */
+
+static int admissionAfter(char action){
+    switch(action){
+        case 'S':
+        case 's':
+            return ADMITONE;
+        case 'r':
+        case 'p':
+        case 'b':
+            return ADMITALL;
+        case 'R':
+        case 'P':
+        case 'B':
+            return NOADMIT;
+    }
+    return ARRIVAL;
+}
+
+
+/*
+ * Auxiliary-function: closeBatch
+ *
+ * Description:
+ *      runs the admission of the open batch, if any, and closes it
+ */
+
+static void closeBatch(Dispatcher *D){
+    int admit = D->batch.admit;
+
+    if(D->batch.nChanges == 0)
+        return;
+    D->batch.nChanges = 0;
+    D->batch.admit = NOADMIT;
+    if(admit == ADMITONE)
+        admitWaiting(D, D->batch.time, 0);
+    else if(admit == ADMITALL)
+        admitWaiting(D, D->batch.time, 1);
+    return;
+}
+
+
+void Dflush(Dispatcher *D){
+    closeBatch(D);
+    return;
+}
+
+
+int DhasPending(Dispatcher *D){
+    return D->batch.nChanges > 0 && D->batch.admit != NOADMIT ? 1 : 0;
+}
+
+
+/*
+ * Auxiliary-function: applyArrival
+ *
+ * Description:
+ *      routes an arriving car, or puts it to wait if there are cars waiting
+ *  before it in its queue or it can't be routed
+ */
+
+static void applyArrival(Dispatcher *D, Order *o){
+    Map *parkMap = D->parkMap;
+    FILE *fp = D->fp;
+    Queue *Q;
+    int cost, *st, stSize;
+
+    if(D->admission == LANES)
+        Q = laneOf(D, o)->Q;
+    else
+        Q = D->Q;
+    if( (isQueueEmpty(Q) == 1) && (isParkFull(parkMap) == 0) ){
+        st = route(D, o, &cost, &stSize, 'E');
+        if(st == NULL){
+            writeMove(fp, parkMap, o->id, o->time, o->x, o->y, o->z, 'i');
+            Qpush(Q, (Item) o);
+        }
+        else{
+            writeOutput(fp, parkMap, st, cost, o->time, o->id, o->type,
+                                                                    stSize);
+            releaseOrder(D, o);
+        }
+    }
+    else{
+        writeMove(fp, parkMap, o->id, o->time, o->x, o->y, o->z, 'i');
+        Qpush(Q, (Item) o);
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: keptLanes
+ *
+ * Description:
+ *      a stuck lane of the lanes admission may be tried again after an
+ *  order if it freed a spot the lane can reach; a restriction changed makes
+ *  every lane tried again, dropping their rankings
+ */
+
+static void keptLanes(Dispatcher *D, char action){
+    Lane *l;
+    int i;
+
+    if(D->admission != LANES)
+        return;
+    for(i = 0; i < D->nLanes; i++){
+        l = &D->lanes[i];
+        if(l->R == NULL)
+            continue;
+        if(action == 'S' || action == 's'){
+            if(isFreedSpotRanked(D->parkMap, l->R))
+                l->stuck = 0;
+        } else{
+            freeSpotRanking(l->R);
+            l->R = NULL;
+            l->stuck = 0;
+        }
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: applyChange
+ *
+ * Description:
+ *      applies a freeing or restriction order to the park, with no admission
+ */
+
+static void applyChange(Dispatcher *D, Order *o){
+    Map *parkMap = D->parkMap;
+
+    switch (o->action){
+        case 'S':
+            /* freeSpot */
+            clearSpotCoordinates(parkMap, o->x, o->y, o->z);
+            writeMove(D->fp, parkMap, o->id, o->time, o->x, o->y, o->z, 's');
+            break;
+        case 's':
+            /* free spot of car with ID */
+            clearSpotIDandWrite(D->fp, parkMap, o->id, o->time);
+            break;
+        case 'R':
+            restrictMapCoordinate(parkMap, o->x, o->y, o->z);
+            break;
+        case 'r':
+            freeRestrictionMapCoordinate(parkMap, o->x, o->y, o->z);
+            break;
+        case 'P':
+            restrictMapFloor(parkMap, o->z);
+            break;
+        case 'p':
+            freeRestrictionMapFloor(parkMap, o->z);
+            break;
+        case 'B':
+            restrictMapRegion(parkMap, o->x, o->y, o->z, o->x2, o->y2, o->z2);
+            break;
+        case 'b':
+            freeRestrictionMapRegion(parkMap, o->x, o->y, o->z,
+                                                    o->x2, o->y2, o->z2);
+            break;
+    }
+    keptRankings(D, o->action);
+    keptLanes(D, o->action);
+    if(admissionAfter(o->action) != ADMITONE){
+        D->epoch++;
+        /* so the source may get ready for it */
+        if(D->source != NULL)
+            D->source(D->sourceState, D->epoch, -1, -1, -1, '\0');
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: applyOrder
+ *
+ * Description:
+ *      applies a single order, see DapplyOrder. A change joins the batch of
+ *  its instant, anything else must see the open batch closed first
+ */
+
+static void applyOrder(Dispatcher *D, Order *o){
+    int admit = admissionAfter(o->action);
+
+    if(admit == ARRIVAL || D->batch.time != o->time)
+        closeBatch(D);
+
+    if(admit == ARRIVAL){
+        if(o->action == 'E')
+            applyArrival(D, o);
+        else{
+            fprintf(stderr, "Unknown order action %c\n", o->action);
+            releaseOrder(D, o);
+        }
+        return;
+    }
+
+    applyChange(D, o);
+    D->batch.time = o->time;
+    D->batch.nChanges++;
+    D->batch.admit = admit;
+    D->batch.last = o->action;
+    releaseOrder(D, o);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: applyUntil
+ *
+ * Description:
+ *      applies, in time order, every order of the wheel up to the given
+ *  time, those put in while doing it included
+ */
+
+static void applyUntil(Dispatcher *D, int time){
+    Order *o;
+
+    while( (o = (Order *) WHnext(D->W, time, NULL)) != NULL)
+        applyOrder(D, o);
+    return;
+}
+
+
+void DapplyOrder(Dispatcher *D, Order *o){
+    WHinsert(D->W, o->time, (Item) o);
+    applyUntil(D, o->time);
+    return;
+}
+
+
+LinkedList *DapplyTick(Dispatcher *D, LinkedList *orders, int *nApplied){
+    Order *o;
+    int time, n = 0;
+
+    if(orders != NULL){
+        time = ((Order *) getItemLinkedList(orders))->time;
+        for(; orders != NULL; orders = getNextNodeLinkedList(orders), n++){
+            o = (Order *) getItemLinkedList(orders);
+            if(o->time != time)
+                break;
+            DapplyOrder(D, o);
+        }
+        /* no more changes of this instant can come */
+        closeBatch(D);
+    }
+    if(nApplied != NULL)
+        *nApplied = n;
+    return orders;
+}
+
+
+void DscheduleOrder(Dispatcher *D, Order *o){
+    WHinsert(D->W, o->time, (Item) o);
+    return;
+}
+
+
+void Dfinish(Dispatcher *D){
+    applyUntil(D, INT_MAX);
+    Dflush(D);
+    return;
+}
+
+
+int DpathStats(Dispatcher *D, PathStats *total){
+    *total = D->total;
+    return D->nQueries;
+}
+
+
+void DprintLatency(Dispatcher *D, FILE *fp, char *title){
+    char label[256];
+    int i;
+
+    for(i = 0; i < NACTIONS; i++){
+        if(D->latency[i].count == 0)
+            continue;
+        if(actions[i] == 'E')
+            sprintf(label, "%.200s findPath E", title);
+        else
+            sprintf(label, "%.200s findPath retry after %c", title,
+                                                                actions[i]);
+        HGprint(fp, &D->latency[i], label);
+    }
+    return;
+}
+
+
+int DsetAdmission(char *name){
+    int i;
+
+    for(i = 0; admissions[i] != NULL; i++)
+        if(strcmp(admissions[i], name) == 0){
+            defaultAdmission = i;
+            return 1;
+        }
+    return 0;
+}
+
+
+char *Dadmission(int i){
+    int n;
+
+    for(n = 0; admissions[n] != NULL; n++);
+    return i >= 0 && i < n ? admissions[i] : NULL;
+}
+
+
+void DsetRankingSource(Dispatcher *D, rankingFnt source, void *state){
+    D->source = source;
+    D->sourceState = state;
+    return;
+}
+
+
+void DsetOutput(Dispatcher *D, FILE *fp){
+    D->fp = fp;
+    return;
+}
+
+
+void Ddestroy(Dispatcher *D){
+    Order *o;
+    int i;
+
+    while(isQueueEmpty(D->Q) == 0){
+        o = (Order *) Qpop(D->Q);
+        releaseOrder(D, o);
+    }
+    for(i = 0; i < D->nLanes; i++){
+        while(isQueueEmpty(D->lanes[i].Q) == 0){
+            o = (Order *) Qpop(D->lanes[i].Q);
+            releaseOrder(D, o);
+        }
+        Qdestroy(D->lanes[i].Q);
+        if(D->lanes[i].R != NULL)
+            freeSpotRanking(D->lanes[i].R);
+    }
+    free(D->lanes);
+    for(i = 0; i < D->nGroups; i++)
+        freeSpotRanking(D->groups[i].R);
+    free(D->groups);
+    while( (o = (Order *) WHnext(D->W, INT_MAX, NULL)) != NULL)
+        releaseOrder(D, o);
+    WHdestroy(D->W);
+    Qdestroy(D->Q);
+    free(D);
+    return;
+}
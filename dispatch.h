@@ -0,0 +1,299 @@
+/*
+ *  File name: dispatch.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: Header file for the Dispatcher, which applies Orders one by
+ *          one to a park Map, keeps the waiting queue of cars which couldn't
+ *          enter and writes every resulting move to the output file
+ *
+ *  Abstract Data Type: Dispatcher
+ *              Holds the park Map, the car waiting queue and the output
+ *          stream of one running park
+ *
+ *  Function list:
+ *    A) Initialization & Termination
+ *        Dinit
+ *        Ddestroy
+ *
+ *    B) Apply
+ *        DapplyOrder
+ *        DapplyTick
+ *        DscheduleOrder
+ *        Dflush
+ *        Dfinish
+ *        DsetOutput
+ *        DsetAdmission
+ *        DsetRankingSource
+ *
+ *    C) Lookup
+ *        DhasPending
+ *        DpathStats
+ *        DprintLatency
+ *        Dadmission
+ *
+ *  Non-standard dependencies:
+ *    parkmap.h
+ *    orders.h
+ *    LinkedList.h
+ *    pathstats.h
+ *    histogram.h
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __dispatch__h
+#define __dispatch__h 1
+
+#include<stdio.h>
+#include"parkmap.h"
+#include"orders.h"
+#include"LinkedList.h"
+#include"pathstats.h"
+#include"histogram.h"
+
+typedef struct _dispatcher Dispatcher;
+
+/* source of rankings made ahead, see DsetRankingSource */
+typedef SpotRanking *(*rankingFnt)(void *state, int epoch, int x, int y,
+                                                        int z, char type);
+
+
+/*
+ *  Function:
+ *    Dinit
+ *
+ *  Description:
+ *    creates a dispatcher over an already built park Map
+ *
+ *  Arguments:
+ *    Map *parkMap - park map with its graph built
+ *    FILE *fp - output stream
+ *    freeItemFnt release - function called on every Order once the
+ *        dispatcher is done with it (NULL if the caller keeps ownership,
+ *        e.g. when orders are in a list freed afterwards)
+ *
+ *  Return value:
+ *    Dispatcher * - new dispatcher
+ */
+
+Dispatcher *Dinit(Map *parkMap, FILE *fp, freeItemFnt release);
+
+
+/*
+ *  Function:
+ *    DapplyOrder
+ *
+ *  Description:
+ *    applies a single Order. Orders must be given in increasing time order.
+ *
+ *    Freeing and restriction orders of the same instant, up to the next
+ *  arrival, make one batch: the waiting cars are only admitted once, after
+ *  the last of them, so the admission is held until the next order (or
+ *  Dflush) shows there are no more of them
+ *
+ *  Arguments:
+ *    Dispatcher *D - dispatcher
+ *    Order *o - order to apply
+ *
+ *  Return value:
+ *    void
+ */
+
+void DapplyOrder(Dispatcher *D, Order *o);
+
+
+/*
+ *  Function:
+ *    DapplyTick
+ *
+ *  Description:
+ *    applies, as DapplyOrder, every order of a list with the time of the
+ *  first one, and runs the admission held by the last of them, since no more
+ *  orders of that instant can come
+ *
+ *  Arguments:
+ *    Dispatcher *D - dispatcher
+ *    LinkedList *orders - time ordered list of Orders
+ *    int *nApplied - reference to save the number of orders applied (may be
+ *        NULL)
+ *
+ *  Return value:
+ *    LinkedList * - first node of the next instant, NULL at the end
+ */
+
+LinkedList *DapplyTick(Dispatcher *D, LinkedList *orders, int *nApplied);
+
+
+/*
+ *  Function:
+ *    DscheduleOrder
+ *
+ *  Description:
+ *    keeps an order to be applied at its own time, right before the first
+ *  order given to DapplyOrder with the same or a later time (or at Dfinish).
+ *  Used for the lifting orders of restrictions read one line at a time.
+ *  Orders are kept in a timing wheel, so scheduling one takes the same time
+ *  however many are kept and however far ahead it is
+ *
+ *  Arguments:
+ *    Dispatcher *D - dispatcher
+ *    Order *o - future order
+ *
+ *  Return value:
+ *    void
+ */
+
+void DscheduleOrder(Dispatcher *D, Order *o);
+
+
+/*
+ *  Function:
+ *    Dflush
+ *
+ *  Description:
+ *    runs the admission held by the last order, if any. Must be called after
+ *  the last order, or whenever no more orders of the same instant can come
+ */
+
+void Dflush(Dispatcher *D);
+
+
+/*
+ *  Function:
+ *    DhasPending
+ *
+ *  Description:
+ *    returns 1 if there is an admission waiting for Dflush, 0 otherwise
+ */
+
+int DhasPending(Dispatcher *D);
+
+
+/*
+ *  Function:
+ *    DpathStats
+ *
+ *  Description:
+ *    gives the sum of the work counters of every path query made so far
+ *  (zero unless built with PATHSTATS)
+ *
+ *  Arguments:
+ *    Dispatcher *D - dispatcher
+ *    PathStats *total - reference to save the sum
+ *
+ *  Return value:
+ *    int - number of path queries made
+ */
+
+int DpathStats(Dispatcher *D, PathStats *total);
+
+
+/*
+ *  Function:
+ *    DprintLatency
+ *
+ *  Description:
+ *    writes the percentiles of the time taken by the path queries made so
+ *  far, one line for the arrivals ('E') and one for the retries of waiting
+ *  cars after each kind of order (S, s, r, p, b), each line starting with the
+ *  given title. Every query is timed, there is no build option for it
+ */
+
+void DprintLatency(Dispatcher *D, FILE *fp, char *title);
+
+
+/*
+ *  Function:
+ *    Dfinish
+ *
+ *  Description:
+ *    applies every scheduled order and runs the held admission, to be called
+ *  when no more orders will come
+ */
+
+void Dfinish(Dispatcher *D);
+
+
+/*
+ *  Function:
+ *    DsetOutput
+ *
+ *  Description:
+ *    changes the stream where the results of the next orders are written
+ */
+
+void DsetOutput(Dispatcher *D, FILE *fp);
+
+
+/*
+ *  Functions:
+ *    DsetAdmission
+ *    Dadmission
+ *
+ *  Description:
+ *    admission policy of the dispatchers made from then on, by name, and
+ *    the names there are, by index from 0 (the default):
+ *        fifo - waiting cars are routed one by one
+ *        grouped - after a lift, the waiting cars from the same entrance to
+ *            the same access type are routed with one search (see rankSpots)
+ *    Both admit the cars in the same order, each at a path of the best cost
+ *    there is when it goes in, but grouped may break ties between spots
+ *    another way, and the cars after that may then get other costs
+ *        lanes - cars wait in a queue per entrance and access type, and one
+ *            that can't be routed only holds back those of its lane. Cars
+ *            may then go in before others that arrived earlier
+ *        ranked - as grouped, but the rankings are kept between admissions
+ *            and told about the spots freed (see rankFreedSpot), so a car
+ *            retried after a departure is routed without a search
+ *
+ *  Return value:
+ *    int - 1 if the policy exists, 0 otherwise (DsetAdmission)
+ *    char * - name of the i-th policy, NULL after the last (Dadmission)
+ */
+
+int DsetAdmission(char *name);
+char *Dadmission(int i);
+
+
+/*
+ *  Function:
+ *    DsetRankingSource
+ *
+ *  Description:
+ *    gives the dispatcher rankings of spots made ahead, for the grouped and
+ *  ranked admissions, which then only make the ones the source hasn't got.
+ *  The source is asked for the ranking of an entrance and access type in a
+ *  restriction epoch, the number of restriction orders (R, r, P, p, B, b)
+ *  applied before, and the ranking is the dispatcher's from then on. It is
+ *  also told of every new epoch, with type '\0', and then gives nothing
+ *
+ *  Arguments:
+ *    Dispatcher *D - dispatcher
+ *    rankingFnt source - function giving the ranking, or NULL if it has
+ *        none, NULL for no source
+ *    void *state - passed to source
+ *
+ *  Return value:
+ *    void
+ */
+
+void DsetRankingSource(Dispatcher *D, rankingFnt source, void *state);
+
+
+/*
+ *  Function:
+ *    Ddestroy
+ *
+ *  Description:
+ *    frees the dispatcher. Orders still waiting or scheduled are released
+ *  if a release function was given. The Map and the output stream are left
+ *  to the caller
+ */
+
+void Ddestroy(Dispatcher *D);
+
+#endif
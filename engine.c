@@ -0,0 +1,1041 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: routing engines and their registry
+ *
+ *  Implementation details:
+ *      Each engine type is a table of functions over a state of its own,
+ *  kept behind a void pointer. To add an engine, write its four functions
+ *  and add a line to engineTypes; autodiff will then compare it with the
+ *  reference on random parks.
+ *
+ *      The reference engine keeps the path table, the weight table and the
+ *  priority queue between queries, resetting only the nodes the last query
+ *  touched (PQreset). Its graph view already knows which nodes and floors
+ *  are active, so it has nothing to do when told about a change.
+ *
+ *      The incremental engine keeps instead a whole shortest path tree for
+ *  each entrance asked about (LPA*, Koenig and Likhachev, without heuristic,
+ *  in the spirit of Ramalingam and Reps). A node turned on or off only marks
+ *  its successors for a check, and a query repairs the part of the tree that
+ *  changed, stopping as soon as the access asked for is settled. Ties are
+ *  broken in its own way, so it only agrees with the reference on the costs
+ *
+ *      The bounded engine is the reference's search ordered by the cost so
+ *  far plus a bound of the cost left, the cost to the access in the park
+ *  with no cars and no restrictions, kept per access node. It stops at the
+ *  same cost but leaves unsettled the walks from spots that can't beat the
+ *  best one found. Ties are broken in its own way too
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"engine.h"
+#include"graphL.h"
+#include"prioQ.h"
+
+
+/*
+ *  Data Type: EngineType
+ *
+ *  Description:
+ *      the functions of one engine
+ */
+
+typedef struct _engineType{
+    char *name;
+    void *(*init)(Map *parkMap, GraphL *g);
+    int (*query)(void *state, int origin, int dest, int **st,
+                                                        PathStats *stats);
+    void (*notify)(void *state, int node, int active);
+    void (*notifyFloor)(void *state, int floor, int active);
+    void (*destroy)(void *state);
+    /* makes the state of an engine, as far as the next query depends on it,
+     * the same as another's; NULL if queries depend only on the graph */
+    void (*copy)(void *to, void *from);
+    int exact;          /* 1 if it finds the reference's very paths, 0 if
+                           only paths of the same cost */
+} EngineType;
+
+
+struct _engine{
+    EngineType *type;
+    void *state;
+};
+
+
+/* ---------------------------------------------------------------------- */
+/* dijkstra, the reference engine                                          */
+
+typedef struct _dijkstra{
+    Map *parkMap;
+    GraphL *g;
+    int *st;
+    int *wt;
+    PrioQ *PQ;
+} Dijkstra;
+
+
+static void *dijkstraInit(Map *parkMap, GraphL *g){
+    Dijkstra *d = (Dijkstra *) malloc(sizeof(Dijkstra));
+    int i, n = Gnodes(g);
+
+    d->parkMap = parkMap;
+    d->g = g;
+
+    /* pre-Initialize weight and path tables, posterior function requirement */
+    d->st = (int *) malloc(sizeof(int) * n);
+    d->wt = (int *) malloc(sizeof(int) * n);
+    for(i = 0; i < n; i++){
+        d->st[i] = -1;
+        d->wt[i] = NOCON;
+    }
+
+    /* initialize priority queue, posterior function requirement */
+    d->PQ = PQinit(d->wt, n);
+    return d;
+}
+
+
+static int dijkstraQuery(void *state, int origin, int dest, int **st,
+                                                        PathStats *stats){
+    Dijkstra *d = (Dijkstra *) state;
+    int cost;
+
+    /* set PQ wt and st to original state without O(N) */
+    PQreset(d->PQ, d->st, d->wt, Gnodes(d->g));
+
+    if(stats != NULL)
+        PSclear(stats);
+    PQsetStats(d->PQ, stats);
+
+    /* set origin definitions and update PQ */
+    d->wt[origin] = 0;
+    PQupdateNode(d->PQ, origin);
+
+    cost = GDijkstra(d->g, origin, dest, d->st, d->wt, d->PQ, d->parkMap,
+                                                                    stats);
+    PQsetStats(d->PQ, NULL);
+
+    *st = d->st;
+    return cost;
+}
+
+
+static void dijkstraNotify(void *state, int node, int active){
+    return;
+}
+
+
+static void dijkstraNotifyFloor(void *state, int floor, int active){
+    return;
+}
+
+
+static void dijkstraDestroy(void *state){
+    Dijkstra *d = (Dijkstra *) state;
+
+    free(d->st);
+    free(d->wt);
+    PQdestroy(d->PQ);
+    free(d);
+    return;
+}
+
+
+/* GDijkstra breaks ties by the order the queue was left in, and PQreset
+ * only cleans the nodes the last search reached */
+static void dijkstraCopy(void *to, void *from){
+    Dijkstra *a = (Dijkstra *) to, *b = (Dijkstra *) from;
+    int n = Gnodes(b->g);
+
+    memcpy(a->st, b->st, sizeof(int) * n);
+    memcpy(a->wt, b->wt, sizeof(int) * n);
+    PQcopy(a->PQ, b->PQ);
+    return;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* incremental, a shortest path tree per entrance repaired after changes   */
+
+/*
+ *  Data Type: Tree
+ *
+ *  Description:
+ *      lifelong planning state of the searches from one entrance (LPA*
+ *  without heuristic). g is the distance the tree settled on, rhs the one
+ *  the predecessors give now; a node where they differ is inconsistent and
+ *  waits in the queue with key min(g, rhs). Consistent nodes have key NOCON.
+ *
+ *      Ramps are entered in two ways: from a ramp, and then any edge may be
+ *  taken, or from elsewhere, and then only the one to the other floor, as in
+ *  GDijkstra. mode is 1 for the first, rmode what the predecessors give now
+ */
+
+typedef struct _tree{
+    int origin;
+    int *g;
+    int *rhs;
+    int *key;
+    char *mode;
+    char *rmode;
+    char *inQ;          /* 1 if in the heap part of PQ */
+    PrioQ *PQ;
+    struct _tree *next;
+} Tree;
+
+
+typedef struct _incremental{
+    Map *parkMap;
+    GraphL *g;
+    int n;
+    int NM;             /* difference between a ramp and the one it leads to */
+    int *outStart;      /* edges of node v are [outStart[v], outStart[v+1]),
+                           the park's own tables (see PgetEdgeTable) */
+    int *outNode;
+    int *outCost;
+    int *inStart;       /* edges into node v, the same way */
+    int *inNode;
+    int *inCost;
+    int *floorStart;    /* nodes linked to floor f are floorNode[floorStart[f]]
+                           to floorNode[floorStart[f+1] - 1] */
+    int *floorNode;
+    char *ramp;
+    int *st;
+    Tree *trees;
+} Incremental;
+
+
+/*
+ * Auxiliary-function: makeFloorTables
+ *
+ * Description:
+ *      lists the nodes linked to each floor (entrances and ramps), the ones
+ *  that change when the floor is closed or opened
+ */
+
+static void makeFloorTables(Incremental *inc, int P){
+    int v, f, *fill;
+
+    inc->floorStart = (int *) calloc(P + 1, sizeof(int));
+    for(v = 0; v < inc->n; v++)
+        if(GisNodeLinkedToFloor(inc->g, v))
+            inc->floorStart[GnodeFloor(inc->g, v) + 1]++;
+    for(f = 0; f < P; f++)
+        inc->floorStart[f + 1] += inc->floorStart[f];
+
+    inc->floorNode = (int *) malloc(sizeof(int) * (inc->floorStart[P] + 1));
+    fill = (int *) malloc(sizeof(int) * P);
+    for(f = 0; f < P; f++)
+        fill[f] = inc->floorStart[f];
+    for(v = 0; v < inc->n; v++)
+        if(GisNodeLinkedToFloor(inc->g, v))
+            inc->floorNode[fill[GnodeFloor(inc->g, v)]++] = v;
+    free(fill);
+}
+
+
+static void *incrementalInit(Map *parkMap, GraphL *g){
+    Incremental *inc = (Incremental *) malloc(sizeof(Incremental));
+    int v;
+    char desc;
+
+    inc->parkMap = parkMap;
+    inc->g = g;
+    inc->n = Gnodes(g);
+    inc->NM = PgetN(parkMap) * PgetM(parkMap);
+    /* the tree repairs look at the predecessors of a node all the time */
+    PgetEdgeTable(parkMap, 0, &inc->outStart, &inc->outNode, &inc->outCost);
+    PgetEdgeTable(parkMap, 1, &inc->inStart, &inc->inNode, &inc->inCost);
+    makeFloorTables(inc, PgetP(parkMap));
+
+    inc->ramp = (char *) malloc(sizeof(char) * inc->n);
+    inc->st = (int *) malloc(sizeof(int) * inc->n);
+    for(v = 0; v < inc->n; v++){
+        desc = getMapRepDesc(parkMap, v);
+        inc->ramp[v] = desc == 'u' || desc == 'd';
+        inc->st[v] = -1;
+    }
+    inc->trees = NULL;
+    return inc;
+}
+
+
+/* 1 if the edge from p to s may be taken as p was entered */
+static int canLeave(Incremental *inc, Tree *t, int p, int s){
+    return inc->ramp[p] == 0 || t->mode[p] == 1 ||
+                                    s - p == inc->NM || p - s == inc->NM;
+}
+
+
+static int isConsistent(Tree *t, int v){
+    return t->g[v] == t->rhs[v] &&
+                            (t->g[v] == NOCON || t->mode[v] == t->rmode[v]);
+}
+
+
+/*
+ * Auxiliary-function: treeUpdate
+ *
+ * Description:
+ *      computes again what the predecessors of s give it and puts s in the
+ *  queue, or takes it out of it, accordingly. A ramp is entered from a ramp
+ *  only if no other predecessor gives it the same distance: in GDijkstra
+ *  those relax with >= and the ramps with >, so they always win the tie
+ */
+
+static void treeUpdate(Incremental *inc, Tree *t, int s, PathStats *stats){
+    int i, p, w, best = NOCON;
+    char fromRamp = 1;
+
+    PScount(stats, relaxed);
+    if(s != t->origin){
+        for(i = inc->inStart[s]; i < inc->inStart[s + 1]; i++){
+            p = inc->inNode[i];
+            if(t->g[p] == NOCON || GisNodeActive(inc->g, p) == 0 ||
+                                                canLeave(inc, t, p, s) == 0)
+                continue;
+            w = t->g[p] + inc->inCost[i];
+            if(w < best){
+                best = w;
+                fromRamp = inc->ramp[p];
+            } else if(w == best && inc->ramp[p] == 0)
+                fromRamp = 0;
+        }
+        t->rhs[s] = best;
+        t->rmode[s] = inc->ramp[s] && fromRamp;
+    }
+
+    if(isConsistent(t, s))
+        t->key[s] = NOCON;
+    else
+        t->key[s] = t->g[s] < t->rhs[s] ? t->g[s] : t->rhs[s];
+    if(t->inQ[s])
+        PQupdateNode(t->PQ, s);
+    else if(t->key[s] != NOCON){
+        PQReinsert(t->PQ, s);
+        t->inQ[s] = 1;
+    }
+}
+
+
+static void updateSuccessors(Incremental *inc, Tree *t, int v,
+                                                        PathStats *stats){
+    int i;
+
+    for(i = inc->outStart[v]; i < inc->outStart[v + 1]; i++)
+        treeUpdate(inc, t, inc->outNode[i], stats);
+}
+
+
+static Tree *treeInit(Incremental *inc, int origin){
+    Tree *t = (Tree *) malloc(sizeof(Tree));
+    int v, n = inc->n;
+
+    t->origin = origin;
+    t->g = (int *) malloc(sizeof(int) * n);
+    t->rhs = (int *) malloc(sizeof(int) * n);
+    t->key = (int *) malloc(sizeof(int) * n);
+    t->mode = (char *) calloc(n, sizeof(char));
+    t->rmode = (char *) calloc(n, sizeof(char));
+    t->inQ = (char *) malloc(sizeof(char) * n);
+    for(v = 0; v < n; v++){
+        t->g[v] = NOCON;
+        t->rhs[v] = NOCON;
+        t->key[v] = NOCON;
+        t->inQ[v] = 1;
+    }
+    /* all nodes start in the heap, the consistent ones at the bottom */
+    t->PQ = PQinit(t->key, n);
+    t->rhs[origin] = 0;
+    t->key[origin] = 0;
+    PQupdateNode(t->PQ, origin);
+
+    t->next = inc->trees;
+    inc->trees = t;
+    return t;
+}
+
+
+/*
+ * Auxiliary-function: treeRepair
+ *
+ * Description:
+ *      settles the inconsistent nodes in order of key until dest is
+ *  consistent and nothing left in the queue could reach it cheaper. The
+ *  rest wait for a later query
+ */
+
+static void treeRepair(Incremental *inc, Tree *t, int dest, PathStats *stats){
+    int u;
+
+    while(!PQisempty(t->PQ)){
+        u = PQdelmin(t->PQ);
+        t->inQ[u] = 0;
+        PScount(stats, popped);
+        if(t->key[u] == NOCON)
+            break;
+        if(t->key[u] > t->g[dest] && isConsistent(t, dest)){
+            PQReinsert(t->PQ, u);
+            t->inQ[u] = 1;
+            break;
+        }
+
+        t->key[u] = NOCON;
+        if(t->g[u] >= t->rhs[u]){
+            /* better or just entered the other way, settle it */
+            t->g[u] = t->rhs[u];
+            t->mode[u] = t->rmode[u];
+        } else{
+            /* worse, start it over */
+            t->g[u] = NOCON;
+            treeUpdate(inc, t, u, stats);
+        }
+        updateSuccessors(inc, t, u, stats);
+    }
+}
+
+
+/*
+ * Auxiliary-function: treePath
+ *
+ * Description:
+ *      writes in st the path from the tree's origin to dest, going back
+ *  from dest by predecessors that give each node its distance, and to ramps
+ *  the way they were entered
+ */
+
+static void treePath(Incremental *inc, Tree *t, int dest){
+    int s, p = -1, i;
+
+    for(s = dest; s != t->origin; s = p){
+        for(i = inc->inStart[s]; i < inc->inStart[s + 1]; i++){
+            p = inc->inNode[i];
+            if(t->g[p] == NOCON || GisNodeActive(inc->g, p) == 0 ||
+                                                canLeave(inc, t, p, s) == 0)
+                continue;
+            if(t->g[p] + inc->inCost[i] != t->g[s])
+                continue;
+            if(inc->ramp[s] && inc->ramp[p] != t->mode[s])
+                continue;
+            break;
+        }
+        inc->st[s] = p;
+    }
+    inc->st[t->origin] = -1;
+}
+
+
+static int incrementalQuery(void *state, int origin, int dest, int **st,
+                                                        PathStats *stats){
+    Incremental *inc = (Incremental *) state;
+    Tree *t;
+
+    for(t = inc->trees; t != NULL && t->origin != origin; t = t->next);
+    if(t == NULL)
+        t = treeInit(inc, origin);
+
+    if(stats != NULL)
+        PSclear(stats);
+    PQsetStats(t->PQ, stats);
+    treeRepair(inc, t, dest, stats);
+    PQsetStats(t->PQ, NULL);
+
+    *st = inc->st;
+    if(t->g[dest] == NOCON){
+        inc->st[dest] = -1;
+        return NOCON;
+    }
+    treePath(inc, t, dest);
+    return t->g[dest];
+}
+
+
+/* a node turned on or off changes what its successors get, in every tree */
+static void incrementalNotify(void *state, int node, int active){
+    Incremental *inc = (Incremental *) state;
+    Tree *t;
+
+    for(t = inc->trees; t != NULL; t = t->next)
+        updateSuccessors(inc, t, node, NULL);
+}
+
+
+/* and a floor the same for the nodes linked to it */
+static void incrementalNotifyFloor(void *state, int floor, int active){
+    Incremental *inc = (Incremental *) state;
+    int i;
+
+    for(i = inc->floorStart[floor]; i < inc->floorStart[floor + 1]; i++)
+        incrementalNotify(state, inc->floorNode[i], active);
+}
+
+
+static void incrementalDestroy(void *state){
+    Incremental *inc = (Incremental *) state;
+    Tree *t;
+
+    while(inc->trees != NULL){
+        t = inc->trees;
+        inc->trees = t->next;
+        free(t->g);
+        free(t->rhs);
+        free(t->key);
+        free(t->mode);
+        free(t->rmode);
+        free(t->inQ);
+        PQdestroy(t->PQ);
+        free(t);
+    }
+    free(inc->floorStart);
+    free(inc->floorNode);
+    free(inc->ramp);
+    free(inc->st);
+    free(inc);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* bounded, the reference's search cut short by a bound of the rest         */
+
+/* the bound through free spots only is used when no more than 1 / BFREE of
+ * the spots are free */
+#define BFREE 4
+
+/*
+ *  Data Type: Bound
+ *
+ *  Description:
+ *      cost from every node to one access node with the park empty and
+ *  without restrictions, and ramps left any way, so no path to it can cost
+ *  less. NOCON for nodes that never get there.
+ *
+ *      hFree is the same through the spots free when it was made, or freed
+ *  since: a search backwards over the car paths from those spots, each
+ *  starting at the bound of its walk. Taking a spot leaves it good, freeing
+ *  one goes on the search from it (see spreadFree)
+ */
+
+typedef struct _bound{
+    int dest;
+    int *h;
+    int *hFree;         /* NULL until the park first gets nearly full */
+    PrioQ *freeQ;       /* over the car path nodes, keyed by hFree */
+    int freeValid;
+    struct _bound *next;
+} Bound;
+
+
+typedef struct _bounded{
+    Map *parkMap;
+    GraphL *g;
+    int n;
+    int NM;             /* difference between a ramp and the one it leads to */
+    int NMP;            /* car path nodes are the first NMP */
+    int *outStart;      /* edges as in GedgeTable, the park's own tables
+                           (see PgetEdgeTable) */
+    int *outNode;
+    int *outCost;
+    int *inStart;       /* and backwards */
+    int *inNode;
+    int *inCost;
+    char *ramp;
+    char *spot;         /* car path nodes of spots */
+    int *st;
+    int *cost;          /* cost so far, NOCON for nodes not reached */
+    int *h;             /* bound of the search going on */
+    int *heap;          /* nodes reached and not taken out */
+    int nHeap;
+    int *pos;           /* place in heap, -1 if not reached, -2 if taken out */
+    int *touched;       /* nodes reached, to set back for the next search */
+    int nTouched;
+    Bound *bounds;
+} Bounded;
+
+
+static void *boundedInit(Map *parkMap, GraphL *g){
+    Bounded *b = (Bounded *) malloc(sizeof(Bounded));
+    int v;
+    char desc;
+
+    b->parkMap = parkMap;
+    b->g = g;
+    b->n = Gnodes(g);
+    b->NM = PgetN(parkMap) * PgetM(parkMap);
+    b->NMP = b->NM * PgetP(parkMap);
+    PgetEdgeTable(parkMap, 0, &b->outStart, &b->outNode, &b->outCost);
+    PgetEdgeTable(parkMap, 1, &b->inStart, &b->inNode, &b->inCost);
+
+    b->ramp = (char *) malloc(sizeof(char) * b->n);
+    b->spot = (char *) calloc(b->n, sizeof(char));
+    b->st = (int *) malloc(sizeof(int) * b->n);
+    b->cost = (int *) malloc(sizeof(int) * b->n);
+    b->heap = (int *) malloc(sizeof(int) * b->n);
+    b->pos = (int *) malloc(sizeof(int) * b->n);
+    b->touched = (int *) malloc(sizeof(int) * b->n);
+    b->nHeap = b->nTouched = 0;
+    for(v = 0; v < b->n; v++){
+        desc = getMapRepDesc(parkMap, v);
+        b->ramp[v] = desc == 'u' || desc == 'd';
+        b->st[v] = -1;
+        b->cost[v] = NOCON;
+        b->pos[v] = -1;
+        /* the only way out of a spot is to walk from it */
+        if(v < b->NMP && b->outStart[v + 1] - b->outStart[v] == 1 &&
+                                    b->outNode[b->outStart[v]] == v + b->NMP)
+            b->spot[v] = 1;
+    }
+    b->bounds = NULL;
+    return b;
+}
+
+
+/*
+ * Auxiliary-function: boundOf
+ *
+ * Description:
+ *      bound of the costs to an access node, made the first time it is
+ *  asked for by a search backwards from it over every edge
+ */
+
+static Bound *boundOf(Bounded *b, int dest){
+    Bound *B;
+    PrioQ *PQ;
+    int v, i;
+
+    for(B = b->bounds; B != NULL; B = B->next)
+        if(B->dest == dest)
+            return B;
+
+    B = (Bound *) malloc(sizeof(Bound));
+    B->dest = dest;
+    B->h = (int *) malloc(sizeof(int) * b->n);
+    for(v = 0; v < b->n; v++)
+        B->h[v] = NOCON;
+    PQ = PQinit(B->h, b->n);
+    B->h[dest] = 0;
+    PQupdateNode(PQ, dest);
+    while(!PQisempty(PQ)){
+        v = PQdelmin(PQ);
+        if(B->h[v] == NOCON)
+            break;
+        for(i = b->inStart[v]; i < b->inStart[v + 1]; i++)
+            if(B->h[b->inNode[i]] > B->h[v] + b->inCost[i]){
+                B->h[b->inNode[i]] = B->h[v] + b->inCost[i];
+                PQupdateNode(PQ, b->inNode[i]);
+            }
+    }
+    PQdestroy(PQ);
+    B->hFree = NULL;
+    B->freeQ = NULL;
+    B->freeValid = 0;
+
+    B->next = b->bounds;
+    b->bounds = B;
+    return B;
+}
+
+
+/*
+ * Auxiliary-function: spreadFree
+ *
+ * Description:
+ *      goes on with the backwards search of hFree from the car path nodes
+ *  in its queue, until every one is as low as the spots free make it
+ */
+
+static void spreadFree(Bounded *b, Bound *B){
+    int v, u, i;
+
+    while(!PQisempty(B->freeQ)){
+        v = PQdelmin(B->freeQ);
+        if(B->hFree[v] == NOCON)
+            break;
+        for(i = b->inStart[v]; i < b->inStart[v + 1]; i++){
+            u = b->inNode[i];
+            if(u < b->NMP && B->hFree[u] > B->hFree[v] + b->inCost[i]){
+                B->hFree[u] = B->hFree[v] + b->inCost[i];
+                PQReinsert(B->freeQ, u);
+            }
+        }
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: freeBound
+ *
+ * Description:
+ *      hFree of a bound, made again from the spots free now if it isn't good
+ */
+
+static int *freeBound(Bounded *b, Bound *B){
+    int v;
+
+    if(B->freeValid)
+        return B->hFree;
+    if(B->hFree == NULL){
+        B->hFree = (int *) malloc(sizeof(int) * b->n);
+        B->freeQ = PQinit(B->hFree, b->NMP);
+    }
+    /* the walks are bounded as before, the car paths from the spots */
+    for(v = 0; v < b->n; v++)
+        B->hFree[v] = v < b->NMP ? NOCON : B->h[v];
+    /* only to put every node back in the queue, st is left as it was */
+    PQreset(B->freeQ, b->st, B->hFree, b->NMP);
+    for(v = 0; v < b->NMP; v++)
+        if(b->spot[v] && GisNodeActive(b->g, v)){
+            B->hFree[v] = B->h[v + b->NMP];
+            PQupdateNode(B->freeQ, v);
+        }
+    spreadFree(b, B);
+    B->freeValid = 1;
+    return B->hFree;
+}
+
+
+/*
+ * Auxiliary-function: before
+ *
+ * Description:
+ *      1 if node v is taken out of the search before node w: the lower cost
+ *  plus bound first, then, on a tie, the lower cost
+ */
+
+static int before(Bounded *b, int v, int w){
+    if(b->cost[v] + b->h[v] != b->cost[w] + b->h[w])
+        return b->cost[v] + b->h[v] < b->cost[w] + b->h[w];
+    return b->cost[v] < b->cost[w];
+}
+
+
+static void heapPut(Bounded *b, int i, int v){
+    b->heap[i] = v;
+    b->pos[v] = i;
+    return;
+}
+
+
+static void heapUp(Bounded *b, int i, PathStats *stats){
+    int v = b->heap[i];
+
+    PScount(stats, fixUps);
+    while(i > 0 && before(b, v, b->heap[(i - 1) / 2])){
+        heapPut(b, i, b->heap[(i - 1) / 2]);
+        PScount(stats, heapSwaps);
+        i = (i - 1) / 2;
+    }
+    heapPut(b, i, v);
+    return;
+}
+
+
+static int heapPop(Bounded *b, PathStats *stats){
+    int first = b->heap[0], v, i = 0, child;
+
+    b->pos[first] = -2;
+    if(--b->nHeap == 0)
+        return first;
+    v = b->heap[b->nHeap];
+    PScount(stats, fixDowns);
+    while((child = 2 * i + 1) < b->nHeap){
+        if(child + 1 < b->nHeap && before(b, b->heap[child + 1],
+                                                        b->heap[child]))
+            child++;
+        if(before(b, v, b->heap[child]) == 0){
+            heapPut(b, i, b->heap[child]);
+            PScount(stats, heapSwaps);
+            i = child;
+        } else
+            break;
+    }
+    heapPut(b, i, v);
+    return first;
+}
+
+
+/*
+ * Auxiliary-function: boundedRelax
+ *
+ * Description:
+ *      gives node w the cost c through v if it is lower (or the same, if v
+ *  isn't a ramp), as GDijkstra does. Nodes that can't get to the access, and
+ *  nodes off, which GDijkstra would only skip, are left alone
+ */
+
+static void boundedRelax(Bounded *b, int v, int w, int c, PathStats *stats){
+    if(b->h[w] == NOCON || GisNodeActive(b->g, w) == 0)
+        return;
+    if(b->cost[w] < c || (b->cost[w] == c && b->ramp[v]))
+        return;
+#ifdef PATHSTATS
+    if(b->cost[w] > c)
+        PScount(stats, decreaseKeys);
+#endif
+    if(b->pos[w] == -1){
+        b->touched[b->nTouched++] = w;
+        heapPut(b, b->nHeap++, w);
+    }
+    b->cost[w] = c;
+    b->st[w] = v;
+    if(b->pos[w] >= 0)
+        heapUp(b, b->pos[w], stats);
+    PScount(stats, relaxed);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: boundedQuery
+ *
+ * Description:
+ *      GDijkstra, with its rule for ramps, but taking the nodes in order of
+ *  their cost plus a bound of the rest of the way (A*) instead of their cost
+ *  alone. The access is settled at the same cost, and the nodes whose bound
+ *  says they can't lead to a path as cheap are never settled: once the best
+ *  spot is found, only the walks that could still beat it go on.
+ *
+ *      A ramp is left the way the reference leaves it, which depends on
+ *  where it was entered from. On a tie of cost plus bound the lower cost goes
+ *  first, so every node that may give another the same cost is taken out
+ *  before it, and the last one to give it, the one the reference keeps, is
+ *  the same.
+ *
+ *      The bound is the one through the free spots when no more than
+ *  1 / BFREE of them are free, and heads the search straight for them
+ */
+
+static int boundedQuery(void *state, int origin, int dest, int **st,
+                                                        PathStats *stats){
+    Bounded *b = (Bounded *) state;
+    Bound *B;
+    int v, i, fromRamp, cost = NOCON;
+
+    while(b->nTouched > 0){
+        v = b->touched[--b->nTouched];
+        b->cost[v] = NOCON;
+        b->st[v] = -1;
+        b->pos[v] = -1;
+    }
+    b->nHeap = 0;
+    if(stats != NULL)
+        PSclear(stats);
+    B = boundOf(b, dest);
+    /* with few spots left, a search heads for them */
+    if(PgetFree(b->parkMap) * BFREE <= PgetSpots(b->parkMap))
+        b->h = freeBound(b, B);
+    else
+        b->h = B->h;
+
+    if(b->h[origin] != NOCON){
+        b->cost[origin] = 0;
+        b->touched[b->nTouched++] = origin;
+        heapPut(b, b->nHeap++, origin);
+    }
+    while(b->nHeap > 0){
+        v = heapPop(b, stats);
+        PScount(stats, popped);
+        if(GisNodeActive(b->g, v) == 0){
+            PScount(stats, skipped);
+            continue;
+        }
+        if(v == dest){
+            cost = b->cost[v];
+            break;
+        }
+        if(b->ramp[v]){
+            fromRamp = b->st[v] >= 0 && b->ramp[b->st[v]];
+            for(i = b->outStart[v]; i < b->outStart[v + 1]; i++){
+                if(fromRamp == 0 && b->outNode[i] - v != b->NM &&
+                                                v - b->outNode[i] != b->NM){
+                    PScount(stats, rampRejected);
+                    continue;
+                }
+                boundedRelax(b, v, b->outNode[i], b->cost[v] + b->outCost[i],
+                                                                    stats);
+                if(fromRamp == 0)
+                    break;
+            }
+            continue;
+        }
+        for(i = b->outStart[v]; i < b->outStart[v + 1]; i++)
+            boundedRelax(b, v, b->outNode[i], b->cost[v] + b->outCost[i],
+                                                                    stats);
+    }
+#ifdef PATHSTATS
+    if(stats != NULL)
+        stats->cost = cost;
+#endif
+
+    if(cost == NOCON)
+        b->st[dest] = -1;
+    *st = b->st;
+    return cost;
+}
+
+
+/* cars and restrictions only take edges away, the bounds stay good, but
+ * for a spot freed, which the bounds through free spots must be told of */
+static void boundedNotify(void *state, int node, int active){
+    Bounded *b = (Bounded *) state;
+    Bound *B;
+
+    if(active == 0 || b->spot[node] == 0)
+        return;
+    for(B = b->bounds; B != NULL; B = B->next){
+        if(B->freeValid == 0 || B->hFree[node] <= B->h[node + b->NMP])
+            continue;
+        /* not worth keeping while the park isn't nearly full */
+        if(PgetFree(b->parkMap) * BFREE > PgetSpots(b->parkMap)){
+            B->freeValid = 0;
+            continue;
+        }
+        B->hFree[node] = B->h[node + b->NMP];
+        PQReinsert(B->freeQ, node);
+        spreadFree(b, B);
+    }
+}
+
+
+static void boundedNotifyFloor(void *state, int floor, int active){
+    return;
+}
+
+
+static void boundedDestroy(void *state){
+    Bounded *b = (Bounded *) state;
+    Bound *B;
+
+    while(b->bounds != NULL){
+        B = b->bounds;
+        b->bounds = B->next;
+        free(B->h);
+        if(B->hFree != NULL){
+            free(B->hFree);
+            PQdestroy(B->freeQ);
+        }
+        free(B);
+    }
+    free(b->ramp);
+    free(b->spot);
+    free(b->st);
+    free(b->cost);
+    free(b->heap);
+    free(b->pos);
+    free(b->touched);
+    free(b);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* registry, the reference first                                           */
+
+static EngineType engineTypes[] = {
+    {"dijkstra", dijkstraInit, dijkstraQuery, dijkstraNotify,
+                    dijkstraNotifyFloor, dijkstraDestroy, dijkstraCopy, 1},
+    {"incremental", incrementalInit, incrementalQuery, incrementalNotify,
+                    incrementalNotifyFloor, incrementalDestroy, NULL, 0},
+    {"bounded", boundedInit, boundedQuery, boundedNotify,
+                    boundedNotifyFloor, boundedDestroy, NULL, 0},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0}
+};
+
+static char *defaultName = "dijkstra";
+
+
+static EngineType *findType(char *name){
+    int i;
+
+    for(i = 0; engineTypes[i].name != NULL; i++)
+        if(strcmp(engineTypes[i].name, name) == 0)
+            return &engineTypes[i];
+    return NULL;
+}
+
+
+Engine *Einit(char *name, Map *parkMap, GraphL *g){
+    EngineType *type = findType(name);
+    Engine *E;
+
+    if(type == NULL)
+        return NULL;
+    E = (Engine *) malloc(sizeof(Engine));
+    E->type = type;
+    E->state = type->init(parkMap, g);
+    return E;
+}
+
+
+int Equery(Engine *E, int origin, int dest, int **st, PathStats *stats){
+    return E->type->query(E->state, origin, dest, st, stats);
+}
+
+
+void Enotify(Engine *E, int node, int active){
+    E->type->notify(E->state, node, active);
+    return;
+}
+
+
+void EnotifyFloor(Engine *E, int floor, int active){
+    E->type->notifyFloor(E->state, floor, active);
+    return;
+}
+
+
+void Ecopy(Engine *to, Engine *from){
+    if(to->type == from->type && to->type->copy != NULL)
+        to->type->copy(to->state, from->state);
+    return;
+}
+
+
+void Edestroy(Engine *E){
+    E->type->destroy(E->state);
+    free(E);
+    return;
+}
+
+
+char *Ename(int i){
+    int n;
+
+    for(n = 0; engineTypes[n].name != NULL; n++);
+    return i >= 0 && i < n ? engineTypes[i].name : NULL;
+}
+
+
+char *EnameOf(Engine *E){
+    return E->type->name;
+}
+
+
+int EsetDefault(char *name){
+    EngineType *type = findType(name);
+
+    if(type == NULL)
+        return 0;
+    defaultName = type->name;
+    return 1;
+}
+
+
+char *Edefault(void){
+    return defaultName;
+}
+
+
+int Eexact(char *name){
+    EngineType *type = findType(name);
+
+    return type != NULL ? type->exact : 0;
+}
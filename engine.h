@@ -0,0 +1,191 @@
+/*
+ *  File name: engine.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: routing engines. An engine answers the path queries of one
+ *          Map: it is made for the Map, told about every node and floor the
+ *          Map turns on or off (spots taken and freed, restrictions) and
+ *          asked for the best path from an entrance to an access type node.
+ *
+ *          Engines are registered by name in engine.c. "dijkstra", GDijkstra
+ *          over the binary heap, is the reference every other one must agree
+ *          with, on the paths or at least on their cost (see Eexact and
+ *          autodiff.c), and the default for new Maps unless another one is
+ *          chosen with EsetDefault
+ *
+ *  Abstract Data Type: Engine
+ *              One engine working for one Map, with whatever it keeps
+ *          between queries
+ *
+ *  Function list:
+ *    Einit
+ *    Equery
+ *    Enotify
+ *    EnotifyFloor
+ *    Ecopy
+ *    Edestroy
+ *    Ename
+ *    EnameOf
+ *    EsetDefault
+ *    Edefault
+ *    Eexact
+ *
+ *  Non-standard dependencies:
+ *    parkmap.h
+ *    graphL.h
+ *    pathstats.h
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __engine__h
+#define __engine__h 1
+
+#include"parkmap.h"
+#include"graphL.h"
+#include"pathstats.h"
+
+typedef struct _engine Engine;
+
+
+/*
+ *  Function:
+ *    Einit
+ *
+ *  Description:
+ *    makes an engine for a Map
+ *
+ *  Arguments:
+ *    char *name - registered name of the engine
+ *    Map *parkMap - map the queries are about
+ *    GraphL *g - graph of the map, with its current active nodes
+ *
+ *  Return value:
+ *    Engine * - the engine, NULL if there is none with that name
+ */
+
+Engine *Einit(char *name, Map *parkMap, GraphL *g);
+
+
+/*
+ *  Function:
+ *    Equery
+ *
+ *  Description:
+ *    finds the best path from origin to dest in the graph as it is now
+ *
+ *  Arguments:
+ *    Engine *E
+ *    int origin - entrance node
+ *    int dest - access type node
+ *    int **st - reference to save the path table: st[n] is the node before
+ *        n in the path, -1 for the origin and for nodes not in the path. Only
+ *        the nodes of the path found are meaningful, the table belongs to
+ *        the engine and is only good until the next query
+ *    PathStats *stats - where to count the work done (may be NULL)
+ *
+ *  Return value:
+ *    int - cost of the path, NOCON if there is none (st[dest] is then -1)
+ */
+
+int Equery(Engine *E, int origin, int dest, int **st, PathStats *stats);
+
+
+/*
+ *  Function:
+ *    Enotify
+ *
+ *  Description:
+ *    tells the engine a node of its graph was just turned on or off
+ *
+ *  Arguments:
+ *    Engine *E
+ *    int node - node changed
+ *    int active - 1 if it was turned on, 0 if off
+ */
+
+void Enotify(Engine *E, int node, int active);
+
+
+/*
+ *  Function:
+ *    EnotifyFloor
+ *
+ *  Description:
+ *    tells the engine a floor of its graph was just closed or opened, and
+ *    with it the nodes linked to it (see GlinkNodeToFloor)
+ *
+ *  Arguments:
+ *    Engine *E
+ *    int floor - floor changed
+ *    int active - 1 if it was opened, 0 if closed
+ */
+
+void EnotifyFloor(Engine *E, int floor, int active);
+
+
+/*
+ *  Function:
+ *    Ecopy
+ *
+ *  Description:
+ *    makes an engine answer its next query as another one of the same kind,
+ *  over the same graph, would answer it. Engines whose paths depend on the
+ *  queries before (as GDijkstra's ties do) copy what they keep of them
+ *
+ *  Arguments:
+ *    Engine *to - engine changed
+ *    Engine *from - engine copied, left as it is
+ */
+
+void Ecopy(Engine *to, Engine *from);
+
+
+void Edestroy(Engine *E);
+
+
+/*
+ *  Functions:
+ *    Ename
+ *    EnameOf
+ *    EsetDefault
+ *    Edefault
+ *
+ *  Description:
+ *    registered engines, by index from 0 (the reference), the one an engine
+ *  is and the one new Maps get. EsetDefault should be called before any Map
+ *  is made and before any thread is started
+ *
+ *  Return value:
+ *    char * - name of the i-th engine, NULL after the last (Ename), of the
+ *        engine E (EnameOf) or of the default one (Edefault)
+ *    int - 1 if the engine exists, 0 otherwise (EsetDefault)
+ */
+
+char *Ename(int i);
+char *EnameOf(Engine *E);
+int EsetDefault(char *name);
+char *Edefault(void);
+
+
+/*
+ *  Function:
+ *    Eexact
+ *
+ *  Description:
+ *    tells how close an engine keeps to the reference. Engines that keep no
+ *  heap of their own between queries can't break ties among paths of the
+ *  same cost as GDijkstra does, so they only promise the same cost
+ *
+ *  Return value:
+ *    int - 1 if the engine finds the very paths of the reference, 0 if only
+ *        paths of the same cost (or if there is no engine with that name)
+ */
+
+int Eexact(char *name);
+
+#endif
@@ -8,7 +8,8 @@
 *
 * Nota: a funcao nao fecha o ficheiro!!
 *
-* History:
+* History: estado da validacao passado pelo chamador (escreve_saida_r),
+*          para poder haver varios ficheiros de saida em simultaneo
 *
 * Bug-report:  lms@inesc-id.pt
 *
@@ -19,7 +20,25 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_ID_SIZE 128
+#include "escreve_saida.h"
+
+
+/******************************************************************************
+ * inicia_estado_saida ()
+ *
+ * Arguments: es - estado a iniciar
+ * Returns: nada
+ *
+ * Description: prepara o estado para o primeiro movimento de um ficheiro
+ *
+ *****************************************************************************/
+
+void inicia_estado_saida(EstadoSaida *es)
+{
+  es->pvid[0] = '\0';
+  es->ptk = -1;
+  es->ppx = es->ppy = es->ppz = 0;
+}
 
 
 /******************************************************************************
@@ -35,6 +54,34 @@
  *          -1 - se houver algum erro
  * Side-Effects: nenhum
  *
+ * Description: igual a escreve_saida_r, com um unico estado para todo o
+ *              programa
+ *
+ *****************************************************************************/
+
+int escreve_saida(FILE *fp, char *vid, int tk, int pX, int pY, int pZ, char tm)
+{
+  static EstadoSaida es = { "", -1, 0, 0, 0 };
+
+  return escreve_saida_r(&es, fp, vid, tk, pX, pY, pZ, tm);
+}
+/*end of function */
+
+
+/******************************************************************************
+ * escreve_saida_r ()
+ *
+ * Arguments: es - estado com o ultimo movimento escrito neste ficheiro
+ *            fp - descriptor do ficheiro de saida
+ *            vid - identificador da viatura
+ *            tk - instante de tempo em que ocorre o movimento
+ *            pX, pY, pZ - coordenadas (X,Y,Z) da viatura em movimento
+ *            tm - tipo de movimento
+ * Returns: 0 - se nao houver qualquer erro, ou seja se as coordenadas
+ *              corresponderem a uma posicao valida
+ *          -1 - se houver algum erro
+ * Side-Effects: actualiza o estado es
+ *
  * Description: escreve no ficheiro de saida um tuplo de valores do tipo
  *                          Vid T X Y Z M
  *              sendo Vid o identificador da viatura, T o instante de tempo,
@@ -44,11 +91,9 @@
  *
  *****************************************************************************/
 
-int escreve_saida(FILE *fp, char *vid, int tk, int pX, int pY, int pZ, char tm)
+int escreve_saida_r(EstadoSaida *es, FILE *fp, char *vid, int tk,
+                    int pX, int pY, int pZ, char tm)
 {
-  static char pvid[MAX_ID_SIZE];
-  static int ptk = -1, ppx, ppy, ppz;
-
   int retval = 0;    /* valor retornado quando não há erro;
                       * se houver erro retval = -1
                       */
@@ -83,28 +128,28 @@ int escreve_saida(FILE *fp, char *vid, int tk, int pX, int pY, int pZ, char tm)
             vid, tk, pX, pY, pZ, tm);
     retval = -1;
   } else {
-    if (ptk != -1) { /* 2nd execution */
+    if (es->ptk != -1) { /* 2nd execution */
       /* Note: this is abusive; this assumes that identifiers for different
        * are in different memory locations.
        * If this is not the case, comment out this test!
        */
-      if (!strcmp(vid, pvid)) {
+      if (!strcmp(vid, es->pvid)) {
         /* same vehicle as in last call; exclude summary and exit lines */
         if ((tm == 'i') || (tm == 'm') || (tm == 'e') ||
             (tm == 'p') || (tm == 'a')) {
-          if (tk <= ptk) {
+          if (tk <= es->ptk) {
             /* invalid tk */
-            fprintf(stderr, "tk deve ser maior que %d.\n", ptk);
+            fprintf(stderr, "tk deve ser maior que %d.\n", es->ptk);
             fprintf(stderr, "Chamada erronea:\t\t\t%s %d %d %d %d %c\n",
                     vid, tk, pX, pY, pZ, tm);
             retval = -1;
-          } else  if (pZ == ppz && pX == ppx && pY == ppy) {
+          } else  if (pZ == es->ppz && pX == es->ppx && pY == es->ppy) {
             /* it did not move at all */
             fprintf(stderr, "Viatura %s não se moveu.\n", vid);
             fprintf(stderr, "Chamada erronea:\t\t\t%s %d %d %d %d %c\n",
                     vid, tk, pX, pY, pZ, tm);
             retval = -1;
-          } else if (pZ == ppz && pX != ppx && pY != ppy) {
+          } else if (pZ == es->ppz && pX != es->ppx && pY != es->ppy) {
               /* diagonal move on same floor*/
               fprintf(stderr, "Movimento invalido: ");
               fprintf(stderr,
@@ -112,7 +157,7 @@ int escreve_saida(FILE *fp, char *vid, int tk, int pX, int pY, int pZ, char tm)
               fprintf(stderr, "Chamada erronea:\t\t\t%s %d %d %d %d %c\n",
                       vid, tk, pX, pY, pZ, tm);
               retval = -1;
-            } else if (pZ != ppz && (pX != ppx || pY != ppy)) {
+            } else if (pZ != es->ppz && (pX != es->ppx || pY != es->ppy)) {
               /* level changes with some lateral move*/
               fprintf(stderr, "Movimento invalido: ");
               fprintf(stderr,
@@ -127,9 +172,10 @@ int escreve_saida(FILE *fp, char *vid, int tk, int pX, int pY, int pZ, char tm)
   }
   if (retval == 0) {
     /* keep info from this run through */
-    strncpy(pvid, vid, MAX_ID_SIZE);
-    ptk = tk;
-    ppx = pX; ppy = pY; ppz = pZ;
+    strncpy(es->pvid, vid, MAX_ID_SIZE - 1);
+    es->pvid[MAX_ID_SIZE - 1] = '\0';
+    es->ptk = tk;
+    es->ppx = pX; es->ppy = pY; es->ppz = pZ;
 
     /* generate output */
     fprintf(fp, "%s %d %d %d %d %c\n", vid, tk, pX, pY, pZ, tm);
@@ -1,7 +1,19 @@
 #ifndef __escreve_saida__h
 #define __escreve_saida__h 1
 
+#include<stdio.h>
 #include<stdlib.h>
 
+#define MAX_ID_SIZE 128
+
+/* ultimo movimento escrito, usado para validar o seguinte */
+typedef struct _estado_saida {
+  char pvid[MAX_ID_SIZE];
+  int ptk, ppx, ppy, ppz;
+} EstadoSaida;
+
+void inicia_estado_saida(EstadoSaida *es);
+int escreve_saida_r(EstadoSaida *es, FILE *fp, char *vid, int tk,
+                    int pX, int pY, int pZ, char tm);
 int escreve_saida(FILE *fp, char *vid, int tk, int pX, int pY, int pZ, char tm);
 #endif
@@ -0,0 +1,166 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: length prefixed frames over stream sockets
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* read and write are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<errno.h>
+
+#include"frame.h"
+
+/* maximum number of characters in the length line, newline included */
+#define HEADSIZE 12
+
+/* digits of the length, enough for MAXFRAME */
+#define HEADDIGITS 8
+
+
+/*
+ * Auxiliary-function: writeAll
+ *
+ * Description:
+ *      writes len bytes, going on after partial writes and interruptions
+ */
+
+static int writeAll(int fd, char *buf, int len){
+    int n;
+
+    while(len > 0){
+        n = write(fd, buf, len);
+        if(n < 0){
+            if(errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: readAll
+ *
+ * Description:
+ *      reads exactly len bytes, returns -1 if the connection ends before
+ */
+
+static int readAll(int fd, char *buf, int len){
+    int n;
+
+    while(len > 0){
+        n = read(fd, buf, len);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: parseLength
+ *
+ * Description:
+ *      reads the length from its n digits, refusing anything above MAXFRAME
+ *  as soon as it gets there so it never overflows
+ *
+ * Return value:
+ *      0 on success, -1 if the length is too large
+ */
+
+static int parseLength(char *digits, int n, int *len){
+    int i, d;
+
+    *len = 0;
+    for(i = 0; i < n; i++){
+        d = digits[i] - '0';
+        if(*len > (MAXFRAME - d) / 10)
+            return -1;
+        *len = *len * 10 + d;
+    }
+    return 0;
+}
+
+
+int frameWrite(int fd, char *payload, int len){
+    char head[HEADSIZE];
+    int n;
+
+    n = sprintf(head, "%d\n", len);
+    if(writeAll(fd, head, n) < 0)
+        return -1;
+    return writeAll(fd, payload, len);
+}
+
+
+char *frameRead(int fd, int *len){
+    char head[HEADSIZE];
+    char *payload;
+    int i;
+
+    /* length line, one character at a time not to read into the payload */
+    for(i = 0; i <= HEADDIGITS; i++){
+        if(readAll(fd, head + i, 1) < 0)
+            return NULL;
+        if(head[i] == '\n')
+            break;
+        if(head[i] < '0' || head[i] > '9')
+            return NULL;
+    }
+    if(i == 0 || i > HEADDIGITS)
+        return NULL;
+
+    if(parseLength(head, i, len) < 0)
+        return NULL;
+
+    payload = (char *) malloc(sizeof(char) * (*len + 1));
+    if(payload == NULL)
+        return NULL;
+    if(readAll(fd, payload, *len) < 0){
+        free(payload);
+        return NULL;
+    }
+    payload[*len] = '\0';
+    return payload;
+}
+
+
+int frameParse(char *buf, int size, int *start, int *len){
+    int i;
+
+    for(i = 0; i < size && i <= HEADDIGITS; i++){
+        if(buf[i] == '\n')
+            break;
+        if(buf[i] < '0' || buf[i] > '9')
+            return -1;
+    }
+    if(i > HEADDIGITS)
+        return -1;
+    if(i == size)
+        return 0;
+    if(i == 0)
+        return -1;
+
+    if(parseLength(buf, i, len) < 0)
+        return -1;
+    *start = i + 1;
+
+    return *start + *len <= size ? 1 : 0;
+}
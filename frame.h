@@ -0,0 +1,102 @@
+/*
+ *  File name: frame.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: framing of the messages exchanged with the route server
+ *          (autoparkd) through a local socket.
+ *
+ *          A frame is its payload length written as a decimal number in a
+ *          line of its own, followed by exactly that many bytes:
+ *
+ *              <length>\n<payload>
+ *
+ *          The length has at most 8 digits and isn't above MAXFRAME; any
+ *          other length line makes the frame invalid.
+ *
+ *          Requests carry event lines with the same format as the car input
+ *          and restriction files, or the single word RESET to bring the park
+ *          back to its initial state, or lines "COST <x> <y> <z> <type>" to
+ *          ask what a car from an entrance would get without parking it.
+ *          Responses carry the output lines those events produced, in the
+ *          same format as the .pts file (possibly none, for a zero length
+ *          frame), or a line "<cost> <x> <y> <z>" per COST line, all -1 if
+ *          there's no spot
+ *
+ *  Function list:
+ *    frameWrite
+ *    frameRead
+ *    frameParse
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __frame__h
+#define __frame__h 1
+
+/* largest accepted payload */
+#define MAXFRAME (1 << 24)
+
+
+/*
+ *  Function:
+ *    frameWrite
+ *
+ *  Description:
+ *    writes a whole frame to a descriptor
+ *
+ *  Arguments:
+ *    int fd - socket descriptor
+ *    char *payload - payload bytes
+ *    int len - payload length
+ *
+ *  Return value:
+ *    int - 0 on success, -1 on error
+ */
+
+int frameWrite(int fd, char *payload, int len);
+
+
+/*
+ *  Function:
+ *    frameRead
+ *
+ *  Description:
+ *    reads a whole frame from a descriptor, blocking until it is complete
+ *
+ *  Arguments:
+ *    int fd - socket descriptor
+ *    int *len - reference to save the payload length
+ *
+ *  Return value:
+ *    char * - allocated payload (null terminated) to be freed by the caller,
+ *          NULL at end of connection or on error
+ */
+
+char *frameRead(int fd, int *len);
+
+
+/*
+ *  Function:
+ *    frameParse
+ *
+ *  Description:
+ *    checks whether a buffer starts with a complete frame
+ *
+ *  Arguments:
+ *    char *buf - received bytes
+ *    int size - number of received bytes
+ *    int *start - reference to save the payload offset
+ *    int *len - reference to save the payload length
+ *
+ *  Return value:
+ *    int - 1 if a complete frame is there, 0 if more bytes are needed,
+ *          -1 if the buffer doesn't hold a valid frame
+ */
+
+int frameParse(char *buf, int size, int *start, int *len);
+
+#endif
@@ -0,0 +1,575 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: synthetic park and workload generator
+ *
+ *               Writes a park configuration file of any size, in the same
+ *          format read by mapInit, and car input and restriction files for
+ *          it, so the routing time can be measured for bigger parks and
+ *          heavier loads than the ones in data/ and mais-testes/.
+ *
+ *          To run:
+ *              gengar <name> <N> <M> <P> [options]
+ *
+ *          writes name.cfg, name.inp and, if there are restrictions,
+ *          name.res. Options:
+ *              -s spots      fraction of the spot cells that are spots (0.8)
+ *              -r ramps      ramps between each pair of floors (2)
+ *              -e entrances  number of entrances, all on the first floor (2)
+ *              -a accesses   number of access points, spread by floors (P,
+ *                            at least 2)
+ *              -t types      number of access types (2)
+ *              -c cars       number of cars (1000)
+ *              -l rate       cars arriving per time unit (1.0)
+ *              -d dwell      mean time a car stays in the park (100)
+ *              -R rate       restrictions per time unit (0)
+ *              -L length     mean time a restriction lasts (50)
+ *              -x seed       random seed (1)
+ *
+ *          Every floor has a wall around it, a lane along each side wall
+ *          and a horizontal lane every third row, the rows in between are
+ *          spots or walls. Entrances and access points are on the side
+ *          walls, next to the lanes. Arrivals and restrictions are Poisson,
+ *          car and restriction durations exponential.
+ *
+ *  Implementation details:
+ *      The generator has its own random number generator so the same seed
+ *  gives the same files everywhere.
+ *
+ *      autopark expects every car that leaves to be parked, so arrivals are
+ *  delayed until the first departure whenever the park could be full. The
+ *  restrictions don't overlap in time, each one starts after the previous
+ *  one is lifted, which keeps the lifts in time order as the restriction
+ *  file loader needs, and at most one spot or the top floor is restricted
+ *  at a time (closing a lower floor would close the ones above it too).
+ *  The top floor is only restricted if no access type is only there
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+
+
+#define NAMESIZE 1024
+/* tries to place each ramp before giving up */
+#define RAMPTRIES 10000
+
+/* access type characters, 'S' is not one of them because it means exit */
+static char typeChars[] = "CHRELBDFGIJKMNOPQTUWXYZ";
+
+
+/*
+ *  Data Type: Event
+ *
+ *  Description:
+ *      a car arrival or departure, kept to be written in time order
+ */
+
+typedef struct _event{
+    int time, seq;
+    int car, entrance;
+    char type;                  /* access type, 'S' for departures */
+} Event;
+
+
+/*
+ *  Data Type: Park
+ *
+ *  Description:
+ *      the park being generated, rep[p][y][x] with y = 0 at the bottom as
+ *  in mapInit
+ */
+
+typedef struct _park{
+    int N, M, P, E, S, types;
+    char ***rep;
+    int *ex, *ey;               /* entrance coordinates, floor 0 */
+    int *ax, *ay, *az;          /* access point coordinates */
+    int nSpots, nRamps;
+    int topSpots;               /* spots of the top floor */
+    int closeTop;               /* whether the top floor can be restricted */
+} Park;
+
+
+static unsigned long seed = 1;
+
+/*
+ * Auxiliary-function: randUnit
+ *
+ * Description:
+ *      returns a random number in [0, 1), linear congruential generator
+ */
+
+static double randUnit(void){
+    seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+    return (double) (seed >> 8) / 16777216.0;
+}
+
+
+static int randInt(int n){
+    return (int) (randUnit() * n);
+}
+
+
+static double randExp(double mean){
+    return -log(1.0 - randUnit()) * mean;
+}
+
+
+/* lanes every third row, the row below the top wall is always a lane */
+static int isLaneRow(Park *pk, int y){
+    return (y - 1) % 3 == 0 || y == pk->M - 2;
+}
+
+
+/* cells where spots and ramps go */
+static int isSpotCell(Park *pk, int x, int y){
+    return x >= 2 && x <= pk->N - 3 && y >= 1 && y <= pk->M - 2 &&
+                                                    !isLaneRow(pk, y);
+}
+
+
+/*
+ * Auxiliary-function: placeSide
+ *
+ * Description:
+ *      k-th position on the side walls of a floor, alternating between the
+ *  left and right walls from the top. Returns -1 if there isn't one
+ */
+
+static int placeSide(Park *pk, int k, int *x, int *y){
+    if(k / 2 >= pk->M - 2)
+        return -1;
+    *x = k % 2 == 0 ? 0 : pk->N - 1;
+    *y = pk->M - 2 - k / 2;
+    return 0;
+}
+
+
+/*
+ * Auxiliary-function: buildPark
+ *
+ * Description:
+ *      lays out every floor, the ramps, entrances and access points
+ *
+ * Return value:
+ *      0 on success, -1 if they don't fit in the park
+ */
+
+static int buildPark(Park *pk, double spotDensity, int rampsPerFloor){
+    int x, y, p, i, k, tries;
+    int *perFloor;
+
+    pk->rep = (char ***) malloc(sizeof(char **) * pk->P);
+    for(p = 0; p < pk->P; p++){
+        pk->rep[p] = (char **) malloc(sizeof(char *) * pk->M);
+        for(y = 0; y < pk->M; y++){
+            pk->rep[p][y] = (char *) malloc(sizeof(char) * pk->N);
+            for(x = 0; x < pk->N; x++){
+                if(x == 0 || y == 0 || x == pk->N - 1 || y == pk->M - 1)
+                    pk->rep[p][y][x] = '@';
+                else if(isSpotCell(pk, x, y))
+                    pk->rep[p][y][x] = '@';
+                else
+                    pk->rep[p][y][x] = ' ';
+            }
+        }
+    }
+
+    /* ramp pairs, the up ramp on a floor is the down ramp of the next one */
+    pk->nRamps = 0;
+    for(p = 0; p < pk->P - 1; p++){
+        for(i = 0; i < rampsPerFloor; i++){
+            for(tries = 0; tries < RAMPTRIES; tries++){
+                x = 2 + randInt(pk->N - 4);
+                y = 1 + randInt(pk->M - 2);
+                if(isSpotCell(pk, x, y) && pk->rep[p][y][x] == '@' &&
+                                            pk->rep[p + 1][y][x] == '@')
+                    break;
+            }
+            if(tries == RAMPTRIES){
+                fprintf(stderr, "No room for %d ramps per floor\n",
+                                                            rampsPerFloor);
+                return -1;
+            }
+            pk->rep[p][y][x] = 'u';
+            pk->rep[p + 1][y][x] = 'd';
+            pk->nRamps++;
+        }
+    }
+
+    /* the remaining spot cells are spots or walls */
+    pk->nSpots = 0;
+    pk->topSpots = 0;
+    for(p = 0; p < pk->P; p++)
+        for(y = 0; y < pk->M; y++)
+            for(x = 0; x < pk->N; x++)
+                if(isSpotCell(pk, x, y) && pk->rep[p][y][x] == '@' &&
+                                                randUnit() < spotDensity){
+                    pk->rep[p][y][x] = '.';
+                    pk->nSpots++;
+                    if(p == pk->P - 1)
+                        pk->topSpots++;
+                }
+
+    /* entrances first, then access points, on the side walls */
+    perFloor = (int *) calloc(pk->P, sizeof(int));
+    pk->ex = (int *) malloc(sizeof(int) * (pk->E + 1));
+    pk->ey = (int *) malloc(sizeof(int) * (pk->E + 1));
+    for(i = 0; i < pk->E; i++){
+        if(placeSide(pk, perFloor[0]++, &pk->ex[i], &pk->ey[i]) < 0){
+            fprintf(stderr, "No room for %d entrances\n", pk->E);
+            free(perFloor);
+            return -1;
+        }
+        pk->rep[0][pk->ey[i]][pk->ex[i]] = 'e';
+    }
+
+    pk->ax = (int *) malloc(sizeof(int) * (pk->S + 1));
+    pk->ay = (int *) malloc(sizeof(int) * (pk->S + 1));
+    pk->az = (int *) malloc(sizeof(int) * (pk->S + 1));
+    for(i = 0; i < pk->S; i++){
+        pk->az[i] = i % pk->P;
+        k = perFloor[pk->az[i]]++;
+        if(placeSide(pk, k, &pk->ax[i], &pk->ay[i]) < 0){
+            fprintf(stderr, "No room for %d access points\n", pk->S);
+            free(perFloor);
+            return -1;
+        }
+        pk->rep[pk->az[i]][pk->ay[i]][pk->ax[i]] = 'a';
+    }
+
+    /* the top floor can only be closed if every access type is still
+     * reachable on the floors below */
+    pk->closeTop = pk->P > 1;
+    for(k = 0; k < pk->types; k++){
+        for(i = k; i < pk->S; i += pk->types)
+            if(pk->az[i] < pk->P - 1)
+                break;
+        if(i >= pk->S)
+            pk->closeTop = 0;
+    }
+
+    free(perFloor);
+    return 0;
+}
+
+
+static void freePark(Park *pk){
+    int p, y;
+
+    for(p = 0; p < pk->P; p++){
+        for(y = 0; y < pk->M; y++)
+            free(pk->rep[p][y]);
+        free(pk->rep[p]);
+    }
+    free(pk->rep);
+    free(pk->ex);
+    free(pk->ey);
+    free(pk->ax);
+    free(pk->ay);
+    free(pk->az);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: writeConfig
+ *
+ * Description:
+ *      writes the park configuration file, floors from the top row down
+ */
+
+static int writeConfig(Park *pk, char *filename){
+    FILE *fp;
+    int x, y, p, i;
+
+    fp = fopen(filename, "w");
+    if(fp == NULL){
+        fprintf(stderr, "Error opening file %s\n", filename);
+        return -1;
+    }
+
+    fprintf(fp, "%d %d %d %d %d\n", pk->N, pk->M, pk->P, pk->E, pk->S);
+    for(p = 0; p < pk->P; p++){
+        for(y = pk->M - 1; y >= 0; y--){
+            for(x = 0; x < pk->N; x++)
+                fputc(pk->rep[p][y][x], fp);
+            fputc('\n', fp);
+        }
+        if(p == 0)
+            for(i = 0; i < pk->E; i++)
+                fprintf(fp, "E%d %d %d 0 -\n", i, pk->ex[i], pk->ey[i]);
+        for(i = 0; i < pk->S; i++)
+            if(pk->az[i] == p)
+                fprintf(fp, "A%d %d %d %d %c\n", i, pk->ax[i], pk->ay[i], p,
+                                            typeChars[i % pk->types]);
+        fprintf(fp, "+\n");
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+
+static int compareEvent(const void *a, const void *b){
+    Event *x = (Event *) a, *y = (Event *) b;
+
+    if(x->time != y->time)
+        return x->time - y->time;
+    return x->seq - y->seq;
+}
+
+
+/*
+ * Auxiliary-function: heapPush, heapPop
+ *
+ * Description:
+ *      min-heap of the departure times of the cars in the park
+ */
+
+static void heapPush(int *heap, int *n, int v){
+    int i = (*n)++, aux;
+
+    heap[i] = v;
+    while(i > 0 && heap[(i - 1) / 2] > heap[i]){
+        aux = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = aux;
+        i = (i - 1) / 2;
+    }
+    return;
+}
+
+
+static int heapPop(int *heap, int *n){
+    int top = heap[0], i = 0, c, aux;
+
+    heap[0] = heap[--(*n)];
+    while( (c = 2 * i + 1) < *n){
+        if(c + 1 < *n && heap[c + 1] < heap[c])
+            c++;
+        if(heap[i] <= heap[c])
+            break;
+        aux = heap[i];
+        heap[i] = heap[c];
+        heap[c] = aux;
+        i = c;
+    }
+    return top;
+}
+
+
+/*
+ * Auxiliary-function: writeInput
+ *
+ * Description:
+ *      writes the car input file, an arrival and a departure per car, with
+ *  at most capacity cars in the park at any time
+ *
+ * Return value:
+ *      time of the last event, -1 on error
+ */
+
+static int writeInput(Park *pk, char *filename, int cars, double rate,
+                                                double dwell, int capacity){
+    FILE *fp;
+    Event *ev;
+    double t = 0;
+    int *heap, inPark = 0;
+    int i, n = 0, stay, arrival, last = 0;
+
+    fp = fopen(filename, "w");
+    if(fp == NULL){
+        fprintf(stderr, "Error opening file %s\n", filename);
+        return -1;
+    }
+
+    ev = (Event *) malloc(sizeof(Event) * (2 * cars + 1));
+    heap = (int *) malloc(sizeof(int) * (cars + 1));
+    for(i = 0; i < cars; i++){
+        t += randExp(1.0 / rate);
+        arrival = (int) t;
+
+        /* departures of the same instant come first, they were made before */
+        while(inPark > 0 && heap[0] <= arrival)
+            heapPop(heap, &inPark);
+        if(inPark == capacity){
+            arrival = heapPop(heap, &inPark);
+            t = arrival;
+        }
+
+        ev[n].time = arrival;
+        ev[n].seq = n;
+        ev[n].car = i;
+        ev[n].entrance = randInt(pk->E);
+        ev[n].type = typeChars[randInt(pk->types)];
+        n++;
+
+        stay = (int) (randExp(dwell) + 0.5);
+        ev[n].time = arrival + (stay < 1 ? 1 : stay);
+        ev[n].seq = n;
+        ev[n].car = i;
+        ev[n].type = 'S';
+        heapPush(heap, &inPark, ev[n].time);
+        if(ev[n].time > last)
+            last = ev[n].time;
+        n++;
+    }
+    qsort(ev, n, sizeof(Event), compareEvent);
+
+    for(i = 0; i < n; i++){
+        if(ev[i].type == 'S')
+            fprintf(fp, "V%06d %d S\n", ev[i].car, ev[i].time);
+        else
+            fprintf(fp, "V%06d %d %c %d %d 0\n", ev[i].car, ev[i].time,
+                ev[i].type, pk->ex[ev[i].entrance], pk->ey[ev[i].entrance]);
+    }
+
+    free(heap);
+    free(ev);
+    fclose(fp);
+    return last;
+}
+
+
+/*
+ * Auxiliary-function: writeRestrictions
+ *
+ * Description:
+ *      writes the restriction file until the given time, one in four
+ *  restrictions is of the top floor and the others of a single spot
+ */
+
+static int writeRestrictions(Park *pk, char *filename, double rate,
+                                                double length, int until){
+    FILE *fp;
+    double t = 0;
+    int ta, tb, x, y, p, tries;
+
+    fp = fopen(filename, "w");
+    if(fp == NULL){
+        fprintf(stderr, "Error opening file %s\n", filename);
+        return -1;
+    }
+
+    while(1){
+        t += randExp(1.0 / rate);
+        ta = (int) t;
+        if(ta > until)
+            break;
+        tb = ta + 1 + (int) randExp(length);
+
+        if(pk->closeTop && randInt(4) == 0)
+            fprintf(fp, "R %d %d %d\n", ta, tb, pk->P - 1);
+        else{
+            p = randInt(pk->P);
+            for(tries = 0; tries < RAMPTRIES; tries++){
+                x = 2 + randInt(pk->N - 4);
+                y = 1 + randInt(pk->M - 2);
+                if(pk->rep[p][y][x] == '.')
+                    break;
+            }
+            if(tries < RAMPTRIES)
+                fprintf(fp, "R %d %d %d %d %d\n", ta, tb, x, y, p);
+        }
+        /* the next one only starts after this one is lifted */
+        t = tb;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+
+static void usage(char *prog){
+    fprintf(stderr, "Usage: %s <name> <N> <M> <P> [-s spots] [-r ramps] "
+            "[-e entrances] [-a accesses] [-t types] [-c cars] [-l rate] "
+            "[-d dwell] [-R rate] [-L length] [-x seed]\n", prog);
+    exit(1);
+}
+
+
+int main(int argc, char *argv[]){
+    Park pk;
+    char filename[NAMESIZE];
+    double spotDensity = 0.8, rate = 1.0, dwell = 100, resRate = 0;
+    double resLength = 50;
+    int ramps = 2, cars = 1000, capacity, last, i;
+
+    if(argc < 5 || strlen(argv[1]) + 5 > NAMESIZE)
+        usage(argv[0]);
+
+    pk.N = atoi(argv[2]);
+    pk.M = atoi(argv[3]);
+    pk.P = atoi(argv[4]);
+    pk.E = 2;
+    pk.S = pk.P > 2 ? pk.P : 2;
+    pk.types = 2;
+
+    for(i = 5; i < argc; i++){
+        if(argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' ||
+                                                            i + 1 == argc)
+            usage(argv[0]);
+        switch(argv[i][1]){
+            case 's': spotDensity = atof(argv[++i]); break;
+            case 'r': ramps = atoi(argv[++i]); break;
+            case 'e': pk.E = atoi(argv[++i]); break;
+            case 'a': pk.S = atoi(argv[++i]); break;
+            case 't': pk.types = atoi(argv[++i]); break;
+            case 'c': cars = atoi(argv[++i]); break;
+            case 'l': rate = atof(argv[++i]); break;
+            case 'd': dwell = atof(argv[++i]); break;
+            case 'R': resRate = atof(argv[++i]); break;
+            case 'L': resLength = atof(argv[++i]); break;
+            case 'x': seed = strtoul(argv[++i], NULL, 10); break;
+            default: usage(argv[0]);
+        }
+    }
+
+    if(pk.N < 5 || pk.M < 5 || pk.P < 1 || pk.E < 1 || pk.S < 1 ||
+            pk.types < 1 || pk.types > (int) strlen(typeChars) ||
+            pk.types > pk.S || ramps < 1 || cars < 0 || rate <= 0 ||
+            dwell < 0 || resRate < 0 || resLength < 0){
+        fprintf(stderr, "Invalid park or workload parameters\n");
+        usage(argv[0]);
+    }
+
+    if(buildPark(&pk, spotDensity, ramps) < 0)
+        exit(2);
+
+    /* spots left when the biggest possible restriction is on */
+    capacity = pk.nSpots;
+    if(resRate > 0)
+        capacity -= pk.closeTop ? pk.topSpots : 1;
+    if(capacity < 1){
+        fprintf(stderr, "Not enough spots for cars to park\n");
+        exit(2);
+    }
+
+    sprintf(filename, "%s.cfg", argv[1]);
+    if(writeConfig(&pk, filename) < 0)
+        exit(2);
+    sprintf(filename, "%s.inp", argv[1]);
+    last = writeInput(&pk, filename, cars, rate, dwell, capacity);
+    if(last < 0)
+        exit(2);
+    if(resRate > 0){
+        sprintf(filename, "%s.res", argv[1]);
+        if(writeRestrictions(&pk, filename, resRate, resLength, last) < 0)
+            exit(2);
+    }
+
+    printf("%dx%dx%d park: %d spots, %d ramps, %d entrances, "
+            "%d access points of %d types\n", pk.N, pk.M, pk.P, pk.nSpots,
+            pk.nRamps, pk.E, pk.S, pk.types);
+
+    freePark(&pk);
+    exit(0);
+}
@@ -3,7 +3,7 @@
  *
  *  Description: AED Project main program
  *
- *               Using parkmap.c module as a main resource, the program's function 
+ *               Using parkmap.c module as a main resource, the program's function
  *          is to read inputs and automatically route cars entering a parking lot
  *          according to their ideal paths.
  *
@@ -14,21 +14,33 @@
  *              <restriction file> (optional) - contains information about
  *          applied restrictions.
  *
+ *          In online mode (-l) only the configuration file is required, the
+ *          car and restriction lines are read from the standard input (or a
+ *          named pipe) as they happen and the result of each one is written
+ *          to the standard output right away
+ *
+ *          The routing engine is chosen with -e (see engine.h), to compare
+ *          engines on the same inputs (the online mode uses the incremental
+ *          one unless told otherwise), and the admission policy of the
+ *          waiting cars with -a (see dispatch.h). With -j, threads make the
+ *          rankings of spots of the grouped and ranked admissions ahead of
+ *          time (see lookahead.h)
+ *
  *          This program mainly serves as a demonstration of the parkmap.c
  *          module efficiency and quality
  *
  *  Implementation details:
  *      The input and restriction files are read and listed in increasing time
- *  order and then they are applied one by one by using the required functions
- *  from parkmap
- *      For implementation purposes it was created a struct order which just
- *  contains any important information for each action to take
+ *  order and then they are applied one by one by the dispatch module, which
+ *  uses the required functions from parkmap (see scenario.c)
  *
  *  Non standard interface dependencies:
  *      parkmap.h - main program module
- *      LinkedList.h - list ADT
- *      escreve_saida.h - writing to output auxiliary module
- *      queue.h - first in first out queue ADT implementation
+ *      orders.h - Order data type and input file loaders
+ *      dispatch.h - applies orders to the park
+ *      timing.h - monotonic clock
+ *      scenario.h - runs a whole scenario from its files
+ *      engine.h - routing engines
  *
  *  Version: 1.0
  *
@@ -36,494 +48,367 @@
  *
  */
 
+/* poll, read and open are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
 
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<poll.h>
 
 #include"parkmap.h"
-#include"LinkedList.h"
-#include"escreve_saida.h"
-#include"queue.h"
+#include"orders.h"
+#include"dispatch.h"
+#include"timing.h"
+#include"scenario.h"
+#include"engine.h"
+
+
+/* engine of the online mode unless another is given with -e: it keeps a
+ * search tree per entrance between events instead of searching the whole
+ * park for each car (see the README for the latencies measured) */
+#define ONLINEENGINE "incremental"
+
+/* size of the online mode read buffer and of the longest accepted line */
+#define READSIZE 4096
+#define LINESIZE 256
 
 
 /*
- *  Data Type: Order
+ *  Data Type: LineReader
  *
- *  Fields:
- *      char type - descriptor character of an associated type to the order
- *      char action - descriptor character of the action to take
- *          Example:
- *              a new car coming into the park would have an action descriptor
- *          'E' while one leaving would have an action descriptor 'C'
- *      int x, y, z - respective 3D coordinates
- *      char *id - string identifier (used to identify vehicles)
+ *  Description:
+ *      buffered line reader over a file descriptor. Unlike stdio it lets us
+ *  know whether another line is available without blocking
  */
 
-typedef struct _order{
-    /* char type - describes type of order:
-     * R is restrict, r is unrestrict
-     * s indicates car is leaving using ID
-     * S indicates car is leaving using coordinates
-     * every other character indicates desired access point
-     */
-    char type;               
-    char action;
-    int x, y, z;                  /* coordinates associated with new order */
-    int time;
-    char *id;                   
-} Order;
+typedef struct _lineReader{
+    int fd;
+    char buf[READSIZE];
+    int start, end;           /* unread characters are buf[start..end[ */
+} LineReader;
 
 
 /*
- *  Function: OrderDestroy
- *
- *  Description:
- *      frees all memory previously allocated in struct Order
+ * Auxiliary-function: readerHasInput
  *
- *  Purpose:
- *      to send as pointer to freeLinkedList function in order to free the 
- *  order's list
+ * Description:
+ *      returns 1 if reading the next line won't block (it's buffered, or the
+ *  descriptor has data or is at end of file), 0 otherwise
  */
 
-void OrderDestroy(Item order){
-    if( order == NULL)
-        return;
-    if(((Order *) order)->id != NULL)
-        free(((Order *)order)->id);
-    free( ((Order *) order));
-    return;
+static int readerHasInput(LineReader *r){
+    struct pollfd pfd;
+
+    if(memchr(r->buf + r->start, '\n', r->end - r->start) != NULL)
+        return 1;
+
+    pfd.fd = r->fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if(poll(&pfd, 1, 0) > 0)
+        return 1;
+    return 0;
 }
-    
+
 
 /*
- * Function: loadInstructionFile
+ * Auxiliary-function: readerGetLine
  *
  * Description:
- *      loads instructions given in the .inp file and lists them in reverse order
- *  using struct Order in a LinkedList
+ *      reads the next line (without the newline) into line, blocking until
+ *  it is complete. Lines longer than size are truncated
+ *
+ * Return value:
+ *      1 if a line was read, 0 at end of input
  */
 
-LinkedList *loadInstructionFile(char *inpfile){
-    FILE *fp;
-    char buffer[256];
-    int time, x, y, z;
-    char type;
-    char auxChar;
-    int inpRead;
-    Order *order;
-    LinkedList *t;
-
-    t = initLinkedList();
-
-    fp = fopen(inpfile, "r");
-    if(fp == NULL){
-        fprintf(stderr, "Couldn't open instruction file %s\n", inpfile);
-        return NULL;
-    }
-
-    buffer[0] = '\0';
-
-    auxChar = (char) fgetc(fp);
-    while(auxChar != EOF){
-        if(auxChar == 'V'){
-            ungetc(auxChar, fp);
-            inpRead = fscanf(fp, "%s %d %c %d %d %d", buffer, &time, &type,
-                                                      &x, &y, &z);
-            if(inpRead == 6){
-                order = (Order *) malloc(sizeof(Order));
-                if(type == 'S'){
-                    order->action = 'S';
-                    order->type = ' ';
-                    order->time = time;
-                    order->x = x; order->y = y; order->z = z;
-                    order->id = (char *) malloc(sizeof(char) * (strlen(buffer) + 1));
-                    strcpy(order->id, buffer);
-                    buffer[0] = '\0';
-
-                    t = insertUnsortedLinkedList(t, (Item) order);
-                }
-                else{
-                    order->type = type;
-                    order->action = 'E';
-                    order->time = time;
-                    order->x = x; order->y = y; order->z = z;
-                    order->id = (char *) malloc(sizeof(char) * (strlen(buffer) + 1));
-                    strcpy(order->id, buffer);
-                    buffer[0] = '\0';
-
-                    t = insertUnsortedLinkedList(t, (Item) order);
-                }
-            } else if(inpRead == 3){
-                order = (Order *) malloc(sizeof(Order));
-                order->action = 's';
-                order->type = ' ';
-                order->time = time;
-                order->id = (char *) malloc(sizeof(char) * (strlen(buffer) + 1));
-                strcpy(order->id, buffer);
-                buffer[0] = '\0';
-                order->x = -1; order->y = -1; order->z = -1;
-                t = insertUnsortedLinkedList(t, (Item) order);
-            } else{
-                break;
-            }
+static int readerGetLine(LineReader *r, char *line, int size){
+    char *nl;
+    int n, len;
+
+    while(1){
+        nl = (char *) memchr(r->buf + r->start, '\n', r->end - r->start);
+        if(nl != NULL || r->end - r->start == READSIZE)
+            break;
+
+        /* move what's left to the start of the buffer and read more */
+        memmove(r->buf, r->buf + r->start, r->end - r->start);
+        r->end -= r->start;
+        r->start = 0;
+        n = read(r->fd, r->buf + r->end, READSIZE - r->end);
+        if(n <= 0){
+            if(r->end == 0)
+                return 0;
+            break;             /* last line without newline */
         }
-        auxChar = (char) fgetc(fp);
+        r->end += n;
     }
-    fclose(fp);
 
-    return t;
+    len = (nl != NULL ? nl : r->buf + r->end) - (r->buf + r->start);
+    n = len < size - 1 ? len : size - 1;
+    memcpy(line, r->buf + r->start, n);
+    line[n] = '\0';
+
+    r->start += len;
+    if(nl != NULL)
+        r->start++;
+    return 1;
 }
 
 
-/* 
- * Function: loadRestrictionFile
+/*
+ *  Data Type: OnlineLatency
  *
- * Description:
- *       similarly to loadInstructionFile function it lists the restrictions 
- *  given by the input file in reverse order using the Order data type
+ *  Description:
+ *      latency of the events of the online mode. An event whose admissions
+ *  are held until the end of its instant is only done when they are written,
+ *  so its start is kept in deferred until then
  */
 
-LinkedList *loadRestrictionFile(char *resfile){
-    FILE *fp;
-    int ta, tb, x, y, z;
-    int inpRead;
-    char R, auxChar;
-    Order *order;
-    LinkedList *t;
+typedef struct _onlineLatency{
+    double sum, max;
+    int n, nSlow;
+    double *deferred;         /* starts of the events still waiting */
+    int nDeferred, maxDeferred;
+    int deferredTime;         /* instant they are waiting for */
+    int nLate;                /* events which had to wait */
+} OnlineLatency;
 
-    t = initLinkedList();
 
-    fp = fopen(resfile, "r");
-    if(fp == NULL){
-        fprintf(stderr, "Couldn't open restrictions file %s\n", resfile);
-        return NULL;
-    }
+/*
+ * Auxiliary-function: latencyDone
+ *
+ * Description:
+ *      counts an event read at t0 whose output was all written at t1
+ */
 
-    /* go through restriction file and list them in reverse order */
-    auxChar = (char) fgetc(fp);
-    while(auxChar != EOF){
-        if(auxChar == 'R'){
-            ungetc(auxChar, fp);
-            inpRead = fscanf(fp, "%c %d %d %d %d %d\n", &R, &ta, &tb,
-                                                      &x, &y, &z);
-            if(inpRead == 6){
-                order = (Order *) malloc(sizeof(Order));
-                order->action = 'R';
-                order->type = ' ';
-                order->time = ta;
-                order->id = NULL;
-                order->x = x; order->y = y; order->z = z;
-                t = insertUnsortedLinkedList(t, (Item) order);
-
-                if(tb >= ta){
-                    order = (Order *) malloc(sizeof(Order));
-                    order->action = 'r';
-                    order->type = ' ';
-                    order->time = tb;
-                    order->id = NULL;
-                    order->x = x; order->y = y; order->z = z;
-                    t = insertUnsortedLinkedList(t, (Item) order);
-                }
-            } else if(inpRead == 4){   /* if it's a floor type restriction */
-                order = (Order *) malloc(sizeof(Order));
-                order->action = 'P';
-                order->type = ' ';
-                order->time = ta;
-                order->z = x;             /* x contains floor */
-                order->x = -1; order->y = -1;
-                order->id = NULL;
-
-                t = insertUnsortedLinkedList(t, (Item) order);
-                if(tb >= ta){
-                    order = (Order *) malloc(sizeof(Order));
-                    order->action = 'p';
-                    order->type = ' ';
-                    order->time = tb;
-                    order->z = x;        /* x contains floor */
-                    order->x = -1;
-                    order->y = -1;
-                    order->id = NULL;
-                    t = insertUnsortedLinkedList(t, (Item) order);
-                }
-            } else{
-                break;
-            }
-        }
-        auxChar = (char) fgetc(fp);
-    }
-    fclose(fp);
+static void latencyDone(OnlineLatency *L, double t0, double t1){
+    double lat = (t1 - t0) * 1e6;
 
-    return t;
+    L->sum += lat;
+    if(lat > L->max)
+        L->max = lat;
+    if(lat > 1000.0)
+        L->nSlow++;
+    L->n++;
+    return;
 }
 
+
 /*
- * Auxiliary-function: compareOrderTime
+ * Auxiliary-function: latencyDefer
  *
  * Description:
- *      compares times fields in 2 orders given as void * arguments
- *
- * Purpose: 
- *      used in inpresShuffleOrder Function ahead in a way to merge 2 lists 
- *  in reverse order
+ *      keeps the start of an event of instant time whose admissions are
+ *  still held
  */
-int compareOrderTime(Item order1, Item order2){
-    if( ((Order *) order1)->time <= ((Order *) order2)->time)
-        return 1;
-    else
-        return 0;
+
+static void latencyDefer(OnlineLatency *L, double t0, int time){
+    if(L->nDeferred == L->maxDeferred){
+        L->maxDeferred = L->maxDeferred == 0 ? 16 : 2 * L->maxDeferred;
+        L->deferred = (double *) realloc(L->deferred,
+                                        sizeof(double) * L->maxDeferred);
+    }
+    L->deferred[L->nDeferred++] = t0;
+    L->deferredTime = time;
+    L->nLate++;
+    return;
 }
 
 
 /*
- * Function: inpresShuffleOrder
+ * Auxiliary-function: latencySettle
  *
  * Description:
- *      merges 2 ordered lists of Orders Data Type into one list in reverse
- *  order
+ *      the held admissions were written at t1, which ends every deferred
+ *  event
+ */
+
+static void latencySettle(OnlineLatency *L, double t1){
+    int i;
+
+    for(i = 0; i < L->nDeferred; i++)
+        latencyDone(L, L->deferred[i], t1);
+    L->nDeferred = 0;
+    return;
+}
+
+
+/*
+ * Function: runOnline
  *
- * Purpose:
- *      to merge a reverse order Restriction list and a reverse order 
- *  Instruction list into a time increasing ordered list of both
+ * Description:
+ *      online mode. Orders are read one line at a time from the events
+ *  descriptor and applied as soon as they are read, flushing the output
+ *  after each one. Admissions held until the end of an instant are run as
+ *  soon as there is no more input ready to read.
  *
- *      Note: since lists are given in reverse order, the reverse of the
- *  reverse is the original order, which we wish to maintain
+ *      At the end, the latency between reading a line and having written its
+ *  result is reported to stderr. For a line whose admissions are held, that
+ *  is when they are written, by the flush or by a line of a later instant
  */
 
-LinkedList *inpresShuffleOrder(LinkedList *inpList, LinkedList *resList){
-    return mergeOrderedLists(inpList, resList, compareOrderTime);
-}
+static int runOnline(Map *parkMap, int fd){
+    LineReader in;
+    char line[LINESIZE];
+    Dispatcher *D;
+    Order *o, *lift;
+    OnlineLatency L;
+    double t0, t1;
+    int time;
 
+    in.fd = fd;
+    in.start = in.end = 0;
+    memset(&L, 0, sizeof(L));
 
-int main(int argc, char* argv[]) {
-    Map *parkMap;
-    LinkedList *inp, *res, *orders;
-    LinkedList *t, *testT;
-    int time, stSize;
-    Order *o, *testO;
-    int cost, *st;
-    FILE *fp;
-    char *ptsfilename;
-    Queue *Q;
-    
-    if(argc < 3) {
-        fprintf(stderr, "Usage: %s <park.cfg> <park.inp> [park.res]\n", argv[0]);
-        exit(1);
+    D = Dinit(parkMap, stdout, OrderDestroy);
+
+    while(1){
+        /* nothing else of this instant is coming yet, admit waiting cars */
+        if(DhasPending(D) && readerHasInput(&in) == 0){
+            Dflush(D);
+            fflush(stdout);
+            latencySettle(&L, Tnow());
+        }
+
+        if(readerGetLine(&in, line, LINESIZE) == 0)
+            break;
+
+        t0 = Tnow();
+        if(parseOrderLine(line, &o, &lift) == 0)
+            continue;
+
+        time = o->time;
+        DapplyOrder(D, o);
+        /* restriction lines carry their own lifting time */
+        if(lift != NULL)
+            DscheduleOrder(D, lift);
+        fflush(stdout);
+        t1 = Tnow();
+
+        /* a later instant closed the one the deferred events wait for */
+        if(L.nDeferred > 0 && time != L.deferredTime)
+            latencySettle(&L, t1);
+        if(DhasPending(D))
+            latencyDefer(&L, t0, time);
+        else
+            latencyDone(&L, t0, t1);
     }
 
-    parkMap = mapInit(argv[1]);
-    if(parkMap == NULL){
-        fprintf(stderr, "Error producing the park Map structure\n");
-        return 2;
+    /* lifts after the last order still happen */
+    Dfinish(D);
+    fflush(stdout);
+    latencySettle(&L, Tnow());
+
+    fprintf(stderr, "%d events, latency mean %.1f us, max %.1f us, "
+                    "%d over 1 ms, %d waited for their instant to end\n",
+                    L.n, L.n > 0 ? L.sum / L.n : 0.0, L.max, L.nSlow,
+                    L.nLate);
+    DprintLatency(D, stderr, "online");
+#ifdef PATHSTATS
+    {
+        PathStats total;
+        int nQueries = DpathStats(D, &total);
+
+        PSprint(stderr, &total, nQueries);
     }
-    buildGraphs(parkMap);
+#endif
+
+    Ddestroy(D);
+    free(L.deferred);
+    return 0;
+}
 
-    /* load instruction file into Orders reverse ordered list */
-    inp = loadInstructionFile(argv[2]);
-    t = inp;
 
-   /* if restriction file is presented */
-    if(argc == 4){
-        /* load restriction file into Orders reverse ordered list */
-        res = loadRestrictionFile(argv[3]);
-        t = res;
+static void usage(char *prog){
+    int i;
+
+    fprintf(stderr, "Usage: %s [-e engine] [-a admission] [-j threads] "
+                            "<park.cfg> <park.inp> [park.res]\n", prog);
+    fprintf(stderr, "       %s [-e engine] [-a admission] -l <park.cfg> "
+                                                    "[events]\n", prog);
+    fprintf(stderr, "engines:");
+    for(i = 0; Ename(i) != NULL; i++)
+        fprintf(stderr, " %s", Ename(i));
+    fprintf(stderr, " (default %s, %s with -l)\n", Edefault(), ONLINEENGINE);
+    fprintf(stderr, "admissions:");
+    for(i = 0; Dadmission(i) != NULL; i++)
+        fprintf(stderr, " %s", Dadmission(i));
+    fprintf(stderr, " (default %s)\n", Dadmission(0));
+    exit(1);
+}
+
+
+int main(int argc, char* argv[]) {
+    Map *parkMap;
+    char *prog = argv[0];
+    int online = 0, engineGiven = 0, fd, ret;
+
+    while(argc > 1 && argv[1][0] == '-' && argv[1][1] != '\0'){
+        if(strcmp(argv[1], "-l") == 0)
+            online = 1;
+        else if(strcmp(argv[1], "-e") == 0 && argc > 2){
+            /* every Map made from now on uses this engine */
+            if(EsetDefault(argv[2]) == 0){
+                fprintf(stderr, "Unknown engine %s\n", argv[2]);
+                usage(prog);
+            }
+            engineGiven = 1;
+            argv++;
+            argc--;
+        } else if(strcmp(argv[1], "-a") == 0 && argc > 2){
+            /* and every dispatcher this admission policy */
+            if(DsetAdmission(argv[2]) == 0){
+                fprintf(stderr, "Unknown admission %s\n", argv[2]);
+                usage(prog);
+            }
+            argv++;
+            argc--;
+        } else if(strcmp(argv[1], "-j") == 0 && argc > 2){
+            /* and every scenario this many lookahead threads */
+            setLookahead(atoi(argv[2]));
+            argv++;
+            argc--;
+        } else
+            usage(prog);
+        argv++;
+        argc--;
     }
-    else
-        res = initLinkedList();
-
-    /* if there is restriction file, both lists will be merged in a ordered
-     * list according to time of execution
-     *
-     * else, if there is no restriction file this instruction will simply 
-     * reverse the order in the inp list
-     *
-     * caution: inpresShuffleOrder frees both input lists
-     */
-    orders = inpresShuffleOrder(res, inp);
-    t = orders;
-
-    /* generate output file name */
-    ptsfilename = (char *) malloc(sizeof(char) * (strlen(argv[1]) + 1));
-    strncpy(ptsfilename, argv[1], (strlen(argv[1]) - 4));
-    ptsfilename[strlen(argv[1]) - 4] = '\0';
-    strcat(ptsfilename, ".pts");
-
-    fp = fopen(ptsfilename, "w");
-    
-    /* initialize car queue */
-    Q = Qinit();
-    t = orders;
-    while(t != NULL){
-        o = (Order *) getItemLinkedList(t);
-        switch (o->action){
-            case 'E':
-                if( (isQueueEmpty(Q) == 1) && (isParkFull(parkMap) == 0) ){
-                    st = findPath(parkMap, o->id, o->x, o->y, o->z, o->type, 
-                                                            &cost, &stSize);
-                    if(st == NULL){
-                        escreve_saida(fp, o->id, o->time, o->x, o->y, o->z, 'i');
-                        Qpush(Q, (Item) o);
-                    }
-                    else{
-                        writeOutput(fp, parkMap, st, cost, o->time, o->id, 
-                                                            o->type, stSize);
-                    }
-                }
-                else{
-                    escreve_saida(fp, o->id, o->time, o->x, o->y, o->z, 'i');
-                    Qpush(Q, (Item) o);
-                }
-                break;
-            case 'S':
-                /* freeSpot */
-                clearSpotCoordinates(parkMap, o->x, o->y, o->z);
-                escreve_saida(fp, o->id, o->time, o->x, o->y, o->z, 's');
-
-                /* check if there are any map restrictions/unrestrictions ahead */
-                testT = getNextNodeLinkedList(t);
-                if(testT != NULL){
-                    testO = (Order *) getItemLinkedList(testT);
-                    if( strchr("RrPpSs", (int) testO->action) != NULL){
-                        /* if they are applied at the same time */
-                        if( testO->time == o->time){
-                            t = getNextNodeLinkedList(t);
-                            /* go to next node */
-                            continue;
-                        }
-                    }
-
-                }
-                
-                /* if this is the last unrestriction for this exact time */
-                if( (isQueueEmpty(Q) == 0) && (isParkFull(parkMap) == 0) ){
-                    time = o->time;   /* to update order time */
-                    o = (Order *) Qpop(Q);
-                    st = findPath(parkMap, o->id, o->x, o->y, o->z, o->type, &cost, &stSize);
-                    if(st == NULL)
-                        QpushFirst(Q, (Item) o);
-                    else{
-                        cost += time - o->time;
-                        writeOutputAfterIn(fp, parkMap, st, cost, time, o->id, 
-                                                    o->type, o->time, stSize);
-                    }
-                }
-                break;
-            case 's':
-                /* free spot of car with ID */
-                clearSpotIDandWrite(fp, parkMap, o->id, o->time);
-
-                /* check if there are any map restrictions/unrestrictions ahead */
-                testT = getNextNodeLinkedList(t);
-                if(testT != NULL){
-                    testO = (Order *) getItemLinkedList(testT);
-                    if( strchr("RrPpSs", (int) testO->action) != NULL){
-                        /* if they are applied at the same time */
-                        if( testO->time == o->time){
-                            t = getNextNodeLinkedList(t);
-                            /* go to next node */
-                            continue;
-                        }
-                    }
-
-                }
-
-                if( (isQueueEmpty(Q) == 0) && (isParkFull(parkMap) == 0) ){
-                    time = o->time;   /* to update order time */
-                    o = (Order *) Qpop(Q);
-                    st = findPath(parkMap, o->id, o->x, o->y, o->z, o->type, &cost, &stSize);
-                    if(st == NULL)
-                        QpushFirst(Q, (Item) o);
-                    else{
-                        cost += time - o->time;
-                        writeOutputAfterIn(fp, parkMap, st, cost, time, o->id, 
-                                                    o->type, o->time, stSize);
-                    }
-                }
-                break;
-            case 'R':
-                restrictMapCoordinate(parkMap, o->x, o->y, o->z);
-                break;
-            case 'r':
-                freeRestrictionMapCoordinate(parkMap, o->x, o->y, o->z);
-
-                /* check if there are any map restrictions/unrestrictions ahead */
-                testT = getNextNodeLinkedList(t);
-                if(testT != NULL){
-                    testO = (Order *) getItemLinkedList(testT);
-                    if( strchr("RrPpSs", (int) testO->action) != NULL){
-                        /* if they are applied at the same time */
-                        if( testO->time == o->time){
-                            t = getNextNodeLinkedList(t);
-                            /* go to next node */
-                            continue;
-                        }
-                    }
-
-                }
-
-                while( (isQueueEmpty(Q) == 0) && (isParkFull(parkMap) == 0) ){
-                    time = o->time;   /* to update order time */
-                    o = (Order *) Qpop(Q);
-                    st = findPath(parkMap, o->id, o->x, o->y, o->z, o->type, &cost, &stSize);
-                    if(st == NULL){
-                        QpushFirst(Q, (Item) o);
-                        break;
-                    }
-                    else{
-                        cost += time - o->time; /* add additional cost for waiting */
-                        writeOutputAfterIn(fp, parkMap, st, cost, time, o->id, 
-                                                    o->type, o->time, stSize);
-                    }
-                }
-                break;
-            case 'P':
-                restrictMapFloor(parkMap, o->z);
-                break;
-            case 'p':
-                freeRestrictionMapFloor(parkMap, o->z);
-
-                /* check if there are any map restrictions/unrestrictions ahead */
-                testT = getNextNodeLinkedList(t);
-                if(testT != NULL){
-                    testO = (Order *) getItemLinkedList(testT);
-                    if( strchr("RrPpSs", (int) testO->action) != NULL){
-                        /* if they are applied at the same time */
-                        if( testO->time == o->time){
-                            t = getNextNodeLinkedList(t);
-                            /* go to next node */
-                            continue;
-                        }
-                    }
-
-                }
-
-                while( (isQueueEmpty(Q) == 0) && (isParkFull(parkMap) == 0) ){
-                    time = o->time;   /* to update order time */
-                    o = (Order *) Qpop(Q);
-                    st = findPath(parkMap, o->id, o->x, o->y, o->z, o->type, &cost, &stSize);
-                    if(st == NULL){
-                        QpushFirst(Q, (Item) o);
-                        break;
-                    }
-                    else{
-                        cost += time - o->time;
-                        writeOutputAfterIn(fp, parkMap, st, cost, time, o->id, 
-                                                    o->type, o->time, stSize);
-                    }
-                }
-                break;
-            default:
-                fprintf(stderr, "Unknown order action %c\n", o->action);
-                break;
+
+    if(argc < 3 - online)
+        usage(prog);
+
+    if(online){
+        if(engineGiven == 0)
+            EsetDefault(ONLINEENGINE);
+        parkMap = mapInit(argv[1]);
+        if(parkMap == NULL){
+            fprintf(stderr, "Error producing the park Map structure\n");
+            return 2;
+        }
+        buildGraphs(parkMap);
+
+        /* read events from the given file or pipe, standard input if none */
+        fd = STDIN_FILENO;
+        if(argc == 3 && strcmp(argv[2], "-") != 0){
+            fd = open(argv[2], O_RDONLY);
+            if(fd < 0){
+                fprintf(stderr, "Couldn't open events file %s\n", argv[2]);
+                mapDestroy(parkMap);
+                return 2;
+            }
         }
-        t = getNextNodeLinkedList(t);
+        ret = runOnline(parkMap, fd);
+        if(fd != STDIN_FILENO)
+            close(fd);
+        mapDestroy(parkMap);
+        exit(ret);
     }
-    
-    Qdestroy(Q);
-    fclose(fp);
-    free(ptsfilename);
-    freeLinkedList(orders, OrderDestroy);
-    mapDestroy(parkMap);
-
-    exit(0);
+
+    /* the whole scenario runs with a park of its own */
+    ret = runScenario(argv[1], argv[2], argc == 4 ? argv[3] : NULL, NULL);
+    exit(ret);
 }
@@ -20,13 +20,34 @@ struct _edge{
     int value;
 };
 
+/* bit sets, in words of unsigned long */
+#define WORDBITS ((int) (8 * sizeof(unsigned long)))
+#define WORDS(n) (((n) + WORDBITS - 1) / WORDBITS)
+#define TESTBIT(set, i) (((set)[(i) / WORDBITS] >> ((i) % WORDBITS)) & 1UL)
+#define SETBIT(set, i) ((set)[(i) / WORDBITS] |= 1UL << ((i) % WORDBITS))
+#define CLEARBIT(set, i) ((set)[(i) / WORDBITS] &= ~(1UL << ((i) % WORDBITS)))
+
 struct _graphL{
     int nodes;              /* number of total nodes in a graph */
     LinkedList **adjL;      /* ajacency list representation of a graph */
-    int *active;            /* node indexed table - 1 represents active
+    unsigned long *active;  /* node indexed bit set - 1 represents active
                                and 0 an inactive node */
+    unsigned long *linked;  /* node indexed bit set - 1 if the node is also
+                               inactive while its floor is */
+    unsigned long *floorActive; /* floor indexed bit set */
+    int floorSize;          /* nodes of a floor in a layer (0 if no floors) */
+    int layerSize;          /* nodes of a layer, floorSize times floors */
+    int layers;
+    int view;               /* 1 if adjL and linked belong to another graph */
 };
 
+
+/* active node: its own bit and, if linked, its floor's */
+static int isActive(GraphL *g, int v){
+    return TESTBIT(g->active, v) && (TESTBIT(g->linked, v) == 0 ||
+            TESTBIT(g->floorActive, (v % g->layerSize) / g->floorSize));
+}
+
 void freeEdge(Item e) {
     free((Edge *) e);
     return;
@@ -52,16 +73,55 @@ GraphL *Ginit(int nodes) {
         return NULL;
     }
 
-    g->active = (int *) malloc(sizeof(int) * nodes);
+    g->active = (unsigned long *) malloc(sizeof(unsigned long) * WORDS(nodes));
+    g->linked = (unsigned long *) calloc(WORDS(nodes), sizeof(unsigned long));
+    g->floorActive = NULL;
+    g->floorSize = 0;
+    g->layerSize = 0;
+    g->layers = 0;
+    g->view = 0;
 
-    for(i = 0; i < nodes; i++){
+    for(i = 0; i < nodes; i++)
         g->adjL[i] = initLinkedList();
-        g->active[i] = 1;
-    }
+    for(i = 0; i < WORDS(nodes); i++)
+        g->active[i] = ~0UL;
 
     return g;
 }
 
+
+GraphL *Gview(GraphL *g) {
+    int i;
+    GraphL *v;
+
+    v = (GraphL *) malloc(sizeof(GraphL));
+    if(v == NULL){
+        fprintf(stderr, "Memory error\n");
+        return NULL;
+    }
+
+    v->nodes = g->nodes;
+    v->adjL = g->adjL;
+    v->view = 1;
+    v->active = (unsigned long *) malloc(sizeof(unsigned long) *
+                                                            WORDS(g->nodes));
+    for(i = 0; i < WORDS(g->nodes); i++)
+        v->active[i] = g->active[i];
+    v->linked = g->linked;
+    v->floorSize = g->floorSize;
+    v->layerSize = g->layerSize;
+    v->layers = g->layers;
+    v->floorActive = NULL;
+    if(g->floorActive != NULL){
+        i = WORDS(g->layerSize / g->floorSize);
+        v->floorActive = (unsigned long *) malloc(sizeof(unsigned long) * i);
+        while(i-- > 0)
+            v->floorActive[i] = g->floorActive[i];
+    }
+
+    return v;
+}
+
 void Gprint(FILE *fp, GraphL *g) {
     int i = 0;
     LinkedList *aux;
@@ -120,11 +180,15 @@ void GdeleteEdge(GraphL *g, int v, int w){
 void Gdestroy(GraphL *g) {
     int i = 0;
     
-    for(i = 0; i < g->nodes; i++)
-        freeLinkedList(g->adjL[i], freeEdge);
-
     free(g->active);
-    free(g->adjL);
+    free(g->floorActive);
+    /* a view only owns its active sets */
+    if(g->view == 0){
+        for(i = 0; i < g->nodes; i++)
+            freeLinkedList(g->adjL[i], freeEdge);
+        free(g->adjL);
+        free(g->linked);
+    }
     free(g);
 }
 
@@ -152,6 +216,39 @@ LinkedList *GedgesOfNode(GraphL *g, int v) {
     return edges;
 }
 
+void GedgeTable(GraphL *g, int reverse, int **start, int **node,
+                                                            int **value){
+    int v, *fill, a, b;
+    LinkedList *t;
+    Edge *e;
+
+    /* edges are counted by the node they're listed under, then placed */
+    *start = (int *) calloc(g->nodes + 1, sizeof(int));
+    for(v = 0; v < g->nodes; v++)
+        for(t = g->adjL[v]; t != NULL; t = getNextNodeLinkedList(t)){
+            e = (Edge *) getItemLinkedList(t);
+            (*start)[(reverse ? e->w : e->v) + 1]++;
+        }
+    for(v = 0; v < g->nodes; v++)
+        (*start)[v + 1] += (*start)[v];
+
+    *node = (int *) malloc(sizeof(int) * ((*start)[g->nodes] + 1));
+    *value = (int *) malloc(sizeof(int) * ((*start)[g->nodes] + 1));
+    fill = (int *) malloc(sizeof(int) * g->nodes);
+    for(v = 0; v < g->nodes; v++)
+        fill[v] = (*start)[v];
+    for(v = 0; v < g->nodes; v++)
+        for(t = g->adjL[v]; t != NULL; t = getNextNodeLinkedList(t)){
+            e = (Edge *) getItemLinkedList(t);
+            a = reverse ? e->w : e->v;
+            b = reverse ? e->v : e->w;
+            (*node)[fill[a]] = b;
+            (*value)[fill[a]++] = e->value;
+        }
+    free(fill);
+    return;
+}
+
 int GorigOfEdge(Edge *e) {
     return e->v;
 }
@@ -165,17 +262,91 @@ int GvalOfEdge(Edge *e) {
 }
 
 void GactivateNode(GraphL *g, int v){
-    g->active[v] = 1;
+    SETBIT(g->active, v);
     return;
 }
 
 void GdeactivateNode(GraphL *g, int v){
-    g->active[v] = 0;
+    CLEARBIT(g->active, v);
     return;
 }
 
 int GisNodeActive(GraphL *g, int v){
-    return g->active[v];
+    return isActive(g, v);
+}
+
+
+/* sets or clears the bits first to last of a set, a word at a time */
+static void setBitRange(unsigned long *set, int first, int last, int value){
+    int w, fw = first / WORDBITS, lw = last / WORDBITS;
+    unsigned long fmask = ~0UL << (first % WORDBITS);
+    unsigned long lmask = ~0UL >> (WORDBITS - 1 - last % WORDBITS);
+
+    if(fw == lw)
+        fmask = lmask = fmask & lmask;
+    for(w = fw; w <= lw; w++){
+        if(w == fw)
+            set[w] = value ? set[w] | fmask : set[w] & ~fmask;
+        else if(w == lw)
+            set[w] = value ? set[w] | lmask : set[w] & ~lmask;
+        else
+            set[w] = value ? ~0UL : 0UL;
+    }
+    return;
+}
+
+void GactivateNodes(GraphL *g, int first, int last){
+    setBitRange(g->active, first, last, 1);
+    return;
+}
+
+void GdeactivateNodes(GraphL *g, int first, int last){
+    setBitRange(g->active, first, last, 0);
+    return;
+}
+
+
+void GsetFloors(GraphL *g, int floorSize, int floors, int layers){
+    int i;
+
+    g->floorSize = floorSize;
+    g->layerSize = floorSize * floors;
+    g->layers = layers;
+    free(g->floorActive);
+    g->floorActive = (unsigned long *) malloc(sizeof(unsigned long) *
+                                                            WORDS(floors));
+    for(i = 0; i < WORDS(floors); i++)
+        g->floorActive[i] = ~0UL;
+    return;
+}
+
+void GlinkNodeToFloor(GraphL *g, int v){
+    SETBIT(g->linked, v);
+    return;
+}
+
+int GisNodeLinkedToFloor(GraphL *g, int v){
+    return (int) TESTBIT(g->linked, v);
+}
+
+int GnodeFloor(GraphL *g, int v){
+    if(g->floorSize == 0 || v >= g->layers * g->layerSize)
+        return -1;
+    return (v % g->layerSize) / g->floorSize;
+}
+
+void GactivateFloor(GraphL *g, int floor){
+    SETBIT(g->floorActive, floor);
+    return;
+}
+
+void GdeactivateFloor(GraphL *g, int floor){
+    CLEARBIT(g->floorActive, floor);
+    return;
+}
+
+int GisFloorActive(GraphL *g, int floor){
+    return (int) TESTBIT(g->floorActive, floor);
 }
 
 void GDijkstraCleanToDest(GraphL *G, Map *parkMap, LinkedList *actions, int *st,
@@ -215,12 +386,14 @@ void GDijkstraCleanToDest(GraphL *G, Map *parkMap, LinkedList *actions, int *st,
  *    int *st - pre-Initialized path table
  *    int *wt - pre-Initialized weight table
  *    PrioQ *PQ - pre-Initialized priority queue
+ *    PathStats *stats - where to count the work done (only with PATHSTATS)
  *
  *  Return value:
  *    int indexed table st, delineating the path to take
  */
 
-int GDijkstra(GraphL *G,int root, int dest, int *st, int *wt, PrioQ *PQ, Map *parkMap) {
+int GDijkstra(GraphL *G,int root, int dest, int *st, int *wt, PrioQ *PQ, Map *parkMap,
+                                                        PathStats *stats) {
     int hP;              /* to save highest priority index */
     LinkedList *t;       /* to go through a linked list without modifying */
     Edge *e;             /* to read adjL information contained in Edge * */
@@ -228,12 +401,15 @@ int GDijkstra(GraphL *G,int root, int dest, int *st, int *wt, PrioQ *PQ, Map *pa
 
     while(!PQisempty(PQ)) {
         hP = PQdelmin(PQ);
+        PScount(stats, popped);
         /* if highest priority is our destiny
          * we have found our ideal path
          */
         /* ignore if node is an inactive node */
-        if(G->active[ hP ] == 0)
+        if(isActive(G, hP) == 0){
+            PScount(stats, skipped);
             continue;
+        }
         if(hP == dest || wt[hP] == NOCON)
             break;
         /* check to see if it is a ramp */
@@ -248,18 +424,24 @@ int GDijkstra(GraphL *G,int root, int dest, int *st, int *wt, PrioQ *PQ, Map *pa
                         wt[ e->w ] = wt[hP] + e->value;
                         PQupdateNode(PQ, e->w);
                         st[e->w] = hP;
+                        PScount(stats, relaxed);
+                        PScount(stats, decreaseKeys);
                     }
                 }
             } else{
                 for(t = G->adjL[ hP ]; t != NULL; t = getNextNodeLinkedList(t)){
                     e = getItemLinkedList(t);
                     if( (e->w - hP != PgetN(parkMap) * PgetM(parkMap)) &&
-                        (hP - e->w != PgetN(parkMap) * PgetM(parkMap)) )
+                        (hP - e->w != PgetN(parkMap) * PgetM(parkMap)) ){
+                        PScount(stats, rampRejected);
                         continue;
+                    }
                     if( wt[ e->w ] > wt[hP] + e->value) {
                         wt[ e->w ] = wt[hP] + e->value;
                         PQupdateNode(PQ, e->w);
                         st[e->w] = hP;
+                        PScount(stats, relaxed);
+                        PScount(stats, decreaseKeys);
                     }
                     break;
                 }
@@ -270,14 +452,23 @@ int GDijkstra(GraphL *G,int root, int dest, int *st, int *wt, PrioQ *PQ, Map *pa
         for(t = G->adjL[ hP ]; t != NULL; t = getNextNodeLinkedList(t)){
             e = getItemLinkedList(t);
             if( wt[ e->w ] >= wt[hP] + e->value) {
+#ifdef PATHSTATS
+                if( wt[ e->w ] > wt[hP] + e->value)
+                    PScount(stats, decreaseKeys);
+#endif
                 wt[ e->w ] = wt[hP] + e->value;
                 if( e->w - hP == hP - st[hP])
                     PQupdateNodeHighPrio(PQ, e->w);
                 else
                     PQupdateNode(PQ, e->w);
                 st[e->w] = hP;
+                PScount(stats, relaxed);
             }
         }
     }
-    return wt[dest];
+#ifdef PATHSTATS
+    if(stats != NULL)
+        stats->cost = dest < 0 ? NOCON : wt[dest];
+#endif
+    return dest < 0 ? NOCON : wt[dest];
 }
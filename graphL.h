@@ -4,6 +4,7 @@
 #include<stdio.h>
 #include"prioQ.h"
 #include"parkmap.h"
+#include"pathstats.h"
 
 /* this value will indicate that there is no connection between
  * current tree and a node while performing the algorithm 
@@ -18,6 +19,11 @@ typedef struct _graphL GraphL;
 
 GraphL *Ginit(int nodes);
 
+/* new graph sharing the edges of g, with a copy of its active nodes and floors.
+ * Edges must not be inserted or deleted while views of a graph exist, and
+ * the view must be destroyed before the graph */
+GraphL *Gview(GraphL *g);
+
 void GinsertEdge(GraphL *g, int v, int w, int value);
 void GdeleteEdge(GraphL *g, int v, int w);
 
@@ -25,15 +31,60 @@ void Gprint(FILE *fp,GraphL *g);
 
 LinkedList *GedgesOfNode(GraphL *, int);
 
+/* edges as arrays: those out of v go to node[i], with value value[i], for i
+ * in [start[v], start[v + 1]). If reverse, edges are listed by the node they
+ * go into and node[i] is where they come from. The tables are new and belong
+ * to the caller */
+void GedgeTable(GraphL *g, int reverse, int **start, int **node, int **value);
+
 int Gnodes(GraphL *g);
 int GorigOfEdge(Edge *e);
 int GdestOfEdge(Edge *e);
 int GvalOfEdge(Edge *e);
 
+/* a node is active if it wasn't deactivated and, when linked to its floor,
+ * the floor wasn't either */
 void GactivateNode(GraphL *g, int v);
 void GdeactivateNode(GraphL *g, int v);
 int GisNodeActive(GraphL *g, int v);
 
+/* the same for the nodes first to last, a word of the set at a time */
+void GactivateNodes(GraphL *g, int first, int last);
+void GdeactivateNodes(GraphL *g, int first, int last);
+
+
+/*
+ *  Functions:
+ *    GsetFloors
+ *    GlinkNodeToFloor
+ *    GisNodeLinkedToFloor
+ *    GnodeFloor
+ *    GactivateFloor
+ *    GdeactivateFloor
+ *    GisFloorActive
+ *
+ *  Description:
+ *    floors of the graph. The first layers * floors * floorSize nodes are
+ *    numbered floor by floor, in one or more layers (node v is on floor
+ *    (v % (floors * floorSize)) / floorSize), the rest are on none. Nodes
+ *    linked to their floor, as its ways in and out, are inactive while the
+ *    floor is, which takes a single change; their own state is kept apart.
+ *    Floors are set, and nodes linked, before any view is made
+ *
+ *  Return value:
+ *    int - 1 if the node is linked to its floor (GisNodeLinkedToFloor), the
+ *        floor of the node or -1 (GnodeFloor), 1 if the floor is active
+ *        (GisFloorActive)
+ */
+
+void GsetFloors(GraphL *g, int floorSize, int floors, int layers);
+void GlinkNodeToFloor(GraphL *g, int v);
+int GisNodeLinkedToFloor(GraphL *g, int v);
+int GnodeFloor(GraphL *g, int v);
+void GactivateFloor(GraphL *g, int floor);
+void GdeactivateFloor(GraphL *g, int floor);
+int GisFloorActive(GraphL *g, int floor);
+
 
 /*
  *  Function:
@@ -46,7 +97,7 @@ int GisNodeActive(GraphL *g, int v);
  *  Arguments:
  *    Map *parkMap - configuration map
  *    int root - node to start from
- *    int dest - node to arrive at
+ *    int dest - node to arrive at, -1 to settle every node reachable
  *    int *st  - previously initialized and loaded path tree
  *            At first usage all indexes would be set to -1 
  *
@@ -62,11 +113,15 @@ int GisNodeActive(GraphL *g, int v);
  *                  wt[origin] = 0;
  *                  PQupdate(PQ, origin);
  *
+ *    PathStats *stats - counters of the work done, cleared by the caller
+ *          (may be NULL). Only counted when built with PATHSTATS
+ *
  *  Return value:
- *    total cost of calculated path 
+ *    total cost of calculated path (NOCON if dest is -1)
  */
 
-int GDijkstra(GraphL *g, int root, int dest, int* st, int *wt, PrioQ *PQ, Map *parkMap);
+int GDijkstra(GraphL *g, int root, int dest, int* st, int *wt, PrioQ *PQ, Map *parkMap,
+                                                        PathStats *stats);
 
 
 void GfreeEdge(Item e);
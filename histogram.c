@@ -0,0 +1,106 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: log bucketed histogram of durations
+ *
+ *  Implementation details:
+ *      Values below 2 * HGSUB have a bucket each. Above that a value with
+ *  its highest bit at position e goes to the sub-bucket given by its
+ *  HGSUBBITS + 1 highest bits, in the group of buckets of e, so the buckets
+ *  of each power of two are HGSUB wide in relative terms
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#include<stdio.h>
+
+#include"histogram.h"
+
+
+/*
+ * Auxiliary-function: bucketOf
+ *
+ * Description:
+ *      index of the bucket of a value
+ */
+
+static int bucketOf(unsigned long value){
+    int shift = 0;
+
+    while( (value >> shift) >= 2 * HGSUB)
+        shift++;
+    return shift * HGSUB + (int) (value >> shift);
+}
+
+
+/*
+ * Auxiliary-function: bucketTop
+ *
+ * Description:
+ *      highest value which goes to a bucket
+ */
+
+static unsigned long bucketTop(int bucket){
+    int shift;
+
+    if(bucket < 2 * HGSUB)
+        return (unsigned long) bucket;
+    shift = bucket / HGSUB - 1;
+    return ( (unsigned long) (bucket % HGSUB + HGSUB + 1) << shift) - 1;
+}
+
+
+void HGclear(Histogram *h){
+    int i;
+
+    h->count = 0;
+    h->max = 0;
+    for(i = 0; i < HGBUCKETS; i++)
+        h->buckets[i] = 0;
+    return;
+}
+
+
+void HGrecord(Histogram *h, unsigned long value){
+    h->buckets[bucketOf(value)]++;
+    h->count++;
+    if(value > h->max)
+        h->max = value;
+    return;
+}
+
+
+unsigned long HGpercentile(Histogram *h, double p){
+    unsigned long rank, seen = 0, top;
+    int i;
+
+    if(h->count == 0)
+        return 0;
+
+    /* rank of the value wanted, from 1 to count */
+    rank = (unsigned long) (p / 100.0 * h->count + 0.5);
+    if(rank < 1)
+        rank = 1;
+    if(rank > h->count)
+        rank = h->count;
+
+    for(i = 0; i < HGBUCKETS; i++){
+        seen += h->buckets[i];
+        if(seen >= rank)
+            break;
+    }
+    top = bucketTop(i);
+    return top < h->max ? top : h->max;
+}
+
+
+void HGprint(FILE *fp, Histogram *h, char *label){
+    fprintf(fp, "%s n %lu p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f us\n",
+                label, h->count, HGpercentile(h, 50) / 1e3,
+                HGpercentile(h, 90) / 1e3, HGpercentile(h, 99) / 1e3,
+                HGpercentile(h, 99.9) / 1e3, h->max / 1e3);
+    return;
+}
@@ -0,0 +1,107 @@
+/*
+ *  File name: histogram.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: log bucketed histogram of durations, to get the percentiles
+ *          of many measures without keeping them.
+ *
+ *          Values are kept in buckets whose width doubles with every power
+ *          of two, split in HGSUB sub-buckets, so any value is known with an
+ *          error below 1/HGSUB of itself (6%) whatever its magnitude. Adding
+ *          a value is a few shifts and an increment, cheap enough to always
+ *          be done.
+ *
+ *  Data type list:
+ *    Histogram
+ *
+ *  Function list:
+ *    HGclear
+ *    HGrecord
+ *    HGpercentile
+ *    HGprint
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __histogram__h
+#define __histogram__h 1
+
+#include<stdio.h>
+
+/* sub-buckets of each power of two (as a power of two) */
+#define HGSUBBITS 4
+#define HGSUB (1 << HGSUBBITS)
+/* enough buckets for any unsigned long of 64 bits */
+#define HGBUCKETS ((64 - HGSUBBITS + 1) * HGSUB)
+
+
+/*
+ *  Data type: Histogram
+ *
+ *  Description: counts of the recorded values, in nanoseconds
+ */
+
+typedef struct _histogram{
+    unsigned long count;
+    unsigned long max;
+    unsigned long buckets[HGBUCKETS];
+} Histogram;
+
+
+/*
+ *  Function:
+ *    HGclear
+ *
+ *  Description:
+ *    empties the histogram
+ */
+
+void HGclear(Histogram *h);
+
+
+/*
+ *  Function:
+ *    HGrecord
+ *
+ *  Description:
+ *    adds a value, in nanoseconds
+ */
+
+void HGrecord(Histogram *h, unsigned long value);
+
+
+/*
+ *  Function:
+ *    HGpercentile
+ *
+ *  Description:
+ *    returns the value below which are p percent of the recorded values,
+ *  given as the highest value of its bucket (never above the maximum)
+ *
+ *  Arguments:
+ *    Histogram *h
+ *    double p - percentile, from 0 to 100
+ *
+ *  Return value:
+ *    unsigned long - value in nanoseconds, 0 if the histogram is empty
+ */
+
+unsigned long HGpercentile(Histogram *h, double p);
+
+
+/*
+ *  Function:
+ *    HGprint
+ *
+ *  Description:
+ *    writes a single line with the number of values and their p50, p90,
+ *  p99, p99.9 and maximum in microseconds, starting with the given label
+ */
+
+void HGprint(FILE *fp, Histogram *h, char *label);
+
+#endif
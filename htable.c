@@ -17,11 +17,13 @@ struct _hashtable{
 };
 
 int hash(int m, int p, char *key){
-    int h = 0, c;
-    while( (c = (int) *key++) )
-        h = h*p + c;
-    h = h % m;
-    return h;
+    unsigned long h = 0;
+    int c;
+
+    /* reduced at every step so longer keys can't overflow */
+    while( (c = (unsigned char) *key++) )
+        h = (h * p + c) % m;
+    return (int) h;
 }
 
 HashTable *HTinit(int m, int p){
@@ -0,0 +1,266 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: load generator for the route server
+ *
+ *               Replays a car input file against a running autoparkd, waiting
+ *          for the answer to each request before sending the next one, and
+ *          reports the throughput and the request latency percentiles.
+ *
+ *          To run:
+ *              loadgen <socket path> <file.inp> [-n repeats] [-o output]
+ *
+ *          The events of the same instant go in the same request, so the
+ *          lines written to the output (-o) are the same as in the .pts file
+ *          produced by autopark for that input. Between repetitions the park
+ *          is reset.
+ *
+ *  Non standard interface dependencies:
+ *      frame.h - message framing
+ *      timing.h - clock
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* sockets are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<sys/types.h>
+#include<sys/socket.h>
+#include<sys/un.h>
+
+#include"frame.h"
+#include"timing.h"
+
+
+#define LINESIZE 256
+
+
+/*
+ *  Data Type: Request
+ *
+ *  Description:
+ *      the event lines of one instant, ready to be sent
+ */
+
+typedef struct _request{
+    char *payload;
+    int len;
+    int events;
+} Request;
+
+
+static int compareDouble(const void *a, const void *b){
+    double x = *(double *) a, y = *(double *) b;
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+
+/*
+ * Auxiliary-function: lineTime
+ *
+ * Description:
+ *      returns the instant of an event line, -1 if it has none
+ */
+
+static int lineTime(char *line){
+    char id[LINESIZE];
+    int t;
+
+    /* both car and restriction lines have the instant second */
+    if(sscanf(line, "%s %d", id, &t) < 2)
+        return -1;
+    return t;
+}
+
+
+/*
+ * Auxiliary-function: loadRequests
+ *
+ * Description:
+ *      groups the lines of the input file in requests, one per instant
+ */
+
+static Request *loadRequests(char *filename, int *nRequests){
+    FILE *fp;
+    Request *reqs;
+    char line[LINESIZE];
+    int n = 0, max = 64, t, last = -1, size, cap = 0;
+
+    fp = fopen(filename, "r");
+    if(fp == NULL){
+        fprintf(stderr, "Error opening file %s\n", filename);
+        return NULL;
+    }
+
+    reqs = (Request *) malloc(sizeof(Request) * max);
+    while(fgets(line, LINESIZE, fp) != NULL){
+        t = lineTime(line);
+        if(t < 0)
+            continue;
+        size = strlen(line);
+        if(line[size - 1] != '\n'){
+            line[size++] = '\n';
+            line[size] = '\0';
+        }
+
+        if(n == 0 || t != last){
+            if(n == max){
+                max *= 2;
+                reqs = (Request *) realloc(reqs, sizeof(Request) * max);
+            }
+            cap = 4 * LINESIZE;
+            reqs[n].payload = (char *) malloc(cap);
+            reqs[n].len = 0;
+            reqs[n].events = 0;
+            last = t;
+            n++;
+        }
+        else if(reqs[n - 1].len + size >= cap){
+            cap *= 2;
+            reqs[n - 1].payload = (char *) realloc(reqs[n - 1].payload, cap);
+        }
+        memcpy(reqs[n - 1].payload + reqs[n - 1].len, line, size);
+        reqs[n - 1].len += size;
+        reqs[n - 1].events++;
+    }
+    fclose(fp);
+
+    *nRequests = n;
+    return reqs;
+}
+
+
+static int connectSocket(char *path){
+    struct sockaddr_un addr;
+    int fd;
+
+    if(strlen(path) >= sizeof(addr.sun_path)){
+        fprintf(stderr, "Socket path too long %s\n", path);
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0){
+        perror("socket");
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    if(connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0){
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+/*
+ * Auxiliary-function: exchange
+ *
+ * Description:
+ *      sends a request and waits for its response
+ *
+ * Return value:
+ *      allocated response, NULL if the server went away
+ */
+
+static char *exchange(int fd, char *payload, int len, int *outLen){
+    if(frameWrite(fd, payload, len) < 0)
+        return NULL;
+    return frameRead(fd, outLen);
+}
+
+
+int main(int argc, char *argv[]){
+    Request *reqs;
+    FILE *out = NULL;
+    char *resp;
+    double *lat, t0, start, total;
+    int nRequests, repeats = 1, fd, i, r, k, len, events = 0;
+
+    if(argc < 3){
+        fprintf(stderr,
+            "Usage: %s <socket path> <file.inp> [-n repeats] [-o output]\n",
+                                                                    argv[0]);
+        exit(1);
+    }
+    for(i = 3; i + 1 < argc; i += 2){
+        if(strcmp(argv[i], "-n") == 0)
+            repeats = atoi(argv[i + 1]);
+        else if(strcmp(argv[i], "-o") == 0){
+            out = fopen(argv[i + 1], "w");
+            if(out == NULL){
+                fprintf(stderr, "Error opening file %s\n", argv[i + 1]);
+                exit(1);
+            }
+        }
+    }
+    if(repeats < 1)
+        repeats = 1;
+
+    reqs = loadRequests(argv[2], &nRequests);
+    if(reqs == NULL)
+        exit(1);
+    fd = connectSocket(argv[1]);
+    if(fd < 0)
+        exit(2);
+
+    lat = (double *) malloc(sizeof(double) * (nRequests * repeats + 1));
+    k = 0;
+    total = 0;
+
+    for(r = 0; r < repeats; r++){
+        if(r > 0){
+            resp = exchange(fd, "RESET", 5, &len);
+            if(resp == NULL)
+                break;
+            free(resp);
+        }
+        start = Tnow();
+        for(i = 0; i < nRequests; i++){
+            t0 = Tnow();
+            resp = exchange(fd, reqs[i].payload, reqs[i].len, &len);
+            lat[k++] = Tnow() - t0;
+            if(resp == NULL){
+                fprintf(stderr, "Connection lost\n");
+                exit(2);
+            }
+            if(out != NULL && r == 0)
+                fwrite(resp, 1, len, out);
+            free(resp);
+            events += reqs[i].events;
+        }
+        total += Tnow() - start;
+    }
+    close(fd);
+    if(out != NULL)
+        fclose(out);
+
+    if(k > 0){
+        qsort(lat, k, sizeof(double), compareDouble);
+        printf("%d requests, %d events in %.3f s\n", k, events, total);
+        printf("throughput %.1f requests/s, %.1f events/s\n",
+                                            k / total, events / total);
+        printf("latency p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                    lat[k / 2] * 1e6, lat[(k * 99) / 100] * 1e6,
+                    lat[k - 1] * 1e6);
+    }
+
+    for(i = 0; i < nRequests; i++)
+        free(reqs[i].payload);
+    free(reqs);
+    free(lat);
+    exit(0);
+}
@@ -0,0 +1,332 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: rankings of spots made ahead of time by background threads
+ *
+ *  Implementation details:
+ *      A job is the ranking of one entrance and access type (a pair) in one
+ *  epoch, numbered epoch by epoch, and threads take them in that order from
+ *  a shared counter. Each thread keeps a Map of its own, with no cars, and
+ *  applies the restriction orders to it as its jobs reach later epochs.
+ *
+ *      Threads only go one epoch ahead of the dispatcher, so at most the
+ *  rankings of two epochs are kept at a time. An epoch followed right away
+ *  by another restriction order of the same instant is never seen by an
+ *  admission and is skipped
+ *
+ *  Non standard interface dependencies:
+ *      parkmap.h - Maps and rankings
+ *      LinkedList.h - list of orders
+ *      orders.h - Order data type
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* threads are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<pthread.h>
+
+#include"lookahead.h"
+#include"parkmap.h"
+#include"LinkedList.h"
+#include"orders.h"
+
+
+/* a restriction order, copied so the list isn't read by the threads */
+typedef struct _restriction{
+    char action;
+    int x, y, z, x2, y2, z2;
+} Restriction;
+
+
+typedef struct _pair{
+    int x, y, z;
+    char type;
+} Pair;
+
+
+/* states of a job */
+#define TODO    0
+#define WORKING 1          /* a thread is making it */
+#define MADE    2
+#define GONE    3          /* skipped, or left to the dispatcher */
+
+
+typedef struct _worker{
+    Lookahead *L;
+    Map *parkMap;            /* restrictions of the epoch it's in */
+    int epoch;
+    pthread_t thread;
+} Worker;
+
+
+struct _lookahead{
+    Restriction *res;        /* epoch e has the first e applied */
+    int nEpochs;
+    char *skip;              /* epochs no admission sees */
+
+    Pair *pairs;
+    int nPairs;
+
+    SpotRanking **rank;      /* job j is pair j % nPairs of epoch j / nPairs */
+    char *state;             /* of each job */
+    int nJobs, next;         /* next job not taken by a thread */
+    int current;             /* epoch of the dispatcher */
+    int stop;
+
+    Worker *workers;
+    int nWorkers;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+
+static void applyRestriction(Map *parkMap, Restriction *r){
+    switch(r->action){
+        case 'R':
+            restrictMapCoordinate(parkMap, r->x, r->y, r->z);
+            break;
+        case 'r':
+            freeRestrictionMapCoordinate(parkMap, r->x, r->y, r->z);
+            break;
+        case 'P':
+            restrictMapFloor(parkMap, r->z);
+            break;
+        case 'p':
+            freeRestrictionMapFloor(parkMap, r->z);
+            break;
+        case 'B':
+            restrictMapRegion(parkMap, r->x, r->y, r->z, r->x2, r->y2, r->z2);
+            break;
+        case 'b':
+            freeRestrictionMapRegion(parkMap, r->x, r->y, r->z,
+                                                    r->x2, r->y2, r->z2);
+            break;
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-function: readOrders
+ *
+ * Description:
+ *      copies the restriction orders and the pairs of the arrivals of the
+ *  list, marking the epochs to skip
+ */
+
+static void readOrders(Lookahead *L, Map *parkMap, LinkedList *orders){
+    LinkedList *t;
+    Order *o, *prev = NULL;
+    int nRes = 0, maxRes = 16, maxPairs = 16, i;
+    Restriction *r;
+
+    L->res = (Restriction *) malloc(sizeof(Restriction) * maxRes);
+    L->skip = (char *) calloc(maxRes + 1, sizeof(char));
+    L->pairs = (Pair *) malloc(sizeof(Pair) * maxPairs);
+    L->nPairs = 0;
+
+    for(t = orders; t != NULL; prev = o, t = getNextNodeLinkedList(t)){
+        o = (Order *) getItemLinkedList(t);
+        if(strchr("RrPpBb", (int) o->action) != NULL){
+            if(nRes == maxRes){
+                maxRes *= 2;
+                L->res = (Restriction *) realloc(L->res,
+                                            sizeof(Restriction) * maxRes);
+                L->skip = (char *) realloc(L->skip, maxRes + 1);
+                memset(L->skip + nRes + 1, 0, maxRes - nRes);
+            }
+            if(prev != NULL && nRes > 0 && prev->time == o->time &&
+                            strchr("RrPpBb", (int) prev->action) != NULL)
+                L->skip[nRes] = 1;
+            r = &L->res[nRes++];
+            r->action = o->action;
+            r->x = o->x;
+            r->y = o->y;
+            r->z = o->z;
+            r->x2 = o->x2;
+            r->y2 = o->y2;
+            r->z2 = o->z2;
+        } else if(o->action == 'E' && PhasAccess(parkMap, o->type)){
+            for(i = 0; i < L->nPairs; i++)
+                if(L->pairs[i].x == o->x && L->pairs[i].y == o->y &&
+                        L->pairs[i].z == o->z && L->pairs[i].type == o->type)
+                    break;
+            if(i < L->nPairs)
+                continue;
+            if(L->nPairs == maxPairs){
+                maxPairs *= 2;
+                L->pairs = (Pair *) realloc(L->pairs, sizeof(Pair) * maxPairs);
+            }
+            L->pairs[i].x = o->x;
+            L->pairs[i].y = o->y;
+            L->pairs[i].z = o->z;
+            L->pairs[i].type = o->type;
+            L->nPairs++;
+        }
+    }
+    L->nEpochs = nRes + 1;
+    return;
+}
+
+
+/*
+ * Auxiliary-function: work
+ *
+ * Description:
+ *      thread making rankings, job after job, until there are no more or
+ *  the lookahead is stopped
+ */
+
+static void *work(void *arg){
+    Worker *W = (Worker *) arg;
+    Lookahead *L = W->L;
+    SpotRanking *R;
+    Pair *p;
+    int j, e;
+
+    pthread_mutex_lock(&L->lock);
+    while(1){
+        while(L->stop == 0 && L->next < L->nJobs &&
+                                    L->next / L->nPairs > L->current + 1)
+            pthread_cond_wait(&L->changed, &L->lock);
+        if(L->stop || L->next == L->nJobs)
+            break;
+        j = L->next++;
+        e = j / L->nPairs;
+        if(L->state[j] != TODO || L->skip[e] || e < L->current){
+            L->state[j] = GONE;
+            continue;
+        }
+        L->state[j] = WORKING;
+        pthread_mutex_unlock(&L->lock);
+
+        for(; W->epoch < e; W->epoch++)
+            applyRestriction(W->parkMap, &L->res[W->epoch]);
+        p = &L->pairs[j % L->nPairs];
+        R = rankSpots(W->parkMap, p->x, p->y, p->z, p->type, NULL);
+
+        pthread_mutex_lock(&L->lock);
+        /* the dispatcher may have gone past it meanwhile */
+        if(e < L->current){
+            freeSpotRanking(R);
+            R = NULL;
+        }
+        L->rank[j] = R;
+        L->state[j] = MADE;
+        pthread_cond_broadcast(&L->changed);
+    }
+    pthread_mutex_unlock(&L->lock);
+    return NULL;
+}
+
+
+Lookahead *LAinit(Map *parkMap, LinkedList *orders, int nThreads){
+    Lookahead *L;
+    int i;
+
+    L = (Lookahead *) malloc(sizeof(Lookahead));
+    readOrders(L, parkMap, orders);
+    L->nJobs = L->nEpochs * L->nPairs;
+    L->rank = (SpotRanking **) calloc(L->nJobs + 1, sizeof(SpotRanking *));
+    L->state = (char *) calloc(L->nJobs + 1, sizeof(char));
+    L->next = 0;
+    L->current = 0;
+    L->stop = 0;
+    pthread_mutex_init(&L->lock, NULL);
+    pthread_cond_init(&L->changed, NULL);
+
+    L->workers = (Worker *) malloc(sizeof(Worker) *
+                                            (nThreads > 0 ? nThreads : 1));
+    L->nWorkers = 0;
+    for(i = 0; i < nThreads && L->nJobs > 0; i++){
+        L->workers[i].L = L;
+        L->workers[i].parkMap = mapInitShared(PgetBase(parkMap));
+        L->workers[i].epoch = 0;
+        if(pthread_create(&L->workers[i].thread, NULL, work,
+                                                    &L->workers[i]) != 0){
+            mapDestroy(L->workers[i].parkMap);
+            break;
+        }
+        L->nWorkers++;
+    }
+
+    if(L->nWorkers == 0){
+        LAdestroy(L);
+        return NULL;
+    }
+    return L;
+}
+
+
+SpotRanking *LAtake(void *state, int epoch, int x, int y, int z, char type){
+    Lookahead *L = (Lookahead *) state;
+    SpotRanking *R;
+    int p, j;
+
+    pthread_mutex_lock(&L->lock);
+    if(epoch > L->current){
+        for(j = L->current * L->nPairs; j < epoch * L->nPairs &&
+                                                    j < L->nJobs; j++)
+            if(L->rank[j] != NULL){
+                freeSpotRanking(L->rank[j]);
+                L->rank[j] = NULL;
+            }
+        L->current = epoch;
+        pthread_cond_broadcast(&L->changed);
+    }
+
+    for(p = 0; p < L->nPairs; p++)
+        if(L->pairs[p].x == x && L->pairs[p].y == y && L->pairs[p].z == z &&
+                                                    L->pairs[p].type == type)
+            break;
+    if(p == L->nPairs || epoch >= L->nEpochs){
+        pthread_mutex_unlock(&L->lock);
+        return NULL;
+    }
+    j = epoch * L->nPairs + p;
+    while(L->state[j] == WORKING)
+        pthread_cond_wait(&L->changed, &L->lock);
+    /* not started, the dispatcher makes it sooner itself */
+    if(L->state[j] == TODO)
+        L->state[j] = GONE;
+    R = L->rank[j];
+    L->rank[j] = NULL;
+    pthread_mutex_unlock(&L->lock);
+    return R;
+}
+
+
+void LAdestroy(Lookahead *L){
+    int i;
+
+    pthread_mutex_lock(&L->lock);
+    L->stop = 1;
+    pthread_cond_broadcast(&L->changed);
+    pthread_mutex_unlock(&L->lock);
+    for(i = 0; i < L->nWorkers; i++){
+        pthread_join(L->workers[i].thread, NULL);
+        mapDestroy(L->workers[i].parkMap);
+    }
+
+    for(i = 0; i < L->nJobs; i++)
+        if(L->rank[i] != NULL)
+            freeSpotRanking(L->rank[i]);
+    pthread_mutex_destroy(&L->lock);
+    pthread_cond_destroy(&L->changed);
+    free(L->workers);
+    free(L->rank);
+    free(L->state);
+    free(L->res);
+    free(L->skip);
+    free(L->pairs);
+    free(L);
+    return;
+}
@@ -0,0 +1,100 @@
+/*
+ *  File name: lookahead.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: rankings of spots made ahead of time. The whole list of
+ *          orders of a scenario is known before it starts, and with it every
+ *          restriction epoch (the park between two restriction orders) and
+ *          every entrance and access type cars will come by. Background
+ *          threads make the rankings (see rankSpots) of each epoch, for each
+ *          of those, over Maps of their own with the epoch's restrictions,
+ *          while the dispatcher goes through the orders.
+ *
+ *          A ranking depends only on the restrictions, not on the cars
+ *          parked, so the one made ahead is the one the dispatcher would make
+ *          when it gets to the epoch (see DsetRankingSource)
+ *
+ *  Abstract Data Type: Lookahead
+ *              The threads, their Maps and the rankings made and not taken
+ *          yet, of the epoch the dispatcher is in and of the next one
+ *
+ *  Function list:
+ *    LAinit
+ *    LAtake
+ *    LAdestroy
+ *
+ *  Non-standard dependencies:
+ *    parkmap.h
+ *    LinkedList.h
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __lookahead__h
+#define __lookahead__h 1
+
+#include"parkmap.h"
+#include"LinkedList.h"
+
+typedef struct _lookahead Lookahead;
+
+
+/*
+ *  Function:
+ *    LAinit
+ *
+ *  Description:
+ *    starts making the rankings of the epochs of a list of orders
+ *
+ *  Arguments:
+ *    Map *parkMap - Map the orders will be applied to, before any of them
+ *    LinkedList *orders - time ordered list of Orders, read only here
+ *    int nThreads - number of threads making rankings
+ *
+ *  Return value:
+ *    Lookahead * - the lookahead, NULL if no thread could be started
+ */
+
+Lookahead *LAinit(Map *parkMap, LinkedList *orders, int nThreads);
+
+
+/*
+ *  Function:
+ *    LAtake
+ *
+ *  Description:
+ *    ranking source for the dispatcher (see rankingFnt in dispatch.h).
+ *  Waits for the ranking if a thread is making it, and gives nothing if no
+ *  thread has started it yet. Asking for an epoch, for any
+ *  entrance and type, lets the rankings of the ones before it go and the
+ *  threads start the next one
+ *
+ *  Arguments:
+ *    void *state - the Lookahead
+ *    int epoch - restriction orders applied before
+ *    int x, y, z - entrance coordinates
+ *    char type - access type
+ *
+ *  Return value:
+ *    SpotRanking * - the ranking, to be freed by the caller, NULL if it
+ *        isn't made ahead (or was already taken)
+ */
+
+SpotRanking *LAtake(void *state, int epoch, int x, int y, int z, char type);
+
+
+/*
+ *  Function:
+ *    LAdestroy
+ *
+ *  Description:
+ *    stops the threads and frees the lookahead with the rankings not taken
+ */
+
+void LAdestroy(Lookahead *L);
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: Order data type and input file loading functions
+ *
+ *  Implementation details:
+ *      The input and restriction files are read and listed in reverse time
+ *  order (new nodes are inserted at the head of the list) and then merged
+ *  into a single list in increasing time order
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"orders.h"
+#include"LinkedList.h"
+
+
+Order *newOrder(char action, char type, int time, int x, int y, int z,
+                                                                char *id){
+    Order *order;
+
+    order = (Order *) malloc(sizeof(Order));
+    order->action = action;
+    order->type = type;
+    order->time = time;
+    order->x = x; order->y = y; order->z = z;
+    order->x2 = x; order->y2 = y; order->z2 = z;
+    order->id = NULL;
+    if(id != NULL){
+        order->id = (char *) malloc(sizeof(char) * (strlen(id) + 1));
+        strcpy(order->id, id);
+    }
+    return order;
+}
+
+
+void OrderDestroy(Item order){
+    if( order == NULL)
+        return;
+    if(((Order *) order)->id != NULL)
+        free(((Order *)order)->id);
+    free( ((Order *) order));
+    return;
+}
+
+
+/*
+ * Function: loadInstructionFile
+ *
+ * Description:
+ *      loads instructions given in the .inp file and lists them in reverse order
+ *  using struct Order in a LinkedList
+ */
+
+LinkedList *loadInstructionFile(char *inpfile){
+    FILE *fp;
+    char buffer[256];
+    int time, x, y, z;
+    char type;
+    char auxChar;
+    int inpRead;
+    Order *order;
+    LinkedList *t;
+
+    t = initLinkedList();
+
+    fp = fopen(inpfile, "r");
+    if(fp == NULL){
+        fprintf(stderr, "Couldn't open instruction file %s\n", inpfile);
+        return NULL;
+    }
+
+    buffer[0] = '\0';
+
+    auxChar = (char) fgetc(fp);
+    while(auxChar != EOF){
+        if(auxChar == 'V'){
+            ungetc(auxChar, fp);
+            inpRead = fscanf(fp, "%s %d %c %d %d %d", buffer, &time, &type,
+                                                      &x, &y, &z);
+            if(inpRead == 6){
+                if(type == 'S')
+                    order = newOrder('S', ' ', time, x, y, z, buffer);
+                else
+                    order = newOrder('E', type, time, x, y, z, buffer);
+                buffer[0] = '\0';
+                t = insertUnsortedLinkedList(t, (Item) order);
+            } else if(inpRead == 3){
+                order = newOrder('s', ' ', time, -1, -1, -1, buffer);
+                buffer[0] = '\0';
+                t = insertUnsortedLinkedList(t, (Item) order);
+            } else{
+                break;
+            }
+        }
+        auxChar = (char) fgetc(fp);
+    }
+    fclose(fp);
+
+    return t;
+}
+
+
+/*
+ * Auxiliary-function: newRegionOrder
+ *
+ * Description:
+ *      new region restriction (B) or lifting (b) order
+ */
+
+static Order *newRegionOrder(char action, int time, int *c){
+    Order *order = newOrder(action, ' ', time, c[0], c[1], c[2], NULL);
+
+    order->x2 = c[3];
+    order->y2 = c[4];
+    order->z2 = c[5];
+    return order;
+}
+
+
+/*
+ * Function: loadRestrictionFile
+ *
+ * Description:
+ *       similarly to loadInstructionFile function it lists the restrictions
+ *  given by the input file in reverse order using the Order data type. A line
+ *  has a position (R ta tb x y z), a floor (R ta tb z) or a box from corner
+ *  to corner (R ta tb x1 y1 z1 x2 y2 z2)
+ */
+
+LinkedList *loadRestrictionFile(char *resfile){
+    FILE *fp;
+    int ta, tb, c[6];
+    int inpRead;
+    char R, auxChar;
+    char line[256];
+    Order *order;
+    LinkedList *t;
+
+    t = initLinkedList();
+
+    fp = fopen(resfile, "r");
+    if(fp == NULL){
+        fprintf(stderr, "Couldn't open restrictions file %s\n", resfile);
+        return NULL;
+    }
+
+    /* go through restriction file and list them in reverse order */
+    auxChar = (char) fgetc(fp);
+    while(auxChar != EOF){
+        if(auxChar == 'R'){
+            /* a whole line, regions have 9 numbers */
+            ungetc(auxChar, fp);
+            if(fgets(line, sizeof(line), fp) == NULL)
+                break;
+            inpRead = sscanf(line, "%c %d %d %d %d %d %d %d %d", &R, &ta,
+                            &tb, &c[0], &c[1], &c[2], &c[3], &c[4], &c[5]);
+            if(inpRead == 9){
+                order = newRegionOrder('B', ta, c);
+                t = insertUnsortedLinkedList(t, (Item) order);
+
+                if(tb >= ta){
+                    order = newRegionOrder('b', tb, c);
+                    t = insertUnsortedLinkedList(t, (Item) order);
+                }
+            } else if(inpRead == 6){
+                order = newOrder('R', ' ', ta, c[0], c[1], c[2], NULL);
+                t = insertUnsortedLinkedList(t, (Item) order);
+
+                if(tb >= ta){
+                    order = newOrder('r', ' ', tb, c[0], c[1], c[2], NULL);
+                    t = insertUnsortedLinkedList(t, (Item) order);
+                }
+            } else if(inpRead == 4){   /* if it's a floor type restriction */
+                /* x contains floor */
+                order = newOrder('P', ' ', ta, -1, -1, c[0], NULL);
+                t = insertUnsortedLinkedList(t, (Item) order);
+
+                if(tb >= ta){
+                    order = newOrder('p', ' ', tb, -1, -1, c[0], NULL);
+                    t = insertUnsortedLinkedList(t, (Item) order);
+                }
+            } else{
+                break;
+            }
+        }
+        auxChar = (char) fgetc(fp);
+    }
+    fclose(fp);
+
+    return t;
+}
+
+
+/*
+ * Auxiliary-function: compareOrderTime
+ *
+ * Description:
+ *      compares times fields in 2 orders given as void * arguments
+ *
+ * Purpose:
+ *      used in inpresShuffleOrder Function ahead in a way to merge 2 lists
+ *  in reverse order
+ */
+
+int compareOrderTime(Item order1, Item order2){
+    if( ((Order *) order1)->time <= ((Order *) order2)->time)
+        return 1;
+    else
+        return 0;
+}
+
+
+/*
+ * Function: inpresShuffleOrder
+ *
+ * Description:
+ *      merges 2 ordered lists of Orders Data Type into one list in reverse
+ *  order
+ *
+ * Purpose:
+ *      to merge a reverse order Restriction list and a reverse order
+ *  Instruction list into a time increasing ordered list of both
+ *
+ *      Note: since lists are given in reverse order, the reverse of the
+ *  reverse is the original order, which we wish to maintain
+ */
+
+LinkedList *inpresShuffleOrder(LinkedList *inpList, LinkedList *resList){
+    return mergeOrderedLists(inpList, resList, compareOrderTime);
+}
+
+
+/*
+ * Function: parseOrderLine
+ *
+ * Description:
+ *      reads a single line with the same formats accepted by the file
+ *  loaders. Used when orders arrive one at a time instead of in a file
+ */
+
+int parseOrderLine(char *line, Order **first, Order **second){
+    char buffer[256];
+    int time, ta, tb, x, y, z, c[6];
+    int inpRead;
+    char type, R;
+
+    *first = NULL;
+    *second = NULL;
+
+    /* skip leading blanks */
+    while(*line == ' ' || *line == '\t')
+        line++;
+
+    if(*line == 'V'){
+        if(strlen(line) >= sizeof(buffer))
+            return 0;
+        inpRead = sscanf(line, "%s %d %c %d %d %d", buffer, &time, &type,
+                                                          &x, &y, &z);
+        if(inpRead == 6){
+            if(type == 'S')
+                *first = newOrder('S', ' ', time, x, y, z, buffer);
+            else
+                *first = newOrder('E', type, time, x, y, z, buffer);
+            return 1;
+        } else if(inpRead == 3){
+            *first = newOrder('s', ' ', time, -1, -1, -1, buffer);
+            return 1;
+        }
+        return 0;
+    }
+
+    if(*line == 'R'){
+        inpRead = sscanf(line, "%c %d %d %d %d %d %d %d %d", &R, &ta, &tb,
+                                    &c[0], &c[1], &c[2], &c[3], &c[4], &c[5]);
+        if(inpRead == 9){
+            *first = newRegionOrder('B', ta, c);
+            if(tb >= ta)
+                *second = newRegionOrder('b', tb, c);
+        } else if(inpRead == 6){
+            *first = newOrder('R', ' ', ta, c[0], c[1], c[2], NULL);
+            if(tb >= ta)
+                *second = newOrder('r', ' ', tb, c[0], c[1], c[2], NULL);
+        } else if(inpRead == 4){
+            /* x contains floor */
+            *first = newOrder('P', ' ', ta, -1, -1, c[0], NULL);
+            if(tb >= ta)
+                *second = newOrder('p', ' ', tb, -1, -1, c[0], NULL);
+        } else
+            return 0;
+        return *second == NULL ? 1 : 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ *  File name: orders.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: Header file for the Order data type, which holds every
+ *          event read from the car input (.inp) and restriction files, and
+ *          for the functions that load those files into time ordered lists
+ *
+ *  Data Type: Order
+ *              Contains any important information for each action to take
+ *
+ *  Function list:
+ *    A) Initialization & Termination
+ *        newOrder
+ *        OrderDestroy
+ *
+ *    B) Loading
+ *        loadInstructionFile
+ *        loadRestrictionFile
+ *        inpresShuffleOrder
+ *        parseOrderLine
+ *
+ *    C) Compare
+ *        compareOrderTime
+ *
+ *  Non-standard dependencies:
+ *    LinkedList.h
+ *    defs.h
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __orders__h
+#define __orders__h 1
+
+#include"defs.h"
+#include"LinkedList.h"
+
+
+/*
+ *  Data Type: Order
+ *
+ *  Fields:
+ *      char type - descriptor character of an associated type to the order
+ *      char action - descriptor character of the action to take
+ *          Example:
+ *              a new car coming into the park would have an action descriptor
+ *          'E' while one leaving would have an action descriptor 'S'
+ *      int x, y, z - respective 3D coordinates
+ *      int x2, y2, z2 - opposite corner of a region, the same as x, y, z for
+ *          any other order
+ *      int time - time of execution
+ *      char *id - string identifier (used to identify vehicles)
+ */
+
+typedef struct _order{
+    /* char action - describes type of order:
+     * E is a car entering the park
+     * R is restrict, r is unrestrict (coordinate)
+     * P is restrict, p is unrestrict (whole floor)
+     * B is restrict, b is unrestrict (region, box from x y z to x2 y2 z2)
+     * s indicates car is leaving using ID
+     * S indicates car is leaving using coordinates
+     *
+     * char type - desired access point type of an entering car
+     */
+    char type;
+    char action;
+    int x, y, z;                  /* coordinates associated with new order */
+    int x2, y2, z2;               /* far corner of a region (B and b) */
+    int time;
+    char *id;
+} Order;
+
+
+/*
+ *  Function:
+ *    newOrder
+ *
+ *  Description:
+ *    allocates a new Order, copying the identifier if one is given
+ *
+ *  Arguments:
+ *    char action, char type - descriptor characters
+ *    int time - time of execution
+ *    int x, y, z - coordinates
+ *    char *id - vehicle identifier (may be NULL)
+ *
+ *  Return value:
+ *    Order * - new order
+ */
+
+Order *newOrder(char action, char type, int time, int x, int y, int z,
+                                                                char *id);
+
+
+/*
+ *  Function:
+ *    OrderDestroy
+ *
+ *  Description:
+ *    frees all memory previously allocated in struct Order
+ *
+ *  Purpose:
+ *    to send as pointer to freeLinkedList function in order to free the
+ *  order's list
+ */
+
+void OrderDestroy(Item order);
+
+
+/*
+ *  Functions:
+ *    loadInstructionFile
+ *    loadRestrictionFile
+ *
+ *  Description:
+ *    load the instructions given in the .inp file (or the restrictions given
+ *  in the restriction file) and list them in reverse order using struct Order
+ *  in a LinkedList
+ *
+ *  Arguments:
+ *    char *inpfile / char *resfile - name of the file to read
+ *
+ *  Return value:
+ *    LinkedList * - reverse ordered list of Orders, NULL if file can't be read
+ */
+
+LinkedList *loadInstructionFile(char *inpfile);
+LinkedList *loadRestrictionFile(char *resfile);
+
+
+/*
+ *  Function:
+ *    inpresShuffleOrder
+ *
+ *  Description:
+ *    merges 2 reverse ordered lists of Orders into one list in increasing
+ *  time order, restrictions first when times are the same
+ *
+ *    caution: frees both input lists
+ */
+
+LinkedList *inpresShuffleOrder(LinkedList *inpList, LinkedList *resList);
+
+
+/*
+ *  Function:
+ *    parseOrderLine
+ *
+ *  Description:
+ *    converts a single line of either input file format into Orders, exactly
+ *  as the file loaders would. A restriction line with an end time produces
+ *  a second Order to lift it
+ *
+ *  Arguments:
+ *    char *line - line of text
+ *    Order **first - reference to save the first Order
+ *    Order **second - reference to save the lifting Order (or NULL)
+ *
+ *  Return value:
+ *    int - number of Orders produced (0 if the line isn't an order)
+ */
+
+int parseOrderLine(char *line, Order **first, Order **second);
+
+
+/*
+ *  Function:
+ *    compareOrderTime
+ *
+ *  Description:
+ *    returns 1 if first order is applied no later than the second one
+ */
+
+int compareOrderTime(Item order1, Item order2);
+
+#endif
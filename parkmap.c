@@ -18,6 +18,7 @@
 #include"parkmap.h"
 #include"point.h"
 #include"graphL.h"
+#include"engine.h"
 #include"queue.h"
 #include"prioQ.h"
 #include"htable.h"
@@ -26,6 +27,7 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
+#include<limits.h>
 
 
 /* globally defined buffer size */
@@ -34,6 +36,8 @@
 #define CHARSIZE 256
 /* globally defined hash calculation P constant */
 #define HASHCONSTANT 17
+/* bits of each word of the free spot bitmaps, all of an unsigned long */
+#define WBITS ((int) (CHAR_BIT * sizeof(unsigned long)))
 
     /* toIndex - macro to convert coordinates into an 1 dimensional index
      *
@@ -53,26 +57,35 @@
 
 
 /*
- *  Data Type: Map
+ *  Data Type: MapBase
  *
  *  Description: 
- *      Most fundamental struct of the program, contains all information with 
- *  direct connection to the present parkMap configuration including its
- *  graph (if calculated through buildGraph function) and all the fields required
- *  to calculate an ideal path
+ *      Part of a park configuration that never changes while cars come and
+ *  go: the map representation as read from the file, the special points and
+ *  the park graph. Built once, it may be shared by any number of Maps, even
+ *  from different threads, since none of them writes to it
  *
  */
 
-struct _map{
+struct _mapBase{
     int N, M;             /* floor dimensions NxM */
     int P;                /* num of floors */
     int E, S;             /* num of entrances (E) and peon access points (S) */
     int difS;             /* num of different type of peon access points */
-    int n_spots, n_av;    /* total number of spots; number of available ones */
-    int *avalP;           /* table with total number of free spots per floor */
+    int n_spots;          /* total number of spots */
+
+    /* spots are numbered from 0, in the order of their car path nodes, so
+     * floor by floor: spotId of a car path node is its spot's number (-1 if
+     * it isn't a spot), spotNode the other way round, floorSpots[p] the first
+     * number of floor p and floorWords[p] the first word of its bitmap (see
+     * Map), P + 1 of each
+     */
+    int *spotId, *spotNode;
+    int *floorSpots, *floorWords;
 
     /* table of matrices to represent multiple floor map 
      * mapRep[x][y][z] indicates the descriptive character of that position
+     * as read from the configuration file
      */
     char ***mapRep; 
 
@@ -86,16 +99,6 @@ struct _map{
     LinkedList **ramps;   /* table to save ramp Points, index corresponds
                            to the floor */
 
-    HashTable *pCars;     /* Hash table with information about parked
-                                    cars*/
-
-    int lastEntrance, lastAccess;
-
-    /* pre-initialized dijkstra vectors */
-    int *st;
-    int *wt;
-    PrioQ *PQ;
-
     /* park configuration graph
      * has an adjacency matrix representation of a directed weighted graph
      *
@@ -116,17 +119,77 @@ struct _map{
      *      Then, there will be only one edge coming out of that node pointing
      *  at the mother node of type 'C'
      *
+     * its active flags hold the initial state, each Map works on a view
      */
     GraphL *Graph;               
+
+    /* the graph's edges as arrays, going out of and into each node (see
+     * GedgeTable) */
+    int *outStart, *outTo, *outCost;
+    int *inStart, *inFrom, *inCost;
+};
+
+
+/*
+ *  Data Type: Map
+ *
+ *  Description: 
+ *      Most fundamental struct of the program, contains all information with 
+ *  direct connection to the present parkMap configuration: the shared
+ *  MapBase and everything one simulation changes (occupancy, active nodes,
+ *  parked cars) plus all the fields required to calculate an ideal path
+ *
+ */
+
+struct _map{
+    MapBase *base;        /* shared configuration */
+    int ownsBase;         /* 1 if the base is destroyed with the Map */
+
+    int N, M, P;          /* copies of the base dimensions */
+
+    /* one bitmap per floor of the spots cars may take, WBITS bits a word:
+     * bit i of floor p, at word floorWords[p] + i / WBITS, is spot
+     * floorSpots[p] + i, set while its car path node is on. The spots of a
+     * floor restricted as a whole keep their bits but aren't counted
+     */
+    unsigned long *freeSpots;
+    char *floorShut;
+
+    /* 1 for each spot, by number, with a car in it */
+    char *taken;
+
+    /* descriptive character of each car path node, like mapRep but changed
+     * as spots are freed
+     */
+    char *rep;
+
+    HashTable *pCars;     /* Hash table with information about parked
+                                    cars*/
+
+    int lastEntrance, lastAccess;
+    int lastFreed;        /* spot node last freed, for the rankings */
+    int nTaken;           /* times a spot was taken, for the rankings */
+
+    /* answers findPath, told about every node turned on or off */
+    Engine *engine;
+    /* one of the same kind for queryCost, made when first asked, so the
+     * path table findPath gives stays good */
+    Engine *probe;
+
+    /* view of the base graph with this simulation's active nodes */
+    GraphL *Graph;
+
+    /* last move written to the output, to validate the next one */
+    EstadoSaida out;
 };
 
 
 /*
  *  Function:
- *      mapInit
+ *      baseRead
  *  Description:
  *      Reads a map configuration file and saves information into its map 
- *  structure
+ *  base structure
  *  
  *      Note that some of the fields aren't initialized until Graph is build and 
  *  this is a prerequesite for applying that function to the graph.
@@ -135,16 +198,16 @@ struct _map{
  *      char *filename string with the name of the map configuration file
  *          
  *  Return value:
- *      Map * - generated Map 
+ *      MapBase * - generated base, NULL if the file can't be read
  *
  *  Secondary effects:
  *      None
  */
 
-Map *mapInit(char *filename) {
+static MapBase *baseRead(char *filename) {
     FILE *fp;                                  /* input file stream pointer */
     int it;                                    /* fscanf tester */ 
-    Map *parkMap;                              /* pointer to fill and return */
+    MapBase *base;                             /* pointer to fill and return */
     int n, m, p, i;                            /* iteration variables */
     char auxChar, desc, *auxPChar;             /* auxiliary chars */
     char ID[SIZE];                             /* buffer string */
@@ -152,34 +215,45 @@ Map *mapInit(char *filename) {
     int atE = 0, atA = 0;                      /* control variables for access 
                                                 and entrance tables */
 
-    parkMap = (Map*) malloc(sizeof(Map));
-
     fp = fopen( filename, "r");
+    if(fp == NULL){
+        fprintf(stderr, "Couldn't open configuration file %s\n", filename);
+        return NULL;
+    }
 
-    it = fscanf(fp, "%d %d %d %d %d\n", &parkMap->N, &parkMap->M, &parkMap->P,
-                &parkMap->E, &parkMap->S);
+    base = (MapBase*) malloc(sizeof(MapBase));
+    base->ramps = NULL;
+    base->Graph = NULL;
+    base->outStart = NULL;
+    base->outTo = NULL;
+    base->outCost = NULL;
+    base->inStart = NULL;
+    base->inFrom = NULL;
+    base->inCost = NULL;
+
+    it = fscanf(fp, "%d %d %d %d %d\n", &base->N, &base->M, &base->P,
+                &base->E, &base->S);
     if(it != 5){
         fprintf(stderr, "First line of map config has wrong format\n");
         exit(1);
     }
 
-    /* initialize parking spot counters */
-    parkMap->n_spots = 0;
-    parkMap->n_av = 0;
-    parkMap->avalP = (int *) malloc(sizeof(int) * parkMap->P);
-    for(i = 0; i < parkMap->P; i++){
-        parkMap->avalP[i] = 0;
-    }
+    /* spots are counted and numbered with the graph */
+    base->n_spots = 0;
+    base->spotId = NULL;
+    base->spotNode = NULL;
+    base->floorSpots = NULL;
+    base->floorWords = NULL;
 
     /* initialize number of diferent access types to zero */
-    parkMap->difS = 0;
+    base->difS = 0;
 
     /* initializing representation matrices */
-    parkMap->mapRep = (char***) malloc(sizeof(char**) * parkMap->N);
-    for(n = 0; n < parkMap->N; n++) {
-        parkMap->mapRep[n] = (char**) malloc(sizeof(char*) * parkMap->M);
-        for(m = 0; m < parkMap->M; m++){
-            parkMap->mapRep[n][m] = (char*) malloc(sizeof(char) * parkMap->P);
+    base->mapRep = (char***) malloc(sizeof(char**) * base->N);
+    for(n = 0; n < base->N; n++) {
+        base->mapRep[n] = (char**) malloc(sizeof(char*) * base->M);
+        for(m = 0; m < base->M; m++){
+            base->mapRep[n][m] = (char*) malloc(sizeof(char) * base->P);
         }
     }
 
@@ -187,8 +261,8 @@ Map *mapInit(char *filename) {
      *
      * to be filled with point structs for each entrance/access point
      * */
-    parkMap->accessPoints = (Point**) malloc(sizeof(Point*) * parkMap->S);
-    parkMap->entrancePoints = (Point**) malloc(sizeof(Point*) * parkMap->E);
+    base->accessPoints = (Point**) malloc(sizeof(Point*) * base->S);
+    base->entrancePoints = (Point**) malloc(sizeof(Point*) * base->E);
 
     /* initialize auxiliar accessPoint variables
      * accessTable has size CHARSIZE for it must be able to house any index
@@ -200,17 +274,17 @@ Map *mapInit(char *filename) {
      * accessTypes LinkedList in the other hand will hold each different type of
      * acces type descriptor character
      */
-    parkMap->accessTable = (int *) malloc(sizeof(int) * CHARSIZE);
+    base->accessTable = (int *) malloc(sizeof(int) * CHARSIZE);
     for(i = 0; i < CHARSIZE; i++)
-        parkMap->accessTable[i] = -1;
-    parkMap->accessTypes = initLinkedList();
+        base->accessTable[i] = -1;
+    base->accessTypes = initLinkedList();
 
     /* start reading rest of file */
-    for(p = 0; p < parkMap->P; p++) {
+    for(p = 0; p < base->P; p++) {
         /* read first m lines starting from beggining of floor contruction */
-        for(m = parkMap->M - 1; m >= 0 ; m--) {
-            for(n = 0; n < parkMap->N; n++) {
-                parkMap->mapRep[n][m][p] = (char) fgetc(fp); 
+        for(m = base->M - 1; m >= 0 ; m--) {
+            for(n = 0; n < base->N; n++) {
+                base->mapRep[n][m][p] = (char) fgetc(fp); 
             }
             while( '\n' != fgetc(fp));  /* skip to next line in file */
         }
@@ -227,7 +301,7 @@ Map *mapInit(char *filename) {
                         exit(1);
                     }
                     /* save information in entrance Points table */
-                    parkMap->entrancePoints[atE] = newPoint(ID, desc, x, y, z);
+                    base->entrancePoints[atE] = newPoint(ID, desc, x, y, z);
                     ID[0] = '\0';
                     atE++;
                     break;
@@ -239,18 +313,18 @@ Map *mapInit(char *filename) {
                         exit(1);
                     }
                     /* save information in access points  table */
-                    parkMap->accessPoints[atA] = newPoint(ID, desc, x, y, z);
+                    base->accessPoints[atA] = newPoint(ID, desc, x, y, z);
                     ID[0] = '\0';
 
                     /* check if first time in Lookup table */
-                    if(parkMap->accessTable[ (int) desc ] == -1) {
-                        parkMap->difS++;
+                    if(base->accessTable[ (int) desc ] == -1) {
+                        base->difS++;
                         auxPChar = (char *) malloc(sizeof(char));
                         *auxPChar= desc;
-                        parkMap->accessTypes =  insertUnsortedLinkedList(
-                                                parkMap->accessTypes,
+                        base->accessTypes =  insertUnsortedLinkedList(
+                                                base->accessTypes,
                                                 (Item) auxPChar);
-                        parkMap->accessTable[ (int) desc ] = 0;
+                        base->accessTable[ (int) desc ] = 0;
                     }
 
                     atA++;
@@ -265,22 +339,62 @@ Map *mapInit(char *filename) {
 
     fclose(fp);
 
-    parkMap->lastEntrance = -1;
-    parkMap->lastAccess = -1;
-
-    return parkMap;
+    return base;
 }               
 
 
 /*
  *  Function:
- *      buildGraphs
+ *      numberSpots
+ *  Description:
+ *      counts and numbers the spots of the base, floor by floor, and places
+ *  the bitmap of each floor in the Maps' free spot bitmaps
+ *
+ *  Arguments:
+ *      Pointer to struct MapBase
+ *
+ *  Return value:
+ *      none
+ */
+
+static void numberSpots(MapBase *base) {
+    int N = base->N, M = base->M, P = base->P;
+    int n, m, p;
+
+    base->spotId = (int *) malloc(sizeof(int) * N * M * P);
+    base->spotNode = (int *) malloc(sizeof(int) * N * M * P);
+    base->floorSpots = (int *) malloc(sizeof(int) * (P + 1));
+    base->floorWords = (int *) malloc(sizeof(int) * (P + 1));
+    base->n_spots = 0;
+    base->floorWords[0] = 0;
+    for(p = 0; p < P; p++){
+        base->floorSpots[p] = base->n_spots;
+        for(m = 0; m < M; m++)
+            for(n = 0; n < N; n++){
+                if(strchr(".x", (int) base->mapRep[n][m][p]) == NULL){
+                    base->spotId[toIndex(n,m,p,N,M,P)] = -1;
+                    continue;
+                }
+                base->spotId[toIndex(n,m,p,N,M,P)] = base->n_spots;
+                base->spotNode[base->n_spots++] = toIndex(n,m,p,N,M,P);
+            }
+        base->floorWords[p + 1] = base->floorWords[p] +
+                    (base->n_spots - base->floorSpots[p] + WBITS - 1) / WBITS;
+    }
+    base->floorSpots[P] = base->n_spots;
+    return;
+}
+
+
+/*
+ *  Function:
+ *      baseBuildGraph
  *  Description:
  *      uses the previously built representation Matrix (mapRep) to compute the
  *  parkmap directed weighted graph
  *
  *  Arguments:
- *      Pointer to struct Map
+ *      Pointer to struct MapBase
  *
  *  Return value:
  *      none
@@ -290,7 +404,7 @@ Map *mapInit(char *filename) {
  *      weighted graph
  */
 
-void buildGraphs(Map *parkMap) {
+static void baseBuildGraph(MapBase *base) {
     int n, m, p, i;    /* iteration variables */
     int N, M ,P;
     int x, y, z;       /* point coordinates */
@@ -300,9 +414,9 @@ void buildGraphs(Map *parkMap) {
     int gSize;
     LinkedList *t;
 
-    N = parkMap->N;
-    M = parkMap->M;
-    P = parkMap->P;
+    N = base->N;
+    M = base->M;
+    P = base->P;
 
     /* initializing the graphs
      * the total number of nodes is twice the number of points in
@@ -321,23 +435,23 @@ void buildGraphs(Map *parkMap) {
      *
      * --------------------------
      *
-     *  Last parkMap->difS spots are specially reserved for access point types
+     *  Last base->difS spots are specially reserved for access point types
      */
-    gSize = N * M * P * 2 + parkMap->difS;
+    gSize = N * M * P * 2 + base->difS;
     Graph = Ginit(gSize);
 
-    /* load values into parkMap->accessTable */
-    t = parkMap->accessTypes;
-    for(i = gSize - parkMap->difS; i < gSize; i++) {
+    /* load values into base->accessTable */
+    t = base->accessTypes;
+    for(i = gSize - base->difS; i < gSize; i++) {
         auxPChar = (char*) getItemLinkedList(t);
-        parkMap->accessTable[(int) *auxPChar] = i;
+        base->accessTable[(int) *auxPChar] = i;
         t = getNextNodeLinkedList(t);
     }
 
-    /* initialize ramps table in parkMap */
-    parkMap->ramps = (LinkedList**) malloc(sizeof(LinkedList*) * P);
+    /* initialize ramps table in base */
+    base->ramps = (LinkedList**) malloc(sizeof(LinkedList*) * P);
     for(i = 0; i < P; i++)
-        parkMap->ramps[i] = initLinkedList();
+        base->ramps[i] = initLinkedList();
     
     /* start computing using the representation matrix
      *
@@ -348,23 +462,23 @@ void buildGraphs(Map *parkMap) {
      */
 
     /* useful macros to get neighbour chars */
-    #define LEFT parkMap->mapRep[n-1][m][p]
-    #define RIGHT parkMap->mapRep[n+1][m][p]
-    #define TOP parkMap->mapRep[n][m+1][p]
-    #define BOTTOM parkMap->mapRep[n][m-1][p]
+    #define LEFT base->mapRep[n-1][m][p]
+    #define RIGHT base->mapRep[n+1][m][p]
+    #define TOP base->mapRep[n][m+1][p]
+    #define BOTTOM base->mapRep[n][m-1][p]
 
     for(p = 0; p < P; p++){
         for(m = 0; m < M; m++){
             for(n = 0; n < N; n++){
-                switch(parkMap->mapRep[n][m][p]){
+                switch(base->mapRep[n][m][p]){
                     case '@': break;
                     case 'a': break;
                     case 'e': break;   /* will compute afterwords seperately */
                     case 'u':
                         /* insert upper ramp in appropriate floor ramps list */
                         auxRamp = newPoint("B", 'u', n, m, p);
-                        parkMap->ramps[p] = insertUnsortedLinkedList(
-                                                parkMap->ramps[p], 
+                        base->ramps[p] = insertUnsortedLinkedList(
+                                                base->ramps[p], 
                                                 (Item) auxRamp);
 
                         /* check for possibility of edge with neighbours */
@@ -438,8 +552,8 @@ void buildGraphs(Map *parkMap) {
                     case 'd':
                         /* insert upper ramp in appropriate floor ramps list */
                         auxRamp = newPoint("B", 'd', n, m, p);
-                        parkMap->ramps[p] = insertUnsortedLinkedList(
-                                                parkMap->ramps[p], 
+                        base->ramps[p] = insertUnsortedLinkedList(
+                                                base->ramps[p], 
                                                 (Item) auxRamp);
 
                         /* check for possibility of edge with neighbours */
@@ -575,8 +689,6 @@ void buildGraphs(Map *parkMap) {
                                                
                         break;
                     case 'x':
-                        parkMap->n_av--;/* to counter-act next increment '.' */
-                        parkMap->avalP[p]--;
                         GdeactivateNode(Graph, toIndex(n,m,p,N,M,P));
 
                         /* don't break, continue through to case '.' to add
@@ -585,11 +697,6 @@ void buildGraphs(Map *parkMap) {
                          */
                     
                     case '.':
-                        /* increase in number of available spots */
-                        parkMap->n_spots++;
-                        parkMap->n_av++;
-                        parkMap->avalP[p]++;
-
                         /* check for possibility of edge with neighbours */
                         /* 
                          * only checking peon graph because no car will 
@@ -642,18 +749,18 @@ void buildGraphs(Map *parkMap) {
     /* end of for cycle */
 
     /* go through entrance points and make new edges */
-    for(i = 0; i < parkMap->E; i++) {
-        x = getx(parkMap->entrancePoints[i]);
-        y = gety(parkMap->entrancePoints[i]);
-        z = getz(parkMap->entrancePoints[i]);
+    for(i = 0; i < base->E; i++) {
+        x = getx(base->entrancePoints[i]);
+        y = gety(base->entrancePoints[i]);
+        z = getz(base->entrancePoints[i]);
 
         if(x == 0) /* at the left wall, add path to the right of the entrance */
             GinsertEdge(Graph, toIndex(x,y,z,N,M,P),
                         toIndex(x+1,y,z,N,M,P), 1);
-        if(x == parkMap->N - 1)                 /* at the right wall ... */
+        if(x == base->N - 1)                 /* at the right wall ... */
             GinsertEdge(Graph, toIndex(x,y,z,N,M,P),
                         toIndex(x-1,y,z,N,M,P), 1);
-        if(y == parkMap->M - 1)                 /* at the Top wall */
+        if(y == base->M - 1)                 /* at the Top wall */
             GinsertEdge(Graph, toIndex(x,y,z,N,M,P),
                         toIndex(x,y-1,z,N,M,P), 1);
         if(y == 0)                              /* at the bottom wall */
@@ -661,35 +768,38 @@ void buildGraphs(Map *parkMap) {
                         toIndex(x,y+1,z,N,M,P), 1);
     }
 
+    /* entrances and ramps, car and peon, close with their floor */
+    GsetFloors(Graph, N * M, P, 2);
+    for(i = 0; i < base->E; i++)
+        GlinkNodeToFloor(Graph, toIndex(getx(base->entrancePoints[i]),
+                                        gety(base->entrancePoints[i]),
+                                        getz(base->entrancePoints[i]), N,M,P));
+    for(p = 0; p < P; p++)
+        for(t = base->ramps[p]; t != NULL; t = getNextNodeLinkedList(t)){
+            auxRamp = (Point *) getItemLinkedList(t);
+            GlinkNodeToFloor(Graph, toIndex(getx(auxRamp), gety(auxRamp),
+                                                                p, N, M, P));
+            GlinkNodeToFloor(Graph, toIndex(getx(auxRamp), gety(auxRamp),
+                                                        p, N, M, P) + N*M*P);
+        }
+
     /* connect each of the access points to its special type node */
-    for(i = 0; i < parkMap->S; i++) {
-        auxAccess = parkMap->accessPoints[i];
+    for(i = 0; i < base->S; i++) {
+        auxAccess = base->accessPoints[i];
         /* inserting edge on node correspondent to the access point 
-         * towards the general type node as given per parkMap->accessTable
+         * towards the general type node as given per base->accessTable
          * lookup table
          * */
         GinsertEdge(Graph,
                     toIndex(getx(auxAccess), gety(auxAccess), getz(auxAccess),
                         N, M, P) + N * M * P,
-                    parkMap->accessTable[(int) getDesc(auxAccess) ], 0);
+                    base->accessTable[(int) getDesc(auxAccess) ], 0);
     }
 
-    parkMap->Graph = Graph;
-    /* initializing hastable with m = n_spots and p = 17 (prime number) */
-    parkMap->pCars = HTinit(parkMap->n_spots, 17);  
-
-    /* pre-Initialize weight and path tables, posterior function requirement */
-    parkMap->st = (int*) malloc(sizeof(int) * Gnodes(parkMap->Graph));
-    parkMap->wt = (int*) malloc(sizeof(int) * Gnodes(parkMap->Graph));
-
-    /* load desired values onto tables */
-    for(i = 0; i < Gnodes(parkMap->Graph); i++) {
-        parkMap->st[i] = -1;
-        parkMap->wt[i] = NOCON;
-    }
-
-    /* initialize priority queue, posterior function requirement */
-    parkMap->PQ = PQinit(parkMap->wt, Gnodes(parkMap->Graph));
+    base->Graph = Graph;
+    GedgeTable(Graph, 0, &base->outStart, &base->outTo, &base->outCost);
+    GedgeTable(Graph, 1, &base->inStart, &base->inFrom, &base->inCost);
+    numberSpots(base);
 
     /* undefine global macros */
     #undef LEFT
@@ -701,6 +811,237 @@ void buildGraphs(Map *parkMap) {
 }
 
 
+/*
+ * Auxiliary-function: setSpotFree
+ *
+ * Description:
+ *      sets (or clears) the bit of a spot in its floor's bitmap, nothing for
+ *  other nodes
+ */
+
+static void setSpotFree(Map *parkMap, int node, int active){
+    MapBase *base = parkMap->base;
+    int id, p, bit;
+
+    if(node >= parkMap->N * parkMap->M * parkMap->P ||
+                                                    base->spotId[node] < 0)
+        return;
+    id = base->spotId[node];
+    p = toCoordinateZ(node, parkMap->N, parkMap->M, parkMap->P);
+    bit = id - base->floorSpots[p];
+    if(active)
+        parkMap->freeSpots[base->floorWords[p] + bit / WBITS] |=
+                                                        1UL << (bit % WBITS);
+    else
+        parkMap->freeSpots[base->floorWords[p] + bit / WBITS] &=
+                                                    ~(1UL << (bit % WBITS));
+    return;
+}
+
+
+/*
+ * Auxiliary-function: setSpotTaken
+ *
+ * Description:
+ *      marks whether there's a car in the spot node, nothing for other nodes
+ */
+
+static void setSpotTaken(Map *parkMap, int node, int taken){
+    if(node < parkMap->N * parkMap->M * parkMap->P &&
+                                        parkMap->base->spotId[node] >= 0)
+        parkMap->taken[parkMap->base->spotId[node]] = (char) taken;
+    return;
+}
+
+
+/*
+ * Auxiliary-function: isSpotTaken
+ *
+ * Description:
+ *      returns 1 if node is a spot with a car in it, 0 otherwise
+ */
+
+static int isSpotTaken(Map *parkMap, int node){
+    if(node < parkMap->N * parkMap->M * parkMap->P &&
+                                        parkMap->base->spotId[node] >= 0)
+        return parkMap->taken[parkMap->base->spotId[node]];
+    return 0;
+}
+
+
+/* number of bits set in a word of any width up to 255 bits, the masks
+ * being 01..., 0011..., 00001111... repeated over the whole word */
+static int countBits(unsigned long w){
+    w = w - ((w >> 1) & (~0UL / 3));
+    w = (w & (~0UL / 15 * 3)) + ((w >> 2) & (~0UL / 15 * 3));
+    w = (w + (w >> 4)) & (~0UL / 255 * 15);
+    return (int) ((w * (~0UL / 255)) >> (WBITS - CHAR_BIT));
+}
+
+
+/*
+ *  Function:
+ *      instanceBuild
+ *  Description:
+ *      creates everything a simulation changes, in the state given by the
+ *  configuration file
+ *
+ *  Arguments:
+ *      Pointer to struct Map, with its base graph already built
+ *
+ *  Return value:
+ *      none
+ */
+
+static void instanceBuild(Map *parkMap) {
+    MapBase *base = parkMap->base;
+    int n, m, p, i;
+    int N, M, P;
+
+    N = parkMap->N;
+    M = parkMap->M;
+    P = parkMap->P;
+
+    parkMap->rep = (char *) malloc(sizeof(char) * N * M * P);
+    for(p = 0; p < P; p++)
+        for(m = 0; m < M; m++)
+            for(n = 0; n < N; n++)
+                parkMap->rep[toIndex(n, m, p, N, M, P)] =
+                                                    base->mapRep[n][m][p];
+
+    /* the adjacency lists are shared, the active flags are not */
+    parkMap->Graph = Gview(base->Graph);
+
+    /* spots taken in the configuration file are off in the graph */
+    parkMap->freeSpots = (unsigned long *) calloc(base->floorWords[P] + 1,
+                                                    sizeof(unsigned long));
+    parkMap->floorShut = (char *) calloc(P, sizeof(char));
+    parkMap->taken = (char *) calloc(base->n_spots + 1, sizeof(char));
+    for(i = 0; i < base->n_spots; i++)
+        if(GisNodeActive(parkMap->Graph, base->spotNode[i]))
+            setSpotFree(parkMap, base->spotNode[i], 1);
+        else
+            parkMap->taken[i] = 1;
+
+    /* initializing hastable with m = n_spots and p = 17 (prime number) */
+    parkMap->pCars = HTinit(base->n_spots, 17);
+
+    parkMap->engine = Einit(Edefault(), parkMap, parkMap->Graph);
+
+    return;
+}
+
+
+/*
+ *  Function:
+ *      newMap
+ *  Description:
+ *      creates a Map over a base, without its simulation state
+ */
+
+static Map *newMap(MapBase *base) {
+    Map *parkMap;
+
+    parkMap = (Map*) malloc(sizeof(Map));
+    parkMap->base = base;
+    parkMap->ownsBase = 0;
+    parkMap->N = base->N;
+    parkMap->M = base->M;
+    parkMap->P = base->P;
+    parkMap->freeSpots = NULL;
+    parkMap->floorShut = NULL;
+    parkMap->taken = NULL;
+    parkMap->rep = NULL;
+    parkMap->pCars = NULL;
+    parkMap->engine = NULL;
+    parkMap->probe = NULL;
+    parkMap->Graph = NULL;
+    parkMap->lastEntrance = -1;
+    parkMap->lastAccess = -1;
+    parkMap->lastFreed = -1;
+    parkMap->nTaken = 0;
+    inicia_estado_saida(&parkMap->out);
+
+    return parkMap;
+}
+
+
+/*
+ *  Function:
+ *      mapInit
+ *  Description:
+ *      Reads a map configuration file and saves information into its map
+ *  structure. The Map gets a base of its own
+ *
+ *      Note that some of the fields aren't initialized until Graph is build and
+ *  this is a prerequesite for applying that function to the graph.
+ *
+ *  Arguments:
+ *      char *filename string with the name of the map configuration file
+ *
+ *  Return value:
+ *      Map * - generated Map, NULL if the file can't be read
+ *
+ *  Secondary effects:
+ *      None
+ */
+
+Map *mapInit(char *filename) {
+    MapBase *base;
+    Map *parkMap;
+
+    base = baseRead(filename);
+    if(base == NULL)
+        return NULL;
+
+    parkMap = newMap(base);
+    parkMap->ownsBase = 1;
+    return parkMap;
+}
+
+
+/*
+ *  Function:
+ *      buildGraphs
+ *  Description:
+ *      computes the parkmap directed weighted graph (unless its base already
+ *  has it) and the simulation state of the Map
+ *
+ *  Arguments:
+ *      Pointer to struct Map
+ *
+ *  Return value:
+ *      none
+ */
+
+void buildGraphs(Map *parkMap) {
+    if(parkMap->base->Graph == NULL)
+        baseBuildGraph(parkMap->base);
+    instanceBuild(parkMap);
+    return;
+}
+
+
+MapBase *mapBaseInit(char *filename) {
+    MapBase *base;
+
+    base = baseRead(filename);
+    if(base == NULL)
+        return NULL;
+    baseBuildGraph(base);
+    return base;
+}
+
+
+Map *mapInitShared(MapBase *base) {
+    Map *parkMap;
+
+    parkMap = newMap(base);
+    instanceBuild(parkMap);
+    return parkMap;
+}
+
+
 /*
  *  Function:
  *      mapPrintStd
@@ -719,25 +1060,30 @@ void buildGraphs(Map *parkMap) {
 void mapPrintStd(Map *parkMap) {
     int n, m, p, i; /* iteration variables */
     Point *ap;
+    MapBase *base;
 
     if(!parkMap)
         return;
+    base = parkMap->base;
     
-    for(p = 0; p < parkMap->P; p++) {
-        for(m = parkMap->M - 1; m >= 0; m--) {
-            for(n = 0; n < parkMap->N; n++)
-                fprintf(stdout, "%c", parkMap->mapRep[n][m][p]);
+    for(p = 0; p < base->P; p++) {
+        for(m = base->M - 1; m >= 0; m--) {
+            for(n = 0; n < base->N; n++)
+                fprintf(stdout, "%c", parkMap->rep == NULL ?
+                            base->mapRep[n][m][p] :
+                            parkMap->rep[toIndex(n, m, p, base->N, base->M,
+                                                                base->P)]);
             fprintf(stdout, "\n");
         }
         fprintf(stdout, "+\n");
     }
 
-    for(i = 0; i < parkMap->E; i++) {
-        ap = parkMap->entrancePoints[i];
+    for(i = 0; i < base->E; i++) {
+        ap = base->entrancePoints[i];
         pointPrintStd(ap);
     }
-    for(i = 0; i < parkMap->S; i++) {
-        ap = parkMap->accessPoints[i];
+    for(i = 0; i < base->S; i++) {
+        ap = base->accessPoints[i];
         pointPrintStd(ap);
     }
 
@@ -746,6 +1092,13 @@ void mapPrintStd(Map *parkMap) {
 }
 
 
+void writeMove(FILE *fp, Map *parkMap, char *ID, int time, int x, int y,
+                                                        int z, char move){
+    escreve_saida_r(&parkMap->out, fp, ID, time, x, y, z, move);
+    return;
+}
+
+
 /* 
  * Function: writeOutput
  *
@@ -771,7 +1124,7 @@ void mapPrintStd(Map *parkMap) {
 void writeOutput(FILE *fp, Map *parkMap, int *st, int cost, int time, char *ID, 
                                                 char accessType, int pathSize){
     int *path;
-    int i, dest, j;
+    int j;
     int N, M, P;
     int TIME[3];             /* array to save important times */
     int test = 0;            /* to test if at least 1 m or p is printed */
@@ -782,18 +1135,11 @@ void writeOutput(FILE *fp, Map *parkMap, int *st, int cost, int time, char *ID,
     M = parkMap->M;
     P = parkMap->P;
 
-    dest = parkMap->accessTable[ (int) accessType];
-
-    /* fill path vector with passby nodes
-     * starts at the access point node and goes back until entrace is reached
-     */
     path = (int *) malloc(sizeof(int) * (pathSize));
-    for(j = pathSize - 1, i = st[dest]; j >= 0; j--, i = st[i]){
-        path[j] = i; 
-    }
+    getPathNodes(parkMap, st, accessType, path, pathSize);
 
     /* write entering output */
-    escreve_saida(fp, ID, time, toCoordinateX(path[0], N, M, P),
+    writeMove(fp, parkMap, ID, time, toCoordinateX(path[0], N, M, P),
                                 toCoordinateY(path[0], N, M, P),
                                 toCoordinateZ(path[0], N, M, P),
                                 'i');
@@ -809,20 +1155,20 @@ void writeOutput(FILE *fp, Map *parkMap, int *st, int cost, int time, char *ID,
          */
         if(path[j] - path[j - 1] != path[j + 1] - path[j]){
             test = 1;
-            escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+            writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                         toCoordinateY(path[j], N, M, P),
                                         toCoordinateZ(path[j], N, M, P), 'm');
         }
     }
     if(test == 0){
-        escreve_saida(fp, ID, TIME[0] + 1, toCoordinateX(path[1], N, M, P),
+        writeMove(fp, parkMap, ID, TIME[0] + 1, toCoordinateX(path[1], N, M, P),
                                 toCoordinateY(path[1], N, M, P),
                                 toCoordinateZ(path[1], N, M, P), 'm');
     }
     time++;
     TIME[1] = time;
     /* car has just parked */
-    escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+    writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                 toCoordinateY(path[j], N, M, P),
                                 toCoordinateZ(path[j], N, M, P), 'e');
 
@@ -839,14 +1185,14 @@ void writeOutput(FILE *fp, Map *parkMap, int *st, int cost, int time, char *ID,
          */
         if(path[j] - path[j - 1] != path[j + 1] - path[j]){
             test = 1;
-            escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+            writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                         toCoordinateY(path[j], N, M, P),
                                         toCoordinateZ(path[j], N, M, P), 'p');
         }
     }
     if(test == 0){
         j = pathSize - 2;
-        escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+        writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                 toCoordinateY(path[j], N, M, P),
                                 toCoordinateZ(path[j], N, M, P), 'p');
     }
@@ -856,11 +1202,11 @@ void writeOutput(FILE *fp, Map *parkMap, int *st, int cost, int time, char *ID,
     time++; /* add one extra tick to arrive to the access */
     TIME[2] = time;
     j = pathSize - 1;/* go to the last index of the path list */
-    escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+    writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                 toCoordinateY(path[j], N, M, P),
                                 toCoordinateZ(path[j], N, M, P), 'a');
     /* write terminating line */
-    escreve_saida(fp, ID, TIME[0], TIME[1], TIME[2], cost, 'x');
+    writeMove(fp, parkMap, ID, TIME[0], TIME[1], TIME[2], cost, 'x');
 
 
     free(path);
@@ -897,7 +1243,7 @@ void writeOutput(FILE *fp, Map *parkMap, int *st, int cost, int time, char *ID,
 void writeOutputAfterIn(FILE *fp, Map *parkMap, int *st, int cost, int time, 
                         char *ID, char accessType, int origTime, int pathSize){
     int *path;
-    int i, dest, j;
+    int j;
     int N, M, P;
     int TIME[3];             /* array to save important times */
     int test = 0;            /* to test if at least 1 m or p is printed */
@@ -908,15 +1254,8 @@ void writeOutputAfterIn(FILE *fp, Map *parkMap, int *st, int cost, int time,
     M = parkMap->M;
     P = parkMap->P;
 
-    dest = parkMap->accessTable[ (int) accessType];
-
-    /* fill path vector with passby nodes
-     * starts at the access point node and goes back until entrace is reached
-     */
     path = (int *) malloc(sizeof(int) * (pathSize));
-    for(j = pathSize - 1, i = st[dest]; j >= 0; j--, i = st[i]){
-        path[j] = i; 
-    }
+    getPathNodes(parkMap, st, accessType, path, pathSize);
 
     /* go through all nodes between the first and parking node */
     for(j = 1; path[j + 1] - path[j] != N*M*P; j++){
@@ -930,20 +1269,20 @@ void writeOutputAfterIn(FILE *fp, Map *parkMap, int *st, int cost, int time,
          */
         if(path[j] - path[j - 1] != path[j + 1] - path[j]){
             test = 1;
-            escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+            writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                         toCoordinateY(path[j], N, M, P),
                                         toCoordinateZ(path[j], N, M, P), 'm');
         }
     }
     if(test == 0){
-        escreve_saida(fp, ID, TIME[0] + 1, toCoordinateX(path[1], N, M, P),
+        writeMove(fp, parkMap, ID, TIME[0] + 1, toCoordinateX(path[1], N, M, P),
                                 toCoordinateY(path[1], N, M, P),
                                 toCoordinateZ(path[1], N, M, P), 'm');
     }
     time++;
     TIME[1] = time;
     /* car has just parked */
-    escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+    writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                 toCoordinateY(path[j], N, M, P),
                                 toCoordinateZ(path[j], N, M, P), 'e');
 
@@ -960,14 +1299,14 @@ void writeOutputAfterIn(FILE *fp, Map *parkMap, int *st, int cost, int time,
          */
         if(path[j] - path[j - 1] != path[j + 1] - path[j]){
             test = 1;
-            escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+            writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                         toCoordinateY(path[j], N, M, P),
                                         toCoordinateZ(path[j], N, M, P), 'p');
         }
     }
     if(test == 0){
         j = pathSize - 2;
-        escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+        writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                 toCoordinateY(path[j], N, M, P),
                                 toCoordinateZ(path[j], N, M, P), 'p');
     }
@@ -977,11 +1316,11 @@ void writeOutputAfterIn(FILE *fp, Map *parkMap, int *st, int cost, int time,
     time++; /* add one extra tick to arrive to the access */
     TIME[2] = time;
     j = pathSize - 1;/* go to the last index of the path list */
-    escreve_saida(fp, ID, time, toCoordinateX(path[j], N, M, P),
+    writeMove(fp, parkMap, ID, time, toCoordinateX(path[j], N, M, P),
                                 toCoordinateY(path[j], N, M, P),
                                 toCoordinateZ(path[j], N, M, P), 'a');
     /* write terminating line */
-    escreve_saida(fp, ID, TIME[0], TIME[1], TIME[2], cost, 'x');
+    writeMove(fp, parkMap, ID, TIME[0], TIME[1], TIME[2], cost, 'x');
 
     free(path);
 
@@ -1007,24 +1346,16 @@ void writeOutputAfterIn(FILE *fp, Map *parkMap, int *st, int cost, int time,
   */
 
 char getMapRepDesc(Map *parkMap, int node){
-    int N, M, P;
-    int x, y, z;
-    N = parkMap->N;
-    M = parkMap->M;
-    P = parkMap->P;
+    int NMP = parkMap->N * parkMap->M * parkMap->P;
 
     /* if it is an access type node */
-    if(node >= 2*N*M*P)
+    if(node >= 2*NMP)
         return 'a';
 
-    if(node >= N*M*P)
-        node = node - N*M*P;
-
-    x = toCoordinateX(node, N, M, P);
-    y = toCoordinateY(node, N, M, P);
-    z = toCoordinateZ(node, N, M, P);
+    if(node >= NMP)
+        node = node - NMP;
 
-    return parkMap->mapRep[x][y][z];
+    return parkMap->rep[node];
 }
 
 int PgetN(Map *parkMap){
@@ -1037,15 +1368,181 @@ int PgetP(Map *parkMap){
     return parkMap->P;
 }
 
+MapBase *PgetBase(Map *parkMap){
+    return parkMap->base;
+}
+
+void PgetEdgeTable(Map *parkMap, int reverse, int **start, int **node,
+                                                                int **cost){
+    MapBase *base = parkMap->base;
+
+    *start = reverse ? base->inStart : base->outStart;
+    *node = reverse ? base->inFrom : base->outTo;
+    *cost = reverse ? base->inCost : base->outCost;
+    return;
+}
+
+char *PgetEngineName(Map *parkMap){
+    return EnameOf(parkMap->engine);
+}
+
+int PhasAccess(Map *parkMap, char accessType){
+    return parkMap->base->accessTable[(int) accessType] != -1;
+}
+
+int PgetFree(Map *parkMap){
+    int p, n = 0;
+
+    for(p = 0; p < parkMap->P; p++)
+        n += PgetFreeFloor(parkMap, p);
+    return n;
+}
+
+int PgetFreeFloor(Map *parkMap, int floor){
+    MapBase *base = parkMap->base;
+    int w, n = 0;
+
+    if(parkMap->floorShut[floor])
+        return 0;
+    for(w = base->floorWords[floor]; w < base->floorWords[floor + 1]; w++)
+        n += countBits(parkMap->freeSpots[w]);
+    return n;
+}
+
+int PgetSpots(Map *parkMap){
+    return parkMap->base->n_spots;
+}
+
 
 /*
- *  Functions: 
- *      clearSpotCoordinates
- *      clearSpotIDandWrite
+ *  Function:
+ *      PnextFreeSpot
  *
  *  Description:
- *      Frees parking spot coordinates
- *      using the spot coordinates (clearSpotCoordinates)
+ *      looks for the first spot cars may take after a node, in node order,
+ *  a word of a floor's bitmap at a time
+ *
+ *  Arguments:
+ *      Map *parkmap - map configuration
+ *      int node - car path node to look after, -1 to look from the first
+ *
+ *  Return value:
+ *      int - car path node of the spot, -1 if there's none
+ */
+
+int PnextFreeSpot(Map *parkMap, int node){
+    MapBase *base = parkMap->base;
+    int N = parkMap->N, M = parkMap->M, P = parkMap->P;
+    int p, i, w, bit;
+    unsigned long word;
+
+    /* spot numbers follow nodes, look from the first after node */
+    for(node++; node < N * M * P && base->spotId[node] < 0; node++)
+        ;
+    if(node >= N * M * P)
+        return -1;
+    p = toCoordinateZ(node, N, M, P);
+    i = base->spotId[node] - base->floorSpots[p];
+
+    for(; p < P; p++, i = 0){
+        if(parkMap->floorShut[p])
+            continue;
+        for(w = base->floorWords[p] + i / WBITS; w < base->floorWords[p + 1];
+                                                                        w++){
+            word = parkMap->freeSpots[w];
+            if(w == base->floorWords[p] + i / WBITS)
+                word &= ~0UL << (i % WBITS);
+            if(word == 0)
+                continue;
+            for(bit = 0; (word & 1UL) == 0; bit++)
+                word >>= 1;
+            return base->spotNode[base->floorSpots[p] +
+                            (w - base->floorWords[p]) * WBITS + bit];
+        }
+    }
+    return -1;
+}
+
+
+void getPathNodes(Map *parkMap, int *st, char accessType, int *path,
+                                                            int pathSize){
+    int i, j;
+    int dest = parkMap->base->accessTable[ (int) accessType];
+
+    /* fill path vector with passby nodes
+     * starts at the access point node and goes back until entrace is reached
+     */
+    for(j = pathSize - 1, i = st[dest]; j >= 0; j--, i = st[i]){
+        path[j] = i; 
+    }
+    return;
+}
+
+
+/*
+ * Auxiliary-functions: notifyEngines, notifyEnginesFloor
+ *
+ * Description:
+ *      tell the Map's engines a node (or a floor) was turned on or off
+ */
+
+static void notifyEngines(Map *parkMap, int node, int active){
+    Enotify(parkMap->engine, node, active);
+    if(parkMap->probe != NULL)
+        Enotify(parkMap->probe, node, active);
+    return;
+}
+
+static void notifyEnginesFloor(Map *parkMap, int floor, int active){
+    EnotifyFloor(parkMap->engine, floor, active);
+    if(parkMap->probe != NULL)
+        EnotifyFloor(parkMap->probe, floor, active);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: setNodeActive
+ *
+ * Description:
+ *      turns a node of the Map's graph on or off, telling its engine
+ */
+
+static void setNodeActive(Map *parkMap, int node, int active){
+    if(active)
+        GactivateNode(parkMap->Graph, node);
+    else
+        GdeactivateNode(parkMap->Graph, node);
+    setSpotFree(parkMap, node, active);
+    notifyEngines(parkMap, node, active);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: occupySpot
+ *
+ * Description:
+ *      parks the car ID at the spot node
+ */
+
+static void occupySpot(Map *parkMap, char *ID, int spot){
+    setNodeActive(parkMap, spot, 0);
+    setSpotTaken(parkMap, spot, 1);
+    HTinsert(parkMap->pCars, spot, ID);
+    parkMap->nTaken++;
+    return;
+}
+
+
+/*
+ *  Functions: 
+ *      clearSpotCoordinates
+ *      clearSpotIDandWrite
+ *
+ *  Description:
+ *      Frees parking spot coordinates
+ *      using the spot coordinates (clearSpotCoordinates)
  *      using the car ID (clearSpotIdandWrite)
  *
  *      In the 2nd case, the program also writes to the output
@@ -1063,11 +1560,12 @@ int PgetP(Map *parkMap){
  */
 
 void clearSpotCoordinates(Map *parkMap, int x, int y, int z){
-    GactivateNode(parkMap->Graph, toIndex(x, y, z, parkMap->N, parkMap->M
-                                                 , parkMap->P));
-    parkMap->mapRep[x][y][z] = '.';
-    parkMap->n_av++;
-    parkMap->avalP[z]++;
+    setNodeActive(parkMap, toIndex(x, y, z, parkMap->N, parkMap->M
+                                                 , parkMap->P), 1);
+    setSpotTaken(parkMap, toIndex(x, y, z, parkMap->N, parkMap->M,
+                                                        parkMap->P), 0);
+    parkMap->rep[toIndex(x, y, z, parkMap->N, parkMap->M, parkMap->P)] = '.';
+    parkMap->lastFreed = toIndex(x, y, z, parkMap->N, parkMap->M, parkMap->P);
     return;
 }
 
@@ -1083,16 +1581,40 @@ void clearSpotIDandWrite(FILE *fp, Map *parkMap, char *ID, int time){
     y = toCoordinateY(node, N, M, P);
     z = toCoordinateZ(node, N, M, P);
 
-    GactivateNode(parkMap->Graph, node);
-    escreve_saida(fp, ID, time, x, y, z, 's');
+    setNodeActive(parkMap, node, 1);
+    setSpotTaken(parkMap, node, 0);
+    writeMove(fp, parkMap, ID, time, x, y, z, 's');
 
-    parkMap->mapRep[x][y][z] = '.';
-    parkMap->n_av++;
-    parkMap->avalP[ z ]++;
+    parkMap->rep[node] = '.';
+    parkMap->lastFreed = node;
     return;
 }
 
 
+/*
+ *  Auxiliary-function: pathSpot
+ *
+ *  Description:
+ *      goes back along a path found to dest to find its parking spot, the
+ *  node before the one where the car is left, and the size of the path
+ */
+
+static int pathSpot(Map *parkMap, int *st, int dest, int *stSize){
+    int i, spot = -1;
+
+    *stSize = 1;
+    for(i = st[dest]; i != -1; i = st[i]){
+        if( i - st[i] == parkMap->N * parkMap->M * parkMap->P){
+            i = st[i];
+            spot = i;
+        }
+        /* increment size of path */
+        *stSize = *stSize + 1;
+    }
+    return spot;
+}
+
+
 /*
  *  Functions: 
  *      findPath
@@ -1109,6 +1631,7 @@ void clearSpotIDandWrite(FILE *fp, Map *parkMap, char *ID, int time){
  *      int ex, ey, ez - entrance coordinates
  *      char accessType - descriptor character of access type
  *      int *cost - reference integer to save cost of path
+ *      PathStats *stats - reference to save the search counters, or NULL
  *  Return value:
  *      int *
  *
@@ -1117,11 +1640,10 @@ void clearSpotIDandWrite(FILE *fp, Map *parkMap, char *ID, int time){
  */
 
 int *findPath(Map *parkMap, char *ID, int ex, int ey, int ez, char accessType, 
-                                              int *cost, int *stSize) {
+                                int *cost, int *stSize, PathStats *stats) {
     int origin, dest; /* origin and destiny indexed variables */
-    int *st, *wt;     /* path and weight tables */
-    PrioQ *PQ;        /* priority queue */
-    int i;     
+    int *st;          /* path table */
+    int spot;
 
     /* get the path table by calculating ideal path from
      * entrance to access points
@@ -1131,50 +1653,557 @@ int *findPath(Map *parkMap, char *ID, int ex, int ey, int ez, char accessType,
      * access node is at index:   x*M +N*m + N*M*p + N*M*P
      */
     origin = toIndex(ex, ey, ez, parkMap->N, parkMap->M, parkMap->P);
-    dest = parkMap->accessTable[(int) accessType];
+    dest = parkMap->base->accessTable[(int) accessType];
     if(dest == -1) {
         fprintf(stderr, "There's no access with that type\n");
         exit(1);
     }
-    *stSize = 1;
-
-    st = parkMap->st;
-    wt = parkMap->wt;
-    PQ = parkMap->PQ;
-
-    /* set PQ wt and st to original state without O(N) */
-    PQreset(PQ, st, wt, Gnodes(parkMap->Graph));
-
-    /* set origin definitions and update PQ */
-    wt[origin] = 0;
-    PQupdateNode(PQ, origin);
 
     /* update last calculation */
     parkMap->lastEntrance = origin;
     parkMap->lastAccess   = dest;
 
     /* calculate Ideal path and get total cost, only if it hasnt been done */
-    *cost = GDijkstra(parkMap->Graph, origin, dest, st, wt, PQ, parkMap);
+    *cost = Equery(parkMap->engine, origin, dest, &st, stats);
 
     /* if no path is encountered, return NULL pointer */
     if(st[dest] == -1){
         return NULL;
     }
 
-    /* occupy parking spot */
-    for(i = st[dest]; i != -1; i = st[i]){
-        if( i - st[i] == parkMap->N * parkMap->M * parkMap->P){
-            i = st[i];
-            GdeactivateNode(parkMap->Graph, i);
-            HTinsert(parkMap->pCars, i, ID);
-            parkMap->n_av--;
-            parkMap->avalP[ toCoordinateZ(i, parkMap->N, parkMap->M, parkMap->P)]--;
+    /* find the parking spot, st is the engine's until the next change */
+    spot = pathSpot(parkMap, st, dest, stSize);
+
+    occupySpot(parkMap, ID, spot);
+
+    return st;
+}
+
+
+/*
+ *  Function:
+ *      queryCost
+ *
+ *  Description:
+ *      what findPath would answer for a car coming now, without parking it:
+ *  the cost of the best path and its spot. Nothing of the Map changes, the
+ *  path table of the last findPath included, since the search is made by an
+ *  engine of its own (see mapSetEngine), as fast as findPath's
+ *
+ *  Arguments:
+ *      Map *parkmap - map configuration
+ *      int ex, ey, ez - entrance coordinates
+ *      char accessType - descriptor character of access type
+ *      int *sx, *sy, *sz - references to save the spot coordinates
+ *
+ *  Return value:
+ *      int - cost of the path, NOCON if there is none, the entrance is off
+ *          the map or the park has no access of that type
+ */
+
+int queryCost(Map *parkMap, int ex, int ey, int ez, char accessType,
+                                                int *sx, int *sy, int *sz){
+    int origin, dest, cost, size, spot;
+    int *st;
+
+    dest = parkMap->base->accessTable[(int) accessType];
+    if(dest == -1 || ex < 0 || ex >= parkMap->N || ey < 0 ||
+                        ey >= parkMap->M || ez < 0 || ez >= parkMap->P)
+        return NOCON;
+    origin = toIndex(ex, ey, ez, parkMap->N, parkMap->M, parkMap->P);
+
+    if(parkMap->probe == NULL)
+        parkMap->probe = Einit(EnameOf(parkMap->engine), parkMap,
+                                                            parkMap->Graph);
+    /* ties are broken as findPath's engine would */
+    Ecopy(parkMap->probe, parkMap->engine);
+    cost = Equery(parkMap->probe, origin, dest, &st, NULL);
+    if(st[dest] == -1)
+        return NOCON;
+
+    spot = pathSpot(parkMap, st, dest, &size);
+    *sx = toCoordinateX(spot, parkMap->N, parkMap->M, parkMap->P);
+    *sy = toCoordinateY(spot, parkMap->N, parkMap->M, parkMap->P);
+    *sz = toCoordinateZ(spot, parkMap->N, parkMap->M, parkMap->P);
+    return cost;
+}
+
+
+/*
+ *  Function:
+ *      occupySpotCoordinates
+ *
+ *  Description:
+ *      parks a car at a given spot, as findPath does with the one it finds
+ *
+ *  Arguments:
+ *      Map *parkmap - map configuration
+ *      char *ID - car identifier
+ *      int x, y, z - parking spot's coordinates
+ *
+ *  Return value:
+ *      void
+ *
+ *  Secondary effects:
+ *      parking spot in graph becomes inactive
+ */
+
+void occupySpotCoordinates(Map *parkMap, char *ID, int x, int y, int z){
+    occupySpot(parkMap, ID, toIndex(x, y, z, parkMap->N, parkMap->M,
+                                                                parkMap->P));
+    return;
+}
+
+
+/*
+ *  Data Type: SpotRanking
+ *
+ *  Description:
+ *      the spots of a Map in order of the cost of the best path through
+ *  each of them, from one entrance to one access type. Cars don't drive
+ *  through spots and no one walks into one, so taking a spot changes no
+ *  other path and the ranking stays good while cars are only parked
+ *
+ *      Walks are in states, two per node: 2n for node n entered from
+ *  anything but a ramp, 2n + 1 from a ramp. A ramp entered from elsewhere
+ *  may only be left to the other floor, as in GDijkstra
+ *
+ */
+
+typedef struct _rankedSpot{
+    int cost;
+    int spot;
+} RankedSpot;
+
+struct _spotRanking{
+    int ex, ey, ez;       /* entrance and access type, for findPath */
+    char accessType;
+    int origin, dest;
+
+    int *wt, *st;         /* search from the entrance, as GDijkstra makes */
+    int *walk;            /* cost from each state to dest */
+    int *next;            /* state after each one on the way to dest */
+    int *reach;           /* cost to each state from the nearest free spot */
+    PrioQ *reachPQ;       /* states of reach not settled yet */
+    int reachTaken;       /* nTaken of the Map when reach was made */
+    int *mark;            /* to tell walks that go through a node twice */
+    int stamp;
+
+    RankedSpot *spots;    /* by cost, spots before first already tried */
+    int nSpots, first;
+};
+
+
+static int isRampNode(Map *parkMap, int v){
+    char desc = getMapRepDesc(parkMap, v);
+
+    return desc == 'u' || desc == 'd';
+}
+
+
+/* 1 if the edge from v to w may be taken from state m of v */
+static int canTake(Map *parkMap, int v, int m, int w){
+    int NM = parkMap->N * parkMap->M;
+
+    return m == 1 || isRampNode(parkMap, v) == 0 || v - w == NM ||
+                                                                w - v == NM;
+}
+
+
+/* state w is entered in by the edge from v */
+static int stateAfter(Map *parkMap, int v, int w){
+    return 2 * w + (isRampNode(parkMap, w) && isRampNode(parkMap, v));
+}
+
+
+static int *newStates(int n){
+    int *states = (int *) malloc(sizeof(int) * 2 * n), i;
+
+    for(i = 0; i < 2 * n; i++)
+        states[i] = NOCON;
+    return states;
+}
+
+
+/*
+ *  Auxiliary-function: walkToAccess
+ *
+ *  Description:
+ *      cost of walking from every state of the peon nodes to the access
+ *  type node, going back along the edges from it
+ */
+
+static void walkToAccess(Map *parkMap, SpotRanking *R, PathStats *stats){
+    MapBase *base = parkMap->base;
+    int n = Gnodes(parkMap->Graph), NMP = parkMap->N * parkMap->M * parkMap->P;
+    int i, u, v, m, c;
+    PrioQ *PQ;
+
+    R->walk = newStates(n);
+    R->next = (int *) malloc(sizeof(int) * 2 * n);
+    PQ = PQinit(R->walk, 2 * n);
+    R->walk[2 * R->dest] = 0;
+    PQupdateNode(PQ, 2 * R->dest);
+
+    while(!PQisempty(PQ)){
+        u = PQdelmin(PQ);
+        PScount(stats, popped);
+        if(R->walk[u] == NOCON)
+            break;
+        for(i = base->inStart[u / 2]; i < base->inStart[u / 2 + 1]; i++){
+            v = base->inFrom[i];
+            if(v < NMP || GisNodeActive(parkMap->Graph, v) == 0 ||
+                                            stateAfter(parkMap, v, u / 2) != u)
+                continue;
+            c = R->walk[u] + base->inCost[i];
+            for(m = 0; m < 2; m++)
+                if(canTake(parkMap, v, m, u / 2) && c < R->walk[2 * v + m]){
+                    R->walk[2 * v + m] = c;
+                    R->next[2 * v + m] = u;
+                    PQupdateNode(PQ, 2 * v + m);
+                    PScount(stats, relaxed);
+                }
         }
-        /* increment size of path */
-        *stSize = *stSize + 1;
     }
+    PQdestroy(PQ);
+    return;
+}
 
-    return st;
+
+/*
+ *  Auxiliary-function: spreadReach
+ *
+ *  Description:
+ *      settles the states of reachPQ in order up to a cost, the rest are
+ *  left for a later call. A state made cheaper later, by a spot freed, is
+ *  put back in and settled again
+ */
+
+static void spreadReach(Map *parkMap, SpotRanking *R, int bound){
+    MapBase *base = parkMap->base;
+    int i, u, v, w, c;
+
+    while(!PQisempty(R->reachPQ)){
+        u = PQdelmin(R->reachPQ);
+        if(R->reach[u] == NOCON || R->reach[u] > bound){
+            PQReinsert(R->reachPQ, u);
+            break;
+        }
+        v = u / 2;
+        for(i = base->outStart[v]; i < base->outStart[v + 1]; i++){
+            w = base->outTo[i];
+            if(GisNodeActive(parkMap->Graph, w) == 0 ||
+                                        canTake(parkMap, v, u % 2, w) == 0)
+                continue;
+            c = R->reach[u] + base->outCost[i];
+            if(c < R->reach[stateAfter(parkMap, v, w)]){
+                R->reach[stateAfter(parkMap, v, w)] = c;
+                PQReinsert(R->reachPQ, stateAfter(parkMap, v, w));
+            }
+        }
+    }
+    return;
+}
+
+
+/*
+ *  Auxiliary-function: reachFromSpots
+ *
+ *  Description:
+ *      starts again the cost of walking to every state of the peon nodes
+ *  from any free spot, the car's cost to the spot included, settled as far
+ *  as needed by spreadReach. No search from fewer spots gets anywhere
+ *  cheaper, so the costs stay good, only lower, while cars park
+ */
+
+static void reachFromSpots(Map *parkMap, SpotRanking *R){
+    int n = Gnodes(parkMap->Graph), NMP = parkMap->N * parkMap->M * parkMap->P;
+    int v;
+
+    if(R->reach == NULL)
+        R->reach = (int *) malloc(sizeof(int) * 2 * n);
+    else
+        PQdestroy(R->reachPQ);
+    for(v = 0; v < 2 * n; v++)
+        R->reach[v] = NOCON;
+    R->reachPQ = PQinit(R->reach, 2 * n);
+    R->reachTaken = parkMap->nTaken;
+    for(v = PnextFreeSpot(parkMap, -1); v != -1; v = PnextFreeSpot(parkMap, v))
+        if(R->wt[v] != NOCON && GisNodeActive(parkMap->Graph, v + NMP)){
+            R->reach[2 * (v + NMP)] = R->wt[v];
+            PQupdateNode(R->reachPQ, 2 * (v + NMP));
+        }
+    return;
+}
+
+
+static int compareRankedSpots(const void *a, const void *b){
+    const RankedSpot *ra = (const RankedSpot *) a, *rb = (const RankedSpot *) b;
+
+    if(ra->cost != rb->cost)
+        return ra->cost < rb->cost ? -1 : 1;
+    return ra->spot < rb->spot ? -1 : (ra->spot > rb->spot ? 1 : 0);
+}
+
+
+/*
+ *  Function:
+ *      rankSpots
+ *
+ *  Description:
+ *      ranks the spots for cars from an entrance to an access type: GDijkstra
+ *  from the entrance over the whole graph gives the cost to each spot, and a
+ *  search back from the access type node the cost of the walk from it
+ *
+ *  Arguments:
+ *      Map *parkmap - map configuration
+ *      int ex, ey, ez - entrance coordinates
+ *      char accessType - descriptor character of access type
+ *      PathStats *stats - reference to save the search counters, or NULL
+ *
+ *  Return value:
+ *      SpotRanking * - the ranking, to be freed with freeSpotRanking
+ */
+
+SpotRanking *rankSpots(Map *parkMap, int ex, int ey, int ez, char accessType,
+                                                        PathStats *stats){
+    SpotRanking *R;
+    int n = Gnodes(parkMap->Graph), NMP = parkMap->N * parkMap->M * parkMap->P;
+    int v, i;
+    PrioQ *PQ;
+
+    R = (SpotRanking *) malloc(sizeof(SpotRanking));
+    R->ex = ex;
+    R->ey = ey;
+    R->ez = ez;
+    R->accessType = accessType;
+    R->origin = toIndex(ex, ey, ez, parkMap->N, parkMap->M, parkMap->P);
+    R->dest = parkMap->base->accessTable[(int) accessType];
+    if(R->dest == -1) {
+        fprintf(stderr, "There's no access with that type\n");
+        exit(1);
+    }
+
+    R->wt = (int *) malloc(sizeof(int) * n);
+    R->st = (int *) malloc(sizeof(int) * n);
+    R->mark = (int *) malloc(sizeof(int) * n);
+    for(v = 0; v < n; v++){
+        R->wt[v] = NOCON;
+        R->st[v] = -1;
+        R->mark[v] = 0;
+    }
+    R->stamp = 0;
+
+    if(stats != NULL)
+        PSclear(stats);
+    PQ = PQinit(R->wt, n);
+    PQsetStats(PQ, stats);
+    R->wt[R->origin] = 0;
+    PQupdateNode(PQ, R->origin);
+    GDijkstra(parkMap->Graph, R->origin, -1, R->st, R->wt, PQ, parkMap, stats);
+    PQdestroy(PQ);
+
+    walkToAccess(parkMap, R, stats);
+    R->reach = NULL;
+    reachFromSpots(parkMap, R);
+
+    R->spots = (RankedSpot *) malloc(sizeof(RankedSpot) *
+                                        (parkMap->base->n_spots + 1));
+    R->nSpots = 0;
+    R->first = 0;
+    for(i = 0; i < parkMap->base->n_spots; i++){
+        v = parkMap->base->spotNode[i];
+        if(R->wt[v] == NOCON || R->walk[2 * (v + NMP)] == NOCON)
+            continue;
+        R->spots[R->nSpots].cost = R->wt[v] + R->walk[2 * (v + NMP)];
+        R->spots[R->nSpots].spot = v;
+        R->nSpots++;
+    }
+    qsort(R->spots, R->nSpots, sizeof(RankedSpot), compareRankedSpots);
+
+    return R;
+}
+
+
+/*
+ *  Auxiliary-function: rankedPath
+ *
+ *  Description:
+ *      writes in the ranking's path table the walk from a spot to the
+ *  access type node, after the drive to it. Returns 1 if GDijkstra finds
+ *  a path of its cost, else findPath must be asked instead:
+ *
+ *    - -1 if the walk goes through a node twice (up and down a ramp to
+ *  leave it sideways), which a path table can't hold
+ *    - 0 if it leaves a ramp sideways that GDijkstra could enter as cheaply
+ *  from elsewhere, and then it only lets the ramp be left to the other
+ *  floor. That can't happen if no walk from any free spot gets to a node
+ *  before the ramp cheaper, and reach may be too low only if cars parked
+ */
+
+static int rankedPath(Map *parkMap, SpotRanking *R, int spot){
+    MapBase *base = parkMap->base;
+    int NMP = parkMap->N * parkMap->M * parkMap->P, NM = parkMap->N * parkMap->M;
+    int u, v, w, p, i, total;
+
+    R->stamp++;
+    R->st[spot + NMP] = spot;
+    R->mark[spot + NMP] = R->stamp;
+    total = R->wt[spot] + R->walk[2 * (spot + NMP)];
+    for(u = 2 * (spot + NMP); u / 2 != R->dest; u = R->next[u]){
+        v = u / 2;
+        w = R->next[u] / 2;
+        if(R->mark[w] == R->stamp)
+            return -1;
+        if(isRampNode(parkMap, v) && v - w != NM && w - v != NM){
+            spreadReach(parkMap, R, total);
+            for(i = base->inStart[v]; i < base->inStart[v + 1]; i++){
+                p = base->inFrom[i];
+                if(p >= NMP && isRampNode(parkMap, p) == 0 &&
+                        R->reach[2 * p] + base->inCost[i] <= total - R->walk[u])
+                    return 0;
+            }
+        }
+        R->mark[w] = R->stamp;
+        R->st[w] = v;
+    }
+    return 1;
+}
+
+
+/*
+ *  Function:
+ *      nextRankedPath
+ *
+ *  Description:
+ *      parks a car at the best spot of the ranking still free, as findPath
+ *  would (see findPath)
+ *
+ *  Arguments:
+ *      Map *parkmap - map configuration, changed since the ranking only by
+ *          cars parked
+ *      SpotRanking *R - ranking of the car's entrance and access type
+ *      char *ID - car ID
+ *      int *cost - reference integer to save cost of path
+ *      int *stSize - reference integer to save the size of the path
+ *
+ *  Return value:
+ *      int * - path table, good until the next call, or NULL if no spot is
+ *          left
+ */
+
+int *nextRankedPath(Map *parkMap, SpotRanking *R, char *ID, int *cost,
+                                                                int *stSize){
+    int spot, found;
+
+    while(R->first < R->nSpots){
+        spot = R->spots[R->first].spot;
+        if(GisNodeActive(parkMap->Graph, spot) == 0){
+            R->first++;
+            continue;
+        }
+
+        found = rankedPath(parkMap, R, spot);
+        if(found == 0 && R->reachTaken != parkMap->nTaken){
+            reachFromSpots(parkMap, R);
+            found = rankedPath(parkMap, R, spot);
+        }
+        if(found != 1)
+            return findPath(parkMap, ID, R->ex, R->ey, R->ez, R->accessType,
+                                                        cost, stSize, NULL);
+        *cost = R->spots[R->first++].cost;
+        parkMap->lastEntrance = R->origin;
+        parkMap->lastAccess = R->dest;
+        pathSpot(parkMap, R->st, R->dest, stSize);
+        occupySpot(parkMap, ID, spot);
+        return R->st;
+    }
+    return NULL;
+}
+
+
+/*
+ *  Function:
+ *      rankFreedSpot
+ *
+ *  Description:
+ *      tells a ranking the spot last freed in the Map (clearSpotCoordinates,
+ *  clearSpotIDandWrite) may be taken again. No search is made for it: the
+ *  spot is looked up among the ranked ones by its cost, and the walks from
+ *  it are only followed when a path needs them (see rankedPath)
+ *
+ *  Arguments:
+ *      Map *parkmap - map configuration
+ *      SpotRanking *R - ranking of that Map
+ *
+ *  Return value:
+ *      void
+ */
+
+void rankFreedSpot(Map *parkMap, SpotRanking *R){
+    int NMP = parkMap->N * parkMap->M * parkMap->P, spot = parkMap->lastFreed;
+    int lo = 0, hi = R->nSpots, mid, u;
+    RankedSpot key;
+
+    if(spot < 0 || R->wt[spot] == NOCON || R->walk[2 * (spot + NMP)] == NOCON)
+        return;
+
+    key.cost = R->wt[spot] + R->walk[2 * (spot + NMP)];
+    key.spot = spot;
+    while(lo < hi){
+        mid = (lo + hi) / 2;
+        if(compareRankedSpots(&R->spots[mid], &key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo < R->first)
+        R->first = lo;
+
+    u = 2 * (spot + NMP);
+    if(GisNodeActive(parkMap->Graph, spot + NMP) && R->wt[spot] < R->reach[u]){
+        R->reach[u] = R->wt[spot];
+        PQReinsert(R->reachPQ, u);
+    }
+    return;
+}
+
+
+int isFreedSpotRanked(Map *parkMap, SpotRanking *R){
+    int NMP = parkMap->N * parkMap->M * parkMap->P, spot = parkMap->lastFreed;
+
+    if(spot < 0 || R->wt[spot] == NOCON || R->walk[2 * (spot + NMP)] == NOCON)
+        return 0;
+    return 1;
+}
+
+
+void freeSpotRanking(SpotRanking *R){
+    free(R->wt);
+    free(R->st);
+    free(R->walk);
+    free(R->next);
+    free(R->reach);
+    PQdestroy(R->reachPQ);
+    free(R->mark);
+    free(R->spots);
+    free(R);
+    return;
+}
+
+
+int mapSetEngine(Map *parkMap, char *name){
+    Engine *E = Einit(name, parkMap, parkMap->Graph);
+
+    if(E == NULL)
+        return 0;
+    Edestroy(parkMap->engine);
+    parkMap->engine = E;
+    if(parkMap->probe != NULL){
+        Edestroy(parkMap->probe);
+        parkMap->probe = NULL;
+    }
+    return 1;
 }
 
 
@@ -1208,17 +2237,11 @@ void restrictMapCoordinate(Map *parkMap, int x, int y, int z){
     M = parkMap->M;
     P = parkMap->P;
 
-    /* if restricting a parking spot, decrease num of available spots */
-    if(parkMap->mapRep[x][y][z] == '.'){
-        parkMap->n_av--;
-        parkMap->avalP[z]--;
-    }
-
     /* deactive car path node */
-    GdeactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P));
+    setNodeActive(parkMap, toIndex(x, y, z, N, M, P), 0);
 
     /* and deactivate peon path node */
-    GdeactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P) + N*M*P);
+    setNodeActive(parkMap, toIndex(x, y, z, N, M, P) + N*M*P, 0);
 
     return;
 }
@@ -1254,17 +2277,128 @@ void freeRestrictionMapCoordinate(Map *parkMap, int x, int y, int z){
     M = parkMap->M;
     P = parkMap->P;
 
-    /* if freeing a parking spot, increase num of available spots */
-    if(parkMap->mapRep[x][y][z] == '.'){
-        parkMap->n_av++;
-        parkMap->avalP[z]++;
+    /* activate car path node, unless a car is parked there: it's its
+     * departure that frees the spot */
+    if(!isSpotTaken(parkMap, toIndex(x, y, z, N, M, P)))
+        setNodeActive(parkMap, toIndex(x, y, z, N, M, P), 1);
+
+    /* and activate peon path node */
+    setNodeActive(parkMap, toIndex(x, y, z, N, M, P) + N*M*P, 1);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: clipRange
+ *
+ * Description:
+ *      orders the ends of a range of coordinates and keeps it inside
+ *  [0, size). Returns 0 if nothing is left
+ */
+
+static int clipRange(int *a, int *b, int size){
+    int t;
+
+    if(*a > *b){
+        t = *a;
+        *a = *b;
+        *b = t;
+    }
+    if(*a < 0)
+        *a = 0;
+    if(*b > size - 1)
+        *b = size - 1;
+    return *a <= *b;
+}
+
+
+/*
+ * Auxiliary-function: setRegionActive
+ *
+ * Description:
+ *      turns the box from (x1, y1, z1) to (x2, y2, z2) on or off as
+ *  restricting (or freeing) each of its positions would, a row of the box at
+ *  a time: the row's nodes are contiguous in both layers
+ */
+
+static void setRegionActive(Map *parkMap, int x1, int y1, int z1,
+                                        int x2, int y2, int z2, int active){
+    int N, M, P, NMP, x, y, z, first;
+
+    N = parkMap->N;
+    M = parkMap->M;
+    P = parkMap->P;
+    NMP = N * M * P;
+    if(!clipRange(&x1, &x2, N) || !clipRange(&y1, &y2, M) ||
+                                                    !clipRange(&z1, &z2, P))
+        return;
+
+    for(z = z1; z <= z2; z++)
+        for(y = y1; y <= y2; y++){
+            first = toIndex(x1, y, z, N, M, P);
+            if(active){
+                GactivateNodes(parkMap->Graph, first, first + x2 - x1);
+                GactivateNodes(parkMap->Graph, first + NMP,
+                                                    first + NMP + x2 - x1);
+            } else{
+                GdeactivateNodes(parkMap->Graph, first, first + x2 - x1);
+                GdeactivateNodes(parkMap->Graph, first + NMP,
+                                                    first + NMP + x2 - x1);
+            }
+            for(x = 0; x <= x2 - x1; x++){
+                /* spots with a car stay off until it leaves */
+                if(active && isSpotTaken(parkMap, first + x))
+                    GdeactivateNode(parkMap->Graph, first + x);
+                else{
+                    setSpotFree(parkMap, first + x, active);
+                    notifyEngines(parkMap, first + x, active);
+                }
+                notifyEngines(parkMap, first + NMP + x, active);
+            }
+        }
+    return;
+}
+
+
+/*
+ *  Functions:
+ *      restrictMapRegion
+ *      freeRestrictionMapRegion
+ *  Description:
+ *      restricts (or frees) every location of a box in the map, the same as
+ *  restrictMapCoordinate (or freeRestrictionMapCoordinate) on each of them
+ *
+ *  Arguments:
+ *      Pointer to struct Map
+ *      int x1, y1, z1 - one corner of the box
+ *      int x2, y2, z2 - the opposite corner, both included
+ *  Return value:
+ *      none
+ *
+ *  Secondary effects:
+ *      changes the internal graph of Map structure sent as argument by
+ *  deactivating (activating) the nodes of the box, and the number of
+ *  available spots by the spots in it
+ */
+
+void restrictMapRegion(Map *parkMap, int x1, int y1, int z1,
+                                                    int x2, int y2, int z2){
+    if(parkMap->Graph == NULL){
+        fprintf(stderr, "Graph hasn't been built yet\n");
+        return;
     }
+    setRegionActive(parkMap, x1, y1, z1, x2, y2, z2, 0);
+    return;
+}
 
-    /* activate car path node */
-    GactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P));
 
-    /* and activate peon path node */
-    GactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P) + N*M*P);
+void freeRestrictionMapRegion(Map *parkMap, int x1, int y1, int z1,
+                                                    int x2, int y2, int z2){
+    if(parkMap->Graph == NULL){
+        fprintf(stderr, "Graph hasn't been built yet\n");
+        return;
+    }
+    setRegionActive(parkMap, x1, y1, z1, x2, y2, z2, 1);
     return;
 }
 
@@ -1282,53 +2416,29 @@ void freeRestrictionMapCoordinate(Map *parkMap, int x, int y, int z){
  *      none
  *
  *  Secondary effects:
- *      this implementation will modify the (int *) active vector existent 
- *  within the associated graph by deactivating any passageways to the exterior
+ *      deactivates the floor in the associated graph, and with it any
+ *  passageways to the exterior, which were linked to it when it was built
  *
  *  these can be:
  *      entrances
  *      ramps
+ *
+ *      Restrictions of those positions are kept apart: lifting one doesn't
+ *  open the floor, nor opening the floor lifts them
  */
 
 void restrictMapFloor(Map *parkMap, int floor){
-    Point *t;
-    LinkedList *floorRamps;
-    int i;
-    int x, y, z;
-    int N, M, P;
-
     if(parkMap->Graph == NULL){
         fprintf(stderr, "Graph hasn't been built yet\n");
         return;
     }
 
-    N = parkMap->N;
-    M = parkMap->M;
-    P = parkMap->P;
-
-    /* close all entrances to the floor */
-    for(i = 0; i < parkMap->E; i++){
-        if(getz(parkMap->entrancePoints[i]) == floor){
-            x = getx(parkMap->entrancePoints[i]);
-            y = gety(parkMap->entrancePoints[i]);
-            z = floor;
-            GdeactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P));
-        }
-    }
+    /* close the entrances and ramps of the floor at once */
+    GdeactivateFloor(parkMap->Graph, floor);
+    notifyEnginesFloor(parkMap, floor, 0);
 
-    /* go through all the ramps located in that floor and close them */
-    floorRamps = parkMap->ramps[floor];
-    while( (t = (Point *) getItemLinkedList(floorRamps)) != NULL){
-        x = getx(t);
-        y = gety(t);
-        z = floor;
-        GdeactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P));
-        GdeactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P) + N*M*P);
-        floorRamps = getNextNodeLinkedList(floorRamps);
-    }
-    
-    /* decrease number of available places */
-    parkMap->n_av -= parkMap->avalP[floor];
+    /* its spots stop being counted, their bits stay as they are */
+    parkMap->floorShut[floor] = 1;
     return;
 }
 
@@ -1351,48 +2461,21 @@ void restrictMapFloor(Map *parkMap, int floor){
  */
 
 void freeRestrictionMapFloor(Map *parkMap, int floor){
-    Point *t;
-    LinkedList *floorRamps;
-    int i;
-    int x, y, z;
-    int N, M, P;
-
     if(parkMap->Graph == NULL){
         fprintf(stderr, "Graph hasn't been built yet\n");
         return;
     }
 
-    N = parkMap->N;
-    M = parkMap->M;
-    P = parkMap->P;
-
-    /* reopen all entrances to the floor */
-    for(i = 0; i < parkMap->E; i++){
-        if(getz(parkMap->entrancePoints[i]) == floor){
-            x = getx(parkMap->entrancePoints[i]);
-            y = gety(parkMap->entrancePoints[i]);
-            z = floor;
-            GactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P));
-        }
-    }
-
-    /* go through all the ramps located in that floor and reopen them */
-    floorRamps = parkMap->ramps[floor];
-    while( (t = (Point *) getItemLinkedList(floorRamps)) != NULL){
-        x = getx(t);
-        y = gety(t);
-        z = floor;
-        GactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P));
-        GactivateNode(parkMap->Graph, toIndex(x, y, z, N, M, P) + N*M*P);
-        floorRamps = getNextNodeLinkedList(floorRamps);
-    }
+    /* reopen the entrances and ramps of the floor */
+    GactivateFloor(parkMap->Graph, floor);
+    notifyEnginesFloor(parkMap, floor, 1);
 
-    parkMap->n_av += parkMap->avalP[floor];
+    parkMap->floorShut[floor] = 0;
     return;
 }      
 
 int isParkFull(Map *parkMap){
-    return parkMap->n_av > 0 ? 0 : 1;
+    return PnextFreeSpot(parkMap, -1) == -1;
 }
             
 
@@ -1412,50 +2495,73 @@ int isParkFull(Map *parkMap){
  */
 
 void mapDestroy(Map *parkMap) {
+    free(parkMap->freeSpots);
+    free(parkMap->floorShut);
+    free(parkMap->taken);
+    free(parkMap->rep);
+
+    if(parkMap->engine != NULL)
+        Edestroy(parkMap->engine);
+    if(parkMap->probe != NULL)
+        Edestroy(parkMap->probe);
+
+    if(parkMap->Graph != NULL)
+        Gdestroy(parkMap->Graph);
+
+    if(parkMap->pCars != NULL)
+        HTdestroy(parkMap->pCars);
+
+    if(parkMap->ownsBase)
+        mapBaseDestroy(parkMap->base);
+
+    free(parkMap);
+}
+
+
+void mapBaseDestroy(MapBase *base) {
     int i;
     int n, m;
     
     /* free special Points memory */
-    for(i = 0; i < parkMap->S; i++)
-        pointDestroy((Item) parkMap->accessPoints[i]);
-    free(parkMap->accessPoints);
-    for(i = 0; i < parkMap->E; i++)
-        pointDestroy((Item) parkMap->entrancePoints[i]);
-    free(parkMap->entrancePoints);
-
-    free(parkMap->avalP);
+    for(i = 0; i < base->S; i++)
+        pointDestroy((Item) base->accessPoints[i]);
+    free(base->accessPoints);
+    for(i = 0; i < base->E; i++)
+        pointDestroy((Item) base->entrancePoints[i]);
+    free(base->entrancePoints);
+
+    free(base->spotId);
+    free(base->spotNode);
+    free(base->floorSpots);
+    free(base->floorWords);
 
     /* deallocate map representation matrices */
-    if(parkMap->mapRep != NULL){
-        for(n = 0; n < parkMap->N; n++) {
-            for(m = 0; m < parkMap->M; m++) 
-                free(parkMap->mapRep[n][m]);
-            free(parkMap->mapRep[n]);
+    if(base->mapRep != NULL){
+        for(n = 0; n < base->N; n++) {
+            for(m = 0; m < base->M; m++) 
+                free(base->mapRep[n][m]);
+            free(base->mapRep[n]);
         }
-        free(parkMap->mapRep);
+        free(base->mapRep);
     }
 
-    if(parkMap->ramps != NULL){
-        for(i = 0; i < parkMap->P; i++)
-            freeLinkedList(parkMap->ramps[i], pointDestroy);
-        free(parkMap->ramps);
+    if(base->ramps != NULL){
+        for(i = 0; i < base->P; i++)
+            freeLinkedList(base->ramps[i], pointDestroy);
+        free(base->ramps);
     }
 
-    if(parkMap->Graph != NULL)
-        Gdestroy(parkMap->Graph);
-
-    freeLinkedList(parkMap->accessTypes, free);
-    free(parkMap->accessTable);
-
-    if(parkMap->st != NULL)
-        free(parkMap->st);
-    if(parkMap->wt != NULL)
-        free(parkMap->wt);
-    if(parkMap->PQ != NULL)
-        PQdestroy(parkMap->PQ);
+    if(base->Graph != NULL)
+        Gdestroy(base->Graph);
+    free(base->outStart);
+    free(base->outTo);
+    free(base->outCost);
+    free(base->inStart);
+    free(base->inFrom);
+    free(base->inCost);
 
-    if(parkMap->pCars != NULL)
-        HTdestroy(parkMap->pCars);
+    freeLinkedList(base->accessTypes, free);
+    free(base->accessTable);
 
-    free(parkMap);
+    free(base);
 }
@@ -11,21 +11,39 @@
  *              This structure contains all required information over the
  *          parking station's composition as given by its input file
  *
+ *  Abstract Data Type: MapBase
+ *              The part of a Map that never changes (map representation,
+ *          special points and graph). Many Maps, one per simulation, may
+ *          share the same base, also from different threads
+ *
  *  Function list:
  *    A) Initialization & Termination
  *        mapInit
  *        buildGraphs
  *        mapDestroy
+ *        mapBaseInit
+ *        mapInitShared
+ *        mapBaseDestroy
  *
  *    B) Lookup
  *        getMapRepDesc
  *        PgetN
  *        PgetM
  *        PgetP
+ *        PgetBase
+ *        PgetEdgeTable
+ *        PgetEngineName
+ *        PhasAccess
+ *        PgetFree
+ *        PgetFreeFloor
+ *        PgetSpots
+ *        PnextFreeSpot
+ *        getPathNodes
  *        isParkFull
  *
  *    C) Output
  *        mapPrintStd
+ *        writeMove
  *        writeOutput
  *        WriteOutputAfterIn
  *    
@@ -34,19 +52,30 @@
  *        clearSpotIDandWrite
  *        restrictMapCoordinate
  *        freeRestrictionMapCoordinate
+ *        restrictMapRegion
+ *        freeRestrictionMapRegion
  *        restrictMapFloor
  *        freeRestrictionMapFloor
  *
  *    E) Compute
  *        findPath
+ *        queryCost
+ *        rankSpots
+ *        nextRankedPath
+ *        rankFreedSpot
+ *        isFreedSpotRanked
+ *        freeSpotRanking
+ *        mapSetEngine
  *
  *  Non-standard dependencies:
  *    point.h
  *    graphL.h
+ *    engine.h
  *    queue.h
  *    prioQ.h
  *    htable.h
  *    escreve_saida.h
+ *    pathstats.h
  *
  *  Version: 1.0
  *
@@ -59,9 +88,12 @@
 #define __parkmap__h 1
 
 #include"point.h"
+#include"pathstats.h"
 #include<stdio.h>
 
 typedef struct _map Map;
+typedef struct _mapBase MapBase;
+typedef struct _spotRanking SpotRanking;
 
 /*
  *  Function:
@@ -99,6 +131,44 @@ Map *mapInit(char *filename);
 void buildGraphs(Map *parkMap);
 
 
+/*
+ *  Function:
+ *    mapBaseInit
+ *
+ *  Description:
+ *    reads a map configuration file and builds its graph, to be shared by
+ *    any number of Maps
+ *
+ *  Arguments:
+ *    char *filename - name of the map configuration file
+ *
+ *  Return value:
+ *    MapBase * - new base, NULL if the file can't be read
+ */
+
+MapBase *mapBaseInit(char *filename);
+
+
+/*
+ *  Function:
+ *    mapInitShared
+ *
+ *  Description:
+ *    creates a Map ready to use (no buildGraphs needed) over an existing
+ *    base, in the state given by the configuration file. Only the simulation
+ *    state is allocated (occupancy, active nodes, parked cars and path
+ *    search tables), so it is cheap compared to mapInit
+ *
+ *  Arguments:
+ *    MapBase *base - shared base, must outlive the Map
+ *
+ *  Return value:
+ *    Map * - new Map
+ */
+
+Map *mapInitShared(MapBase *base);
+
+
 /*
  *  Function:
  *    mapPrintStd 
@@ -116,6 +186,31 @@ void buildGraphs(Map *parkMap);
 void mapPrintStd(Map *parkMap);
 
 
+/*
+ * Function:
+ *     writeMove
+ *
+ * Description:
+ *     writes a single output line with escreve_saida, validating it against
+ *  the last line written for this Map (each Map keeps its own validation
+ *  state, so several parks may write output at the same time)
+ *
+ * Arguments:
+ *      FILE *fp - file to print
+ *      Map *parkMap - Map the move belongs to
+ *      char *ID - vehicle string identifier
+ *      int time - instant of the move
+ *      int x, y, z - position (for the summary line 'x', the times and cost)
+ *      char move - kind of move as in the output protocol
+ *
+ *  return value:
+ *      none
+ */
+
+void writeMove(FILE *fp, Map *parkMap, char *ID, int time, int x, int y,
+                                                        int z, char move);
+
+
 /* 
  * Functions:
  *     writeOutput
@@ -177,6 +272,86 @@ int PgetM(Map *parkMap);
 int PgetP(Map *parkMap);
 
 
+/* Functions:
+ *     PgetBase
+ *     PgetEdgeTable
+ *     PhasAccess
+ *
+ * Description:
+ *     PgetBase - returns the configuration the Map was made from, to make
+ *  other Maps of the same park with mapInitShared
+ *     PgetEdgeTable - gives the edges of the park's graph as GedgeTable
+ *  does, going out of each node or, with reverse, into it. The tables are
+ *  made once with the base and shared by all its Maps, so they must not be
+ *  changed or freed
+ *     PgetEngineName - returns the name of the routing engine of the Map
+ *  (see engine.h)
+ *     PhasAccess - returns 1 if the park has an access of the type, else 0
+ */
+
+MapBase *PgetBase(Map *parkMap);
+void PgetEdgeTable(Map *parkMap, int reverse, int **start, int **node,
+                                                                int **cost);
+char *PgetEngineName(Map *parkMap);
+int PhasAccess(Map *parkMap, char accessType);
+
+
+/* Functions:
+ *     PgetFree
+ *     PgetFreeFloor
+ *     PgetSpots
+ *
+ * Description:
+ *     PgetFree - returns the number of spots cars may take now: neither
+ *  taken nor restricted, alone or with their floor
+ *     PgetFreeFloor - the same on one floor
+ *     PgetSpots - returns the number of spots of the park
+ */
+
+int PgetFree(Map *parkMap);
+int PgetFreeFloor(Map *parkMap, int floor);
+int PgetSpots(Map *parkMap);
+
+
+/*
+ * Function:
+ *     PnextFreeSpot
+ *
+ * Description:
+ *     finds the first spot cars may take (see PgetFree) after a node, in
+ *  node order, so floor by floor
+ *
+ * Arguments:
+ *     Map *parkMap - configuration Map
+ *     int node - car path node to look after, -1 to look from the first
+ *
+ * Return value:
+ *     int - car path node of the spot, -1 if there's none
+ */
+
+int PnextFreeSpot(Map *parkMap, int node);
+
+
+/*
+ * Function:
+ *     getPathNodes
+ *
+ * Description:
+ *     copies the nodes of a path found by findPath, from the entrance to the
+ *  access, to path
+ *
+ * Arguments:
+ *     Map *parkMap - configuration Map
+ *     int *st - path vector returned by findPath
+ *     char accessType - access type the path was found to
+ *     int *path - table with room for pathSize nodes
+ *     int pathSize - size of the path given by findPath
+ */
+
+void getPathNodes(Map *parkMap, int *st, char accessType, int *path,
+                                                            int pathSize);
+
+
 /*
  *  Functions:
  *    clearSpotCoordinates
@@ -198,6 +373,22 @@ void clearSpotCoordinates(Map *parkMap, int x, int y, int z);
 void clearSpotIDandWrite(FILE *fp, Map *parkMap, char *ID, int time);
 
 
+/*
+ *  Function:
+ *    occupySpotCoordinates
+ *
+ *  Description:
+ *    Parks a car at the given spot, as findPath does with the one it finds
+ *
+ *  Arguments:
+ *    Map *parkMap - configuration map
+ *    char *ID - car identifier
+ *    int x, y, z - parking spot's coordinates
+ */
+
+void occupySpotCoordinates(Map *parkMap, char *ID, int x, int y, int z);
+
+
 /*
  *  Function:
  *    findPath
@@ -214,13 +405,110 @@ void clearSpotIDandWrite(FILE *fp, Map *parkMap, char *ID, int time);
  *    Point *access - contains information about the destiny node
  *    int *cost - reference of int to use as total cost of path 
  *    int *stSize - size of the path
+ *    PathStats *stats - reference to save the work done by the search (NULL
+ *        if not wanted). Only counted when built with PATHSTATS
  *
  *  Return value:
  *    int *st - path vector
  */
 
 int *findPath(Map *parkMap, char *ID, int ex, int ey, int ez, 
-                                    char accessType, int *cost, int *stSize);
+                char accessType, int *cost, int *stSize, PathStats *stats);
+
+
+/*
+ *  Function:
+ *    queryCost
+ *
+ *  Description:
+ *    tells what findPath would give a car coming now, the cost and the
+ *    spot, without parking it or changing anything in the Map: the path
+ *    table of the last findPath stays good. For what-if questions, as
+ *    often as findPath itself may be called
+ *
+ *  Arguments:
+ *    Map *parkMap - contains the parking map configuration
+ *    int ex, ey, ez - entrance point coordinates
+ *    char accessType - descriptor character of access type
+ *    int *sx, *sy, *sz - references to save the spot coordinates, set only
+ *        if there's a path
+ *
+ *  Return value:
+ *    int - cost of the path, NOCON if there is none (nor an access of that
+ *        type, nor such an entrance position)
+ */
+
+int queryCost(Map *parkMap, int ex, int ey, int ez, char accessType,
+                                                int *sx, int *sy, int *sz);
+
+
+/*
+ *  Functions:
+ *    rankSpots
+ *    nextRankedPath
+ *    rankFreedSpot
+ *    isFreedSpotRanked
+ *    freeSpotRanking
+ *
+ *  Description:
+ *    routes many cars from the same entrance to the same access type with
+ *    a single search: rankSpots orders the spots by the cost of the best
+ *    path through each one and nextRankedPath parks a car at the best one
+ *    still free, as findPath would. The ranking is only good while the Map
+ *    changes by cars parking and spots freed, each of them told to it with
+ *    rankFreedSpot right after it's freed (no restrictions).
+ *    isFreedSpotRanked tells whether the spot just freed is one of the
+ *    ranking's, that is whether a car from its entrance could take it
+ *
+ *    The paths have the cost findPath gives but, among those of the same
+ *    cost, not always the one it would choose. Where GDijkstra's ramp rule
+ *    could make them differ nextRankedPath calls findPath itself
+ *
+ *  Arguments:
+ *    Map *parkMap - contains the parking map configuration
+ *    int ex, ey, ez - entrance point coordinates
+ *    char accessType - access type of the cars
+ *    PathStats *stats - reference to save the work done by the searches (NULL
+ *        if not wanted). Only counted when built with PATHSTATS
+ *    SpotRanking *R - ranking made by rankSpots
+ *    char *ID - identifier of the car
+ *    int *cost - reference of int to use as total cost of path
+ *    int *stSize - size of the path
+ *
+ *  Return value:
+ *    SpotRanking * - the ranking (rankSpots)
+ *    int - 1 if the last spot freed can be reached, 0 if not
+ *        (isFreedSpotRanked)
+ *    int *st - path vector, good until the next call, NULL if there's no
+ *        spot left (nextRankedPath)
+ */
+
+SpotRanking *rankSpots(Map *parkMap, int ex, int ey, int ez, char accessType,
+                                                        PathStats *stats);
+int *nextRankedPath(Map *parkMap, SpotRanking *R, char *ID, int *cost,
+                                                                int *stSize);
+void rankFreedSpot(Map *parkMap, SpotRanking *R);
+int isFreedSpotRanked(Map *parkMap, SpotRanking *R);
+void freeSpotRanking(SpotRanking *R);
+
+
+/*
+ *  Function:
+ *    mapSetEngine
+ *
+ *  Description:
+ *    changes the routing engine findPath asks, by its name in engine.c. New
+ *    Maps get the default one (see EsetDefault in engine.h)
+ *
+ *  Arguments:
+ *    Map *parkMap - map whose engine is changed
+ *    char *name - name of the engine
+ *
+ *  Return value:
+ *    int - 1 if the engine exists, 0 otherwise (the Map keeps its engine)
+ */
+
+int mapSetEngine(Map *parkMap, char *name);
 
 
 /*
@@ -259,6 +547,31 @@ void restrictMapCoordinate(Map *parkMap, int x, int y, int z);
 void freeRestrictionMapCoordinate(Map *parkMap, int x, int y, int z);
 
 
+/*
+ * Functions:
+ *     restrictMapRegion
+ *     freeRestrictionMapRegion
+ *
+ * Description:
+ *     restricts (or frees) every location of a box in one or more floors, the
+ *  same as restrictMapCoordinate (freeRestrictionMapCoordinate) on each of
+ *  them. Corners may be given in any order, the parts of the box outside the
+ *  map are ignored
+ *
+ *  Arguments:
+ *     Map *parkMap - contains the current parking map configuration
+ *     int x1, y1, z1 - one corner of the box
+ *     int x2, y2, z2 - the opposite corner, both included
+ *  return value:
+ *     void
+ */
+
+void restrictMapRegion(Map *parkMap, int x1, int y1, int z1,
+                                                    int x2, int y2, int z2);
+void freeRestrictionMapRegion(Map *parkMap, int x1, int y1, int z1,
+                                                    int x2, int y2, int z2);
+
+
 /*
  * Function:
  *     restrictMapFloor
@@ -299,8 +612,7 @@ void freeRestrictionMapFloor(Map *parkMap, int floor);
  *     isParkFull
  *
  * Description:
- *     by keeping track of the available spots in a parking lot we are able to
- *  say if the parking lot is available or not
+ *     returns 1 if no spot may be taken now (see PgetFree), else 0
  */
 
 int isParkFull(Map *parkMap);
@@ -309,18 +621,22 @@ int isParkFull(Map *parkMap);
 /*
  *  Functions:
  *    mapDestroy
+ *    mapBaseDestroy
  *
  *  Description:
- *    frees all previously allocated memory in Map struct
+ *    frees all previously allocated memory in Map struct. The base is only
+ *    freed with the Map if it was made by mapInit, shared bases are freed
+ *    with mapBaseDestroy once no Map uses them
  *
  *  Arguments:
- *    pointer to map struct
+ *    pointer to map (base) struct
  *
  *  Return value:
  *    void
  */
 
 void mapDestroy(Map *parkMap);
+void mapBaseDestroy(MapBase *base);
 
 
 #endif
@@ -0,0 +1,66 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: path query work counters
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#include<stdio.h>
+
+#include"pathstats.h"
+
+
+void PSclear(PathStats *stats){
+    stats->popped = 0;
+    stats->skipped = 0;
+    stats->relaxed = 0;
+    stats->decreaseKeys = 0;
+    stats->rampRejected = 0;
+    stats->fixUps = 0;
+    stats->fixDowns = 0;
+    stats->heapSwaps = 0;
+    stats->cost = 0;
+    return;
+}
+
+
+void PSadd(PathStats *total, PathStats *stats){
+    total->popped += stats->popped;
+    total->skipped += stats->skipped;
+    total->relaxed += stats->relaxed;
+    total->decreaseKeys += stats->decreaseKeys;
+    total->rampRejected += stats->rampRejected;
+    total->fixUps += stats->fixUps;
+    total->fixDowns += stats->fixDowns;
+    total->heapSwaps += stats->heapSwaps;
+    /* the cost only means something for a single query */
+    return;
+}
+
+
+void PSprint(FILE *fp, PathStats *total, int nQueries){
+    double n = nQueries > 0 ? (double) nQueries : 1.0;
+
+    fprintf(fp, "%d path queries (total, per query)\n", nQueries);
+    fprintf(fp, "  popped        %12ld %12.1f\n", total->popped,
+                                                    total->popped / n);
+    fprintf(fp, "  skipped       %12ld %12.1f\n", total->skipped,
+                                                    total->skipped / n);
+    fprintf(fp, "  relaxed       %12ld %12.1f\n", total->relaxed,
+                                                    total->relaxed / n);
+    fprintf(fp, "  decrease-keys %12ld %12.1f\n", total->decreaseKeys,
+                                                    total->decreaseKeys / n);
+    fprintf(fp, "  ramp-rejected %12ld %12.1f\n", total->rampRejected,
+                                                    total->rampRejected / n);
+    fprintf(fp, "  fix-ups       %12ld %12.1f\n", total->fixUps,
+                                                    total->fixUps / n);
+    fprintf(fp, "  fix-downs     %12ld %12.1f\n", total->fixDowns,
+                                                    total->fixDowns / n);
+    fprintf(fp, "  heap-swaps    %12ld %12.1f\n", total->heapSwaps,
+                                                    total->heapSwaps / n);
+    return;
+}
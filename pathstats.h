@@ -0,0 +1,97 @@
+/*
+ *  File name: pathstats.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: counters describing the work done by a single path query
+ *          (GDijkstra and its priority queue), to understand why some
+ *          queries are slower than others.
+ *
+ *          Counting is only compiled in when PATHSTATS is defined (make
+ *          STATS=1). Otherwise PScount expands to nothing and the counters
+ *          stay at zero, so production builds pay nothing for them.
+ *
+ *  Data type list:
+ *    PathStats
+ *
+ *  Function list:
+ *    PSclear
+ *    PSadd
+ *    PSprint
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __pathstats__h
+#define __pathstats__h 1
+
+#include<stdio.h>
+
+
+/*
+ *  Data type: PathStats
+ *
+ *  Description: work counters of one path query (or the sum of several)
+ */
+
+typedef struct _pathStats{
+    long popped;          /* nodes taken out of the priority queue */
+    long skipped;         /* inactive nodes popped and ignored */
+    long relaxed;         /* edges taken as the best way to their destination
+                             (ties included, which only change the path) */
+    long decreaseKeys;    /* relaxations which lowered the destination weight
+                             in the priority queue */
+    long rampRejected;    /* edges ignored by the ramp rule */
+    long fixUps;          /* heap FixUp calls */
+    long fixDowns;        /* heap FixDown calls */
+    long heapSwaps;       /* elements moved by FixUp and FixDown */
+    long cost;            /* final weight of the destination (NOCON if not
+                             reached), not added up by PSadd */
+} PathStats;
+
+
+#ifdef PATHSTATS
+#define PScount(stats, field) \
+    do { if((stats) != NULL) (stats)->field++; } while(0)
+#else
+#define PScount(stats, field) do { } while(0)
+#endif
+
+
+/*
+ *  Function:
+ *    PSclear
+ *
+ *  Description:
+ *    sets every counter to zero
+ */
+
+void PSclear(PathStats *stats);
+
+
+/*
+ *  Function:
+ *    PSadd
+ *
+ *  Description:
+ *    adds the counters of one query to a total
+ */
+
+void PSadd(PathStats *total, PathStats *stats);
+
+
+/*
+ *  Function:
+ *    PSprint
+ *
+ *  Description:
+ *    writes the counters of a total of nQueries queries, with the mean per
+ *    query, in one line per counter
+ */
+
+void PSprint(FILE *fp, PathStats *total, int nQueries);
+
+#endif
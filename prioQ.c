@@ -9,6 +9,7 @@ struct _prioQ{
     int *wt;           /* indexed table with weights */
     int *heap;         /* table satisfying heap condition using wt's indexes */
     int *index;        /* indexed table to find an index in the heap table */
+    PathStats *stats;  /* where to count heap operations, may be NULL */
 };
 
 void FixDown(PrioQ *PQ, int heapIndex);
@@ -24,6 +25,8 @@ PrioQ *PQinit(int *wt, int size){
     PQ->N = size;      /* initial heap size will be the same as his total size */
     PQ->wt = wt;       /* we shall be using the exact same pointer as given */
 
+    PQ->stats = NULL;
+
     PQ->heap = (int*) malloc(sizeof(int) * size);
     PQ->index = (int*) malloc(sizeof(int) * size);
 
@@ -148,6 +151,7 @@ void FixDown(PrioQ *PQ, int heapIndex) {
     index = PQ->index;
 
     N = PQ->N;
+    PScount(PQ->stats, fixDowns);
 
     i = heapIndex;
     while((i + 1)*2  - 1< N) {
@@ -165,6 +169,7 @@ void FixDown(PrioQ *PQ, int heapIndex) {
                     heap[i] = aux;
                     index[ aux ] = i;
                     i = j;
+                    PScount(PQ->stats, heapSwaps);
                     continue;
                 }
             }
@@ -178,6 +183,7 @@ void FixDown(PrioQ *PQ, int heapIndex) {
                     heap[i] = aux;
                     index[ aux ] = i;
                     i = j + 1;
+                    PScount(PQ->stats, heapSwaps);
                     continue;
                 }
             }
@@ -196,6 +202,7 @@ void FixDown(PrioQ *PQ, int heapIndex) {
                 heap[i] = aux;
                 index[ aux ] = i;
                 i = j;
+                PScount(PQ->stats, heapSwaps);
                 continue;
             }
             /* if not we are done */
@@ -215,6 +222,7 @@ void FixUp(PrioQ *PQ, int heapIndex) {
     heap = PQ->heap;
     wt = PQ->wt;
     index = PQ->index;
+    PScount(PQ->stats, fixUps);
 
     i = heapIndex;
     while(i > 0){
@@ -228,6 +236,7 @@ void FixUp(PrioQ *PQ, int heapIndex) {
             heap[i] = aux;
             index[ aux ] = i;
             i = j;
+            PScount(PQ->stats, heapSwaps);
             continue;
         }
         return;
@@ -244,6 +253,7 @@ void FixUpHighPrio(PrioQ *PQ, int heapIndex) {
     heap = PQ->heap;
     wt = PQ->wt;
     index = PQ->index;
+    PScount(PQ->stats, fixUps);
 
     i = heapIndex;
     while(i > 0){
@@ -257,6 +267,7 @@ void FixUpHighPrio(PrioQ *PQ, int heapIndex) {
             heap[i] = aux;
             index[ aux ] = i;
             i = j;
+            PScount(PQ->stats, heapSwaps);
             continue;
         }
         return;
@@ -325,6 +336,22 @@ void PQreset(PrioQ* PQ, int *st, int *wt, int realN){
     return;
 }
 
+void PQcopy(PrioQ *PQ, PrioQ *from){
+    int i;
+
+    PQ->N = from->N;
+    for(i = 0; i < PQ->size; i++){
+        PQ->heap[i] = from->heap[i];
+        PQ->index[i] = from->index[i];
+    }
+    return;
+}
+
+void PQsetStats(PrioQ *PQ, PathStats *stats){
+    PQ->stats = stats;
+    return;
+}
+
 void PQdestroy(PrioQ* PQ){
     free(PQ->index);
     free(PQ->heap);
@@ -1,6 +1,8 @@
 #ifndef __prioQ__h
 #define __prioQ__h 1
 
+#include"pathstats.h"
+
 typedef struct _prioQ PrioQ;
 
 PrioQ *PQinit(int *wt, int size);
@@ -18,5 +20,13 @@ int PQisempty();
 void PQreset(PrioQ *PQ, int *st, int *wt, int realNodes);
 void PQdestroy(PrioQ *PQ);
 
+/* leaves PQ in the order of another queue of the same size, each over its
+ * own weights */
+void PQcopy(PrioQ *PQ, PrioQ *from);
+
+/* counters of heap operations go to stats (NULL for none), only counted
+ * when built with PATHSTATS */
+void PQsetStats(PrioQ *PQ, PathStats *stats);
+
 
 #endif
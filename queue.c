@@ -182,6 +182,28 @@ Item Qpop(Queue *Q){
     return t;
 }
 
+
+/*
+ *  Function:
+ *    Qpeek
+ *
+ *  Description:
+ *    Returns the highest priority Item without taking it out
+ *
+ *  Arguments:
+ *    Queue *Q - Queue with data elements
+ *
+ *  Return value:
+ *    Item - first Item, NULL if the Queue is empty
+ */
+
+Item Qpeek(Queue *Q){
+    if(Q->first == NULL)
+        return NULL;
+    return Q->first->t;
+}
+
+
 int isQueueEmpty(Queue *Q){
     if(Q->first == NULL)
         return 1;
@@ -27,6 +27,7 @@ void Qpush(Queue *, Item);
 void QpushFirst(Queue *, Item);
 int isQueueEmpty(Queue *Q);
 Item Qpop(Queue *);
+Item Qpeek(Queue *);
 void Qdestroy(Queue *);
 
 
@@ -0,0 +1,211 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: runs a whole park scenario
+ *
+ *  Implementation details:
+ *      The input and restriction files are read and listed in increasing time
+ *  order and then they are applied an instant at a time by the dispatch
+ *  module, which uses the required functions from parkmap
+ *
+ *  Non standard interface dependencies:
+ *      parkmap.h - main program module
+ *      LinkedList.h - list ADT
+ *      orders.h - Order data type and input file loaders
+ *      dispatch.h - applies orders to the park
+ *      lookahead.h - rankings made ahead by background threads
+ *      engine.h - whether the park's engine is the reference's
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* directories are POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<dirent.h>
+
+#include"scenario.h"
+#include"parkmap.h"
+#include"LinkedList.h"
+#include"orders.h"
+#include"dispatch.h"
+#include"lookahead.h"
+#include"engine.h"
+
+
+/* threads making rankings ahead for the dispatcher, none by default */
+static int lookaheadThreads = 0;
+
+
+/*
+ * Auxiliary-function: outputName
+ *
+ * Description:
+ *      returns the .pts file name of a configuration file, to be freed
+ */
+
+static char *outputName(char *cfgfile){
+    char *ptsfilename;
+
+    ptsfilename = (char *) malloc(sizeof(char) * (strlen(cfgfile) + 1));
+    strncpy(ptsfilename, cfgfile, (strlen(cfgfile) - 4));
+    ptsfilename[strlen(cfgfile) - 4] = '\0';
+    strcat(ptsfilename, ".pts");
+    return ptsfilename;
+}
+
+
+/*
+ * Auxiliary-function: runOrders
+ *
+ * Description:
+ *      applies the orders of the input and restriction files to a Map ready
+ *  to be used, writing them to the given output file
+ */
+
+static int runOrders(Map *parkMap, char *ptsfilename, char *inpfile,
+                                                char *resfile, int *nOrders){
+    LinkedList *inp, *res, *orders;
+    LinkedList *t;
+    FILE *fp;
+    Dispatcher *D;
+    Lookahead *L = NULL;
+    int n = 0, nTick;
+
+    /* load instruction file into Orders reverse ordered list */
+    inp = loadInstructionFile(inpfile);
+
+    /* if restriction file is presented */
+    if(resfile != NULL){
+        /* load restriction file into Orders reverse ordered list */
+        res = loadRestrictionFile(resfile);
+    }
+    else
+        res = initLinkedList();
+
+    /* if there is restriction file, both lists will be merged in a ordered
+     * list according to time of execution
+     *
+     * else, if there is no restriction file this instruction will simply
+     * reverse the order in the inp list
+     *
+     * caution: inpresShuffleOrder frees both input lists
+     */
+    orders = inpresShuffleOrder(res, inp);
+
+    fp = fopen(ptsfilename, "w");
+    if(fp == NULL){
+        fprintf(stderr, "Couldn't open output file %s\n", ptsfilename);
+        freeLinkedList(orders, OrderDestroy);
+        return 2;
+    }
+
+    /* orders stay in the list, which is freed at the end */
+    D = Dinit(parkMap, fp, NULL);
+    /* the dispatcher only takes rankings with engines that aren't exact */
+    if(lookaheadThreads > 0 && Eexact(PgetEngineName(parkMap)) == 0)
+        L = LAinit(parkMap, orders, lookaheadThreads);
+    if(L != NULL)
+        DsetRankingSource(D, LAtake, L);
+    for(t = orders; t != NULL; n += nTick)
+        t = DapplyTick(D, t, &nTick);
+
+    DprintLatency(D, stderr, ptsfilename);
+#ifdef PATHSTATS
+    {
+        PathStats total;
+        int nQueries = DpathStats(D, &total);
+
+        fprintf(stderr, "%s: ", ptsfilename);
+        PSprint(stderr, &total, nQueries);
+    }
+#endif
+
+    Ddestroy(D);
+    if(L != NULL)
+        LAdestroy(L);
+    fclose(fp);
+    freeLinkedList(orders, OrderDestroy);
+
+    if(nOrders != NULL)
+        *nOrders = n;
+    return 0;
+}
+
+
+int runScenario(char *cfgfile, char *inpfile, char *resfile, int *nOrders){
+    Map *parkMap;
+    char *ptsfilename;
+    int ret;
+
+    parkMap = mapInit(cfgfile);
+    if(parkMap == NULL){
+        fprintf(stderr, "Error producing the park Map structure\n");
+        return 2;
+    }
+    buildGraphs(parkMap);
+
+    ptsfilename = outputName(cfgfile);
+    ret = runOrders(parkMap, ptsfilename, inpfile, resfile, nOrders);
+
+    free(ptsfilename);
+    mapDestroy(parkMap);
+    return ret;
+}
+
+
+int runScenarioShared(MapBase *base, char *ptsfile, char *inpfile,
+                                                char *resfile, int *nOrders){
+    Map *parkMap;
+    int ret;
+
+    parkMap = mapInitShared(base);
+    ret = runOrders(parkMap, ptsfile, inpfile, resfile, nOrders);
+    mapDestroy(parkMap);
+    return ret;
+}
+
+
+void setLookahead(int nThreads){
+    lookaheadThreads = nThreads;
+    return;
+}
+
+
+/* directories of the built-in scenarios */
+static char *suiteDirs[] = {"data", "mais-testes", "tests", NULL};
+
+
+static int compareString(const void *a, const void *b){
+    return strcmp(*(char **) a, *(char **) b);
+}
+
+
+int listSuite(char **cfgfiles, int max){
+    DIR *dir;
+    struct dirent *ent;
+    int n = 0, d, len;
+
+    for(d = 0; suiteDirs[d] != NULL; d++){
+        dir = opendir(suiteDirs[d]);
+        if(dir == NULL)
+            continue;
+        while( (ent = readdir(dir)) != NULL && n < max){
+            len = strlen(ent->d_name);
+            if(len < 5 || strcmp(ent->d_name + len - 4, ".cfg") != 0)
+                continue;
+            cfgfiles[n] = (char *) malloc(strlen(suiteDirs[d]) + len + 2);
+            sprintf(cfgfiles[n], "%s/%s", suiteDirs[d], ent->d_name);
+            n++;
+        }
+        closedir(dir);
+    }
+    qsort(cfgfiles, n, sizeof(char *), compareString);
+    return n;
+}
@@ -0,0 +1,121 @@
+/*
+ *  File name: scenario.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: runs a whole park scenario (configuration, car input and
+ *          optional restriction files) from start to end, writing its .pts
+ *          output file next to the configuration file.
+ *
+ *          Every scenario has its own Map, output file and output validation
+ *          state, so several of them may run at the same time in different
+ *          threads
+ *
+ *  Function list:
+ *    runScenario
+ *    runScenarioShared
+ *    setLookahead
+ *    listSuite
+ *
+ *  Non-standard dependencies:
+ *    parkmap.h
+ *    orders.h
+ *    dispatch.h
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __scenario__h
+#define __scenario__h 1
+
+#include"parkmap.h"
+
+
+/*
+ *  Function:
+ *    runScenario
+ *
+ *  Description:
+ *    builds the park of the configuration file and applies every order of
+ *  the input and restriction files, writing <configuration name>.pts
+ *
+ *  Arguments:
+ *    char *cfgfile - park configuration file, ending in .cfg
+ *    char *inpfile - car input file
+ *    char *resfile - restriction file, NULL if none
+ *    int *nOrders - reference to save the number of orders applied (may be
+ *        NULL)
+ *
+ *  Return value:
+ *    int - 0 on success, 2 if the park or the output file couldn't be made
+ */
+
+int runScenario(char *cfgfile, char *inpfile, char *resfile, int *nOrders);
+
+
+/*
+ *  Function:
+ *    runScenarioShared
+ *
+ *  Description:
+ *    like runScenario, but the park is a new Map over an already built base,
+ *  so many workloads of the same park don't build its graph again. The base
+ *  is only read, so this may run in several threads over the same base
+ *
+ *  Arguments:
+ *    MapBase *base - park configuration with its graph built
+ *    char *ptsfile - output file
+ *    char *inpfile - car input file
+ *    char *resfile - restriction file, NULL if none
+ *    int *nOrders - reference to save the number of orders applied (may be
+ *        NULL)
+ *
+ *  Return value:
+ *    int - 0 on success, 2 if the output file couldn't be made
+ */
+
+int runScenarioShared(MapBase *base, char *ptsfile, char *inpfile,
+                                                char *resfile, int *nOrders);
+
+
+/*
+ *  Function:
+ *    setLookahead
+ *
+ *  Description:
+ *    number of threads each scenario run from then on uses to make the
+ *  rankings of spots of its restriction epochs ahead, for the grouped and
+ *  ranked admissions (see lookahead.h). 0, the default, for none
+ *
+ *  Arguments:
+ *    int nThreads - number of threads
+ *
+ *  Return value:
+ *    void
+ */
+
+void setLookahead(int nThreads);
+
+
+/*
+ *  Function:
+ *    listSuite
+ *
+ *  Description:
+ *    lists the configuration files of the built-in scenarios, every .cfg in
+ *  data/, mais-testes/ and tests/, sorted by name
+ *
+ *  Arguments:
+ *    char **cfgfiles - table to save the names, each to be freed
+ *    int max - size of the table
+ *
+ *  Return value:
+ *    int - number of names saved
+ */
+
+int listSuite(char **cfgfiles, int max);
+
+#endif
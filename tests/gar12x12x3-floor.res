@@ -0,0 +1,29 @@
+R 158 194 2
+R 223 253 2
+R 452 465 2
+R 466 492 2
+R 1020 1033 2
+R 1109 1124 2
+R 1196 1226 2
+R 1279 1316 2
+R 1328 1397 2
+R 1397 1422 2
+R 1772 1829 2
+R 2003 2046 2
+R 2049 2066 2
+R 2066 2078 2
+R 2479 2491 2
+R 2524 2575 2
+R 2576 2601 2
+R 2781 2797 2
+R 2837 2840 2
+R 2842 2854 2
+R 2884 2953 2
+R 3032 3062 2
+R 3063 3064 2
+R 3068 3069 2
+R 3104 3129 2
+R 3297 3312 2
+R 3312 3321 2
+R 3412 3436 2
+R 3439 3447 2
@@ -0,0 +1,103 @@
+R 0 23 2 9 0
+R 23 46 3 2 2
+R 46 57 2 2 2
+R 59 146 8 5 2
+R 197 218 7 9 2
+R 257 285 9 3 0
+R 292 300 3 2 1
+R 302 310 8 5 1
+R 310 338 3 6 1
+R 338 350 8 9 1
+R 352 451 4 9 1
+R 492 535 2 3 0
+R 543 560 9 6 2
+R 560 624 3 2 2
+R 624 681 5 8 0
+R 682 686 9 3 1
+R 686 702 7 5 1
+R 702 759 7 8 0
+R 760 764 4 6 0
+R 765 777 3 8 1
+R 779 803 9 5 0
+R 803 819 5 8 1
+R 822 824 9 3 0
+R 825 849 9 5 1
+R 850 871 9 8 2
+R 875 879 5 9 0
+R 880 882 7 2 0
+R 885 886 8 9 0
+R 886 896 5 8 0
+R 896 907 2 9 0
+R 908 936 7 2 0
+R 936 945 8 8 0
+R 946 959 8 5 0
+R 959 977 6 5 0
+R 977 1020 9 2 0
+R 1033 1052 3 2 2
+R 1053 1066 3 5 1
+R 1066 1109 6 2 1
+R 1124 1125 2 5 0
+R 1129 1131 4 8 0
+R 1131 1151 9 5 0
+R 1153 1196 6 6 0
+R 1227 1277 5 5 0
+R 1319 1325 8 8 1
+R 1425 1430 4 5 2
+R 1432 1503 4 3 0
+R 1503 1532 4 3 0
+R 1532 1568 2 2 0
+R 1569 1642 2 9 0
+R 1642 1669 7 9 2
+R 1669 1685 4 3 0
+R 1685 1736 8 8 0
+R 1737 1758 7 3 0
+R 1758 1772 9 2 1
+R 1838 1862 3 6 2
+R 1862 1914 8 2 2
+R 1916 1965 7 3 1
+R 1967 1975 2 8 0
+R 1975 1983 7 3 0
+R 1989 2000 6 8 2
+R 2046 2049 3 6 2
+R 2082 2090 8 8 1
+R 2090 2183 2 5 1
+R 2183 2208 6 9 1
+R 2209 2210 5 5 0
+R 2212 2236 9 9 2
+R 2236 2276 7 3 0
+R 2276 2306 6 8 1
+R 2308 2314 3 2 2
+R 2314 2363 5 9 1
+R 2363 2395 4 5 1
+R 2396 2398 4 2 2
+R 2398 2399 6 3 2
+R 2400 2457 2 6 1
+R 2459 2476 8 9 0
+R 2491 2523 8 8 0
+R 2603 2606 7 5 2
+R 2606 2613 2 2 2
+R 2613 2642 3 2 1
+R 2642 2657 6 3 1
+R 2657 2674 2 8 0
+R 2676 2705 8 8 0
+R 2708 2739 4 6 2
+R 2739 2779 3 3 1
+R 2797 2803 3 2 1
+R 2803 2835 8 9 0
+R 2857 2881 4 3 0
+R 2881 2883 3 9 0
+R 2958 2983 5 5 0
+R 2983 3013 4 2 0
+R 3013 3029 4 8 2
+R 3072 3080 7 3 1
+R 3083 3103 7 8 2
+R 3129 3250 7 8 2
+R 3252 3273 5 3 0
+R 3274 3284 7 2 0
+R 3286 3293 3 2 2
+R 3321 3354 4 2 2
+R 3355 3399 6 2 1
+R 3399 3412 9 5 0
+R 3456 3470 9 5 0
+R 3470 3487 9 8 2
+R 3492 3526 7 5 0
@@ -0,0 +1 @@
+R 0 10 0
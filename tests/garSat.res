@@ -0,0 +1,5 @@
+R 25 60 1
+R 65 100 2 2 0 4 3 0
+R 105 140 6 5 0
+R 145 170 2 2 1 7 3 1
+R 175 210 1
@@ -0,0 +1,25 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: monotonic clock reading
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+/* clock_gettime is POSIX, not part of ANSI C */
+#define _POSIX_C_SOURCE 200112L
+
+#include<time.h>
+
+#include"timing.h"
+
+
+double Tnow(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
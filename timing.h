@@ -0,0 +1,35 @@
+/*
+ *  File name: timing.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: monotonic clock reading, used to measure how long the park
+ *          operations take
+ *
+ *  Function list:
+ *    Tnow
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __timing__h
+#define __timing__h 1
+
+
+/*
+ *  Function:
+ *    Tnow
+ *
+ *  Description:
+ *    reads a monotonic clock, unaffected by changes to the system date
+ *
+ *  Return value:
+ *    double - seconds since an arbitrary fixed instant
+ */
+
+double Tnow(void);
+
+#endif
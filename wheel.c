@@ -0,0 +1,267 @@
+/*
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: hierarchical timing wheel
+ *
+ *  Implementation details:
+ *      The wheel has WHLEVELS levels of WHSLOTS slots, each slot a first in
+ *  first out list of Items. An Item goes to the lowest level whose slot
+ *  holds its instant along with the instant the wheel is at: level 0 has a
+ *  slot per instant of the current round of WHSLOTS instants, level 1 a slot
+ *  per round of the current round of rounds, and so on. Items too far ahead
+ *  for the last level wait in an overflow list.
+ *
+ *      The next Item is the first of the first slot used of level 0 from
+ *  the current instant on. When level 0 has no more, the wheel jumps to the
+ *  first slot used of the lowest level that has one and spreads its Items
+ *  down to the levels below, in the order they were put in, so Items of the
+ *  same instant keep their order. Every Item is spread down at most once per
+ *  level, and a bit mask of the slots used per level finds them without
+ *  looking at the empty ones.
+ *
+ *      Instants are not negative
+ *
+ *  Non standard interface dependencies:
+ *      defs.h - Item type
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#include<stdlib.h>
+
+#include"wheel.h"
+#include"defs.h"
+
+#define WHBITS   5
+#define WHSLOTS  (1 << WHBITS)
+#define WHLEVELS 6          /* instants up to 2^30 ahead without overflow */
+
+
+typedef struct _node{
+    Item t;
+    int time;
+    struct _node *next;
+} Node;
+
+
+typedef struct _slot{
+    Node *first, *last;
+} Slot;
+
+
+struct _wheel{
+    int now;                              /* instant reached */
+    Slot slots[WHLEVELS][WHSLOTS];
+    unsigned long used[WHLEVELS];         /* bit s set if slot s has Items */
+    Slot overflow;
+    Node *spare;                          /* nodes to reuse */
+};
+
+
+Wheel *WHinit(int start){
+    Wheel *W;
+    int l, s;
+
+    W = (Wheel *) malloc(sizeof(Wheel));
+    W->now = start;
+    for(l = 0; l < WHLEVELS; l++){
+        for(s = 0; s < WHSLOTS; s++)
+            W->slots[l][s].first = W->slots[l][s].last = NULL;
+        W->used[l] = 0;
+    }
+    W->overflow.first = W->overflow.last = NULL;
+    W->spare = NULL;
+    return W;
+}
+
+
+static void append(Slot *S, Node *n){
+    n->next = NULL;
+    if(S->last == NULL)
+        S->first = n;
+    else
+        S->last->next = n;
+    S->last = n;
+    return;
+}
+
+
+/*
+ * Auxiliary-function: place
+ *
+ * Description:
+ *      puts a node in the slot of its instant, as seen from the instant the
+ *  wheel is at
+ */
+
+static void place(Wheel *W, Node *n){
+    int l, s;
+
+    for(l = 0; l < WHLEVELS; l++)
+        if( (n->time >> (WHBITS * (l + 1))) ==
+                                        (W->now >> (WHBITS * (l + 1))) ){
+            s = (n->time >> (WHBITS * l)) & (WHSLOTS - 1);
+            append(&W->slots[l][s], n);
+            W->used[l] |= 1UL << s;
+            return;
+        }
+    append(&W->overflow, n);
+    return;
+}
+
+
+/*
+ * Auxiliary-function: firstUsed
+ *
+ * Description:
+ *      first slot used of a level from a given one on, -1 if there's none
+ */
+
+static int firstUsed(unsigned long used, int from){
+    int s;
+
+    if(from >= WHSLOTS)
+        return -1;
+    used >>= from;
+    if(used == 0)
+        return -1;
+    for(s = from; (used & 1UL) == 0; s++)
+        used >>= 1;
+    return s;
+}
+
+
+/*
+ * Auxiliary-function: spread
+ *
+ * Description:
+ *      places again, in order, the nodes of a list taken out of the wheel
+ */
+
+static void spread(Wheel *W, Node *n){
+    Node *next;
+
+    for(; n != NULL; n = next){
+        next = n->next;
+        place(W, n);
+    }
+    return;
+}
+
+
+void WHinsert(Wheel *W, int time, Item t){
+    Node *n;
+
+    if(W->spare != NULL){
+        n = W->spare;
+        W->spare = n->next;
+    } else
+        n = (Node *) malloc(sizeof(Node));
+    n->t = t;
+    n->time = time < W->now ? W->now : time;
+    place(W, n);
+    return;
+}
+
+
+Item WHnext(Wheel *W, int until, int *time){
+    Slot *S;
+    Node *n;
+    Item t;
+    int l, s, start, min;
+
+    while(1){
+        s = firstUsed(W->used[0], W->now & (WHSLOTS - 1));
+        if(s >= 0){
+            start = (W->now & ~(WHSLOTS - 1)) | s;
+            if(start > until)
+                return NULL;
+            W->now = start;
+            S = &W->slots[0][s];
+            n = S->first;
+            S->first = n->next;
+            if(S->first == NULL){
+                S->last = NULL;
+                W->used[0] &= ~(1UL << s);
+            }
+            t = n->t;
+            if(time != NULL)
+                *time = n->time;
+            n->next = W->spare;
+            W->spare = n;
+            return t;
+        }
+
+        /* level 0 is done, go to the first slot used of a level above */
+        for(l = 1; l < WHLEVELS; l++){
+            s = firstUsed(W->used[l],
+                        ((W->now >> (WHBITS * l)) & (WHSLOTS - 1)) + 1);
+            if(s >= 0)
+                break;
+        }
+        if(l < WHLEVELS){
+            start = ((W->now >> (WHBITS * (l + 1))) << (WHBITS * (l + 1))) |
+                                                        (s << (WHBITS * l));
+            if(start > until)
+                return NULL;
+            W->now = start;
+            S = &W->slots[l][s];
+            n = S->first;
+            S->first = S->last = NULL;
+            W->used[l] &= ~(1UL << s);
+            spread(W, n);
+            continue;
+        }
+
+        /* the levels are empty, bring in the overflow */
+        if(W->overflow.first == NULL)
+            return NULL;
+        min = W->overflow.first->time;
+        for(n = W->overflow.first; n != NULL; n = n->next)
+            if(n->time < min)
+                min = n->time;
+        if(min > until)
+            return NULL;
+        W->now = (min >> (WHBITS * WHLEVELS)) << (WHBITS * WHLEVELS);
+        n = W->overflow.first;
+        W->overflow.first = W->overflow.last = NULL;
+        spread(W, n);
+    }
+}
+
+
+int WHisEmpty(Wheel *W){
+    int l;
+
+    for(l = 0; l < WHLEVELS; l++)
+        if(W->used[l] != 0)
+            return 0;
+    return W->overflow.first == NULL ? 1 : 0;
+}
+
+
+static void freeNodes(Node *n){
+    Node *next;
+
+    for(; n != NULL; n = next){
+        next = n->next;
+        free(n);
+    }
+    return;
+}
+
+
+void WHdestroy(Wheel *W){
+    int l, s;
+
+    for(l = 0; l < WHLEVELS; l++)
+        for(s = 0; s < WHSLOTS; s++)
+            freeNodes(W->slots[l][s].first);
+    freeNodes(W->overflow.first);
+    freeNodes(W->spare);
+    free(W);
+    return;
+}
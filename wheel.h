@@ -0,0 +1,107 @@
+/*
+ *  File name: wheel.h
+ *
+ *  Author: Beatriz Ferreira & Henrique Nogueira
+ *
+ *  Description: hierarchical timing wheel, a queue of Items each due at an
+ *          instant, taken out in time order and, among those of the same
+ *          instant, in the order they were put in. Putting an Item in and
+ *          taking the next one out take constant time, however far apart
+ *          the instants are
+ *
+ *  Abstract Data Type: Wheel
+ *              The Items not taken out yet and the instant the wheel has
+ *          reached
+ *
+ *  Function list:
+ *    WHinit
+ *    WHinsert
+ *    WHnext
+ *    WHisEmpty
+ *    WHdestroy
+ *
+ *  Non-standard dependencies:
+ *    defs.h
+ *
+ *  Version: 1.0
+ *
+ *  Change log: N/A
+ *
+ */
+
+#ifndef __wheel__h
+#define __wheel__h 1
+
+#include"defs.h"
+
+typedef struct _wheel Wheel;
+
+
+/*
+ *  Function:
+ *    WHinit
+ *
+ *  Description:
+ *    makes an empty wheel at a starting instant
+ *
+ *  Arguments:
+ *    int start - instant the wheel is at, no Item should be due before it
+ *
+ *  Return value:
+ *    Wheel * - the wheel
+ */
+
+Wheel *WHinit(int start);
+
+
+/*
+ *  Function:
+ *    WHinsert
+ *
+ *  Description:
+ *    puts an Item in, due at an instant. An Item due before the instant the
+ *  wheel has reached is taken as due at it, and comes out next
+ *
+ *  Arguments:
+ *    Wheel *W
+ *    int time - instant the Item is due
+ *    Item t - Item
+ */
+
+void WHinsert(Wheel *W, int time, Item t);
+
+
+/*
+ *  Function:
+ *    WHnext
+ *
+ *  Description:
+ *    takes out the Item due the earliest, if it is due at or before an
+ *  instant, the wheel reaching the instant it was due
+ *
+ *  Arguments:
+ *    Wheel *W
+ *    int until - last instant to take Items from
+ *    int *time - reference to save the instant of the Item (may be NULL)
+ *
+ *  Return value:
+ *    Item - the Item, NULL if there is none due until then
+ */
+
+Item WHnext(Wheel *W, int until, int *time);
+
+
+int WHisEmpty(Wheel *W);
+
+
+/*
+ *  Function:
+ *    WHdestroy
+ *
+ *  Description:
+ *    frees the wheel, the Items still in it are not freed
+ */
+
+void WHdestroy(Wheel *W);
+
+#endif